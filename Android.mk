@@ -74,6 +74,7 @@ SPVTOOLS_SRC_FILES := \
 
 SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/aggressive_dead_code_elim_pass.cpp \
+		source/opt/alias_analysis.cpp \
 		source/opt/amd_ext_to_khr.cpp \
 		source/opt/basic_block.cpp \
 		source/opt/block_merge_pass.cpp \
@@ -92,6 +93,7 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/copy_prop_arrays.cpp \
 		source/opt/dead_branch_elim_pass.cpp \
 		source/opt/dead_insert_elim_pass.cpp \
+		source/opt/dead_store_elim_pass.cpp \
 		source/opt/dead_variable_elimination.cpp \
 		source/opt/decompose_initialized_variables_pass.cpp \
 		source/opt/decoration_manager.cpp \
@@ -105,12 +107,14 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/eliminate_dead_members_pass.cpp \
 		source/opt/feature_manager.cpp \
 		source/opt/fix_storage_class.cpp \
+		source/opt/fixed_point_pass_group.cpp \
 		source/opt/flatten_decoration_pass.cpp \
 		source/opt/fold.cpp \
 		source/opt/folding_rules.cpp \
 		source/opt/fold_spec_constant_op_and_composite_pass.cpp \
 		source/opt/freeze_spec_constant_value_pass.cpp \
 		source/opt/function.cpp \
+		source/opt/function_specialization_pass.cpp \
 		source/opt/generate_webgpu_initializers_pass.cpp \
 		source/opt/graphics_robust_access_pass.cpp \
 		source/opt/if_conversion.cpp \
@@ -122,6 +126,7 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/inst_debug_printf_pass.cpp \
 		source/opt/instruction.cpp \
 		source/opt/instruction_list.cpp \
+		source/opt/instruction_scheduling_pass.cpp \
 		source/opt/instrument_pass.cpp \
 		source/opt/ir_context.cpp \
 		source/opt/ir_loader.cpp \
@@ -138,13 +143,16 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/loop_fusion.cpp \
 		source/opt/loop_fusion_pass.cpp \
 		source/opt/loop_peeling.cpp \
+		source/opt/loop_strength_reduction_pass.cpp \
 		source/opt/loop_unroller.cpp \
 		source/opt/loop_unswitch_pass.cpp \
 		source/opt/loop_utils.cpp \
 		source/opt/mem_pass.cpp \
+		source/opt/memory_ssa.cpp \
 		source/opt/merge_return_pass.cpp \
 		source/opt/module.cpp \
 		source/opt/optimizer.cpp \
+		source/opt/partial_redundancy_elimination.cpp \
 		source/opt/pass.cpp \
 		source/opt/pass_manager.cpp \
 		source/opt/private_to_local_pass.cpp \
@@ -154,6 +162,7 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/redundancy_elimination.cpp \
 		source/opt/register_pressure.cpp \
 		source/opt/relax_float_ops_pass.cpp \
+		source/opt/rematerialization_pass.cpp \
 		source/opt/remove_duplicates_pass.cpp \
 		source/opt/replace_invalid_opc.cpp \
 		source/opt/scalar_analysis.cpp \
@@ -161,6 +170,7 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/scalar_replacement_pass.cpp \
 		source/opt/set_spec_constant_default_value_pass.cpp \
 		source/opt/simplification_pass.cpp \
+		source/opt/slp_vectorizer_pass.cpp \
 		source/opt/split_invalid_unreachable_pass.cpp \
 		source/opt/ssa_rewrite_pass.cpp \
 		source/opt/strength_reduction_pass.cpp \
@@ -173,6 +183,8 @@ SPVTOOLS_OPT_SRC_FILES := \
 		source/opt/unify_const_pass.cpp \
 		source/opt/upgrade_memory_model.cpp \
 		source/opt/value_number_table.cpp \
+		source/opt/value_range_analysis.cpp \
+		source/opt/value_range_propagation_pass.cpp \
 		source/opt/vector_dce.cpp \
 		source/opt/workaround1209.cpp \
 		source/opt/wrap_opkill.cpp
@@ -333,5 +345,8 @@ LOCAL_C_INCLUDES := \
 		$(SPVTOOLS_OUT_PATH)
 LOCAL_CXXFLAGS:=-std=c++11 -fno-exceptions -fno-rtti -Werror
 LOCAL_STATIC_LIBRARIES:=SPIRV-Tools
+# Threads are used to analyze functions in parallel.  Bionic provides them in
+# libc, but the flag keeps std::thread usable with every NDK toolchain.
+LOCAL_EXPORT_LDFLAGS:=-pthread
 LOCAL_SRC_FILES:= $(SPVTOOLS_OPT_SRC_FILES)
 include $(BUILD_STATIC_LIBRARY)
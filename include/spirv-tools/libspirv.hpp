@@ -176,6 +176,12 @@ class OptimizerOptions {
                                                 preserve_spec_constants);
   }
 
+  // Records the maximum number of threads that passes may use to process the
+  // functions of a module concurrently.
+  void set_num_threads(uint32_t num_threads) {
+    spvOptimizerOptionsSetNumThreads(options_, num_threads);
+  }
+
  private:
   spv_optimizer_options options_;
 };
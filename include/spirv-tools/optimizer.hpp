@@ -106,6 +106,17 @@ class Optimizer {
   // from time to time.
   Optimizer& RegisterSizePasses();
 
+  // Registers the passes of RegisterPerformancePasses(), but with the cleanup
+  // passes arranged in groups that are each run repeatedly until the module
+  // stops changing.  Within a group, a pass is skipped if it made no change
+  // the last time it ran and nothing changed since.
+  Optimizer& RegisterFixedPointPerformancePasses();
+
+  // Registers the passes of RegisterSizePasses(), but with the cleanup passes
+  // arranged in groups that are iterated to a fixed point, as for
+  // RegisterFixedPointPerformancePasses().
+  Optimizer& RegisterFixedPointSizePasses();
+
   // Registers passes that have been prescribed for converting from Vulkan to
   // WebGPU. This sequence of passes is subject to constant review and will
   // change from time to time.
@@ -226,6 +237,14 @@ class Optimizer {
   // |out| output stream.
   Optimizer& SetTimeReport(std::ostream* out);
 
+  // Sets the option to write a JSON profile of the passes once they have run.
+  // For each pass the profile holds its resource utilization, the number of
+  // instructions, blocks and functions and the id bound before and after the
+  // pass, the analyses it built or invalidated, and whether it reported a
+  // change.  If |out| is null, then no profile is collected.  Otherwise, the
+  // profile is sent to the |out| output stream.
+  Optimizer& SetProfileJson(std::ostream* out);
+
   // Sets the option to validate the module after each pass.
   Optimizer& SetValidateAfterAll(bool validate);
 
@@ -471,7 +490,10 @@ Optimizer::PassToken CreateLocalAccessChainConvertPass();
 // function scope variable that are stored to only once, where possible. Only
 // whole variable loads and stores are eliminated; access-chain references are
 // not optimized. Replace all loads of such variables with the value that is
-// stored and eliminate any resulting dead code.
+// stored and eliminate any resulting dead code.  Variables that are stored to
+// more than once, but only through whole variable loads and stores, are also
+// handled: a load that reads the value of the same store on every path is
+// replaced by that value.
 //
 // Currently, the presence of access chains and function calls can inhibit this
 // pass, however the Inlining and LocalAccessChainConvert passes can make it
@@ -888,6 +910,106 @@ Optimizer::PassToken CreateWrapOpKillPass();
 // capabilities.
 Optimizer::PassToken CreateAmdExtToKhrPass();
 
+// Create a partial redundancy elimination pass.
+// This pass looks for instructions whose value is already computed on some,
+// but not all, of the paths leading to them.  The value is computed on the
+// remaining paths, and the instruction is replaced by an OpPhi of the values
+// from each path.
+Optimizer::PassToken CreatePartialRedundancyEliminationPass();
+
+// Creates a dead store elimination pass.
+// This pass removes stores to function scope and private variables whose
+// values are never read, whether they are overwritten later in the same
+// block, overwritten on every path that follows, or never loaded at all.
+// Stores through access chains with constant indices are tracked per
+// member and element.  A store through a dynamic index is removed if a later
+// store in the same block must write the same memory, as determined by the
+// alias analysis.  Stores to private variables are kept if a caller can read
+// them.
+//
+// This pass only processes entry point functions and the functions they
+// call.  It assumes logical addressing.
+Optimizer::PassToken CreateDeadStoreElimPass();
+
+// Creates a value range propagation pass.
+// This pass computes the range of values each integer and boolean result
+// can take, narrowed by the branch conditions that must hold where it is
+// used.  Results that can only take one value are replaced by a constant,
+// which folds comparisons and branch conditions whose result is known.
+// GLSL.std.450 min, max and clamp instructions that cannot change their
+// operand are replaced by that operand.  Only integers of at most 32 bits
+// are tracked.
+Optimizer::PassToken CreateValueRangePropagationPass();
+
+// Creates an interprocedural conditional constant propagation pass.
+// This pass does the same as the CCP pass, and also propagates constants
+// across function calls.  A parameter that is given the same constant by
+// every call that can execute is replaced by that constant in the callee,
+// and the result of calls to a function that always returns the same
+// constant is replaced by that constant.  The parameters of exported
+// functions are assumed to be varying.
+Optimizer::PassToken CreateInterproceduralCCPPass();
+
+// Creates a function specialization pass.
+// This pass clones functions for the constants they are called with, and
+// changes the calls to call the clones, which do not take the constant
+// parameters.  Functions that are specialized for all of their calls are
+// removed.  |max_growth| limits the number of instructions the other clones
+// can add to the module.  It then removes the parameters that functions do
+// not use, and the return values that no call uses.  Entry points and
+// exported functions keep their parameters.
+Optimizer::PassToken CreateFunctionSpecializationPass(
+    uint32_t max_growth = 100);
+
+// Creates an SLP vectorizer pass.
+// This pass looks for vectors constructed from scalars that are computed
+// by the same operations on the components of other vectors or on
+// constants, and computes them with vector instructions instead.  The
+// components are rearranged with OpVectorShuffle where needed.  A tree is
+// only vectorized if this removes more instructions than it adds, counting
+// the vectors that have to be kept live longer as added instructions.
+Optimizer::PassToken CreateSLPVectorizerPass();
+
+// Creates a loop unroller pass that chooses how to unroll each loop.
+// Every loop that is not marked DontUnroll and that meets the criteria of
+// LoopUtils::CanPerformUnroll is unrolled by the largest factor for which
+// the unrolled loop has at most |max_unrolled_size| instructions, and is
+// not expected to need more than |max_registers| registers.  The register
+// estimate assumes that the copies of the body may be interleaved.  A loop
+// is fully unrolled if its whole trip count fits, and left alone if no
+// factor does.
+Optimizer::PassToken CreateAutoLoopUnrollPass(uint32_t max_unrolled_size = 256,
+                                              uint32_t max_registers = 64);
+
+// Creates an instruction scheduling pass.
+// This pass reorders the instructions in each basic block to lower the
+// largest number of values that are live at the same time.  Instructions
+// are moved close to their uses when their operands allow it.  Loads may
+// be reordered with each other, but the instructions that access memory
+// or have side effects otherwise keep their order.  The new order of a
+// block is only kept if it lowers the register pressure.
+Optimizer::PassToken CreateInstructionSchedulingPass();
+
+// Creates a rematerialization pass.
+// This pass looks for values that are live through a block that needs
+// more than |max_registers| registers, according to the register liveness
+// analysis, without being used there.  If such a value is computed by a
+// short chain of cheap instructions on constants and module scope
+// variables, such as access chains, loads from read-only memory and simple
+// arithmetic, the chain is copied before its uses in the other blocks
+// instead of keeping the value live.
+Optimizer::PassToken CreateRematerializationPass(uint32_t max_registers = 32);
+
+// Creates a loop strength reduction pass.
+// This pass simplifies the 32-bit integer induction variables of loops,
+// using the scalar evolution analysis.  Header phis that evolve like an
+// earlier one are merged into it, multiplications that evolve as
+// |base + i * stride| with a loop invariant |base| and |stride| are
+// replaced by new induction variables incremented by |stride|, and the
+// uses after a loop of its header values are replaced by their value on
+// exit when the trip count is known.
+Optimizer::PassToken CreateLoopStrengthReductionPass();
+
 }  // namespace spvtools
 
 #endif  // INCLUDE_SPIRV_TOOLS_OPTIMIZER_HPP_
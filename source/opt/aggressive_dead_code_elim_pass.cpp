@@ -39,6 +39,23 @@ const uint32_t kLoopMergeContinueBlockIdInIdx = 1;
 const uint32_t kCopyMemoryTargetAddrInIdx = 0;
 const uint32_t kCopyMemorySourceAddrInIdx = 1;
 
+// Mixes |word| into the fingerprint |hash|.
+void HashWord(uint32_t word, size_t* hash) {
+  *hash ^= word + 0x9e3779b9 + (*hash << 6) + (*hash >> 2);
+}
+
+// Mixes the opcode and the operands of |inst| into the fingerprint |hash|.
+void HashInstruction(const Instruction& inst, size_t* hash) {
+  HashWord(inst.opcode(), hash);
+  for (uint32_t i = 0; i < inst.NumOperands(); ++i) {
+    const Operand& operand = inst.GetOperand(i);
+    HashWord(static_cast<uint32_t>(operand.words.size()), hash);
+    for (uint32_t word : operand.words) {
+      HashWord(word, hash);
+    }
+  }
+}
+
 // Sorting functor to present annotation instructions in an easy-to-process
 // order. The functor orders by opcode first and falls back on unique id
 // ordering if both instructions have the same opcode.
@@ -311,6 +328,173 @@ void AggressiveDCEPass::AddBreaksAndContinuesToWorklist(
   });
 }
 
+void AggressiveDCEPass::ProcessWorklist() {
+  while (!worklist_.empty()) {
+    Instruction* liveInst = worklist_.front();
+    // Add all operand instructions if not already live
+    liveInst->ForEachInId([&liveInst, this](const uint32_t* iid) {
+      Instruction* inInst = get_def_use_mgr()->GetDef(*iid);
+      // Do not add label if an operand of a branch. This is not needed
+      // as part of live code discovery and can create false live code,
+      // for example, the branch to a header of a loop.
+      if (inInst->opcode() == SpvOpLabel && liveInst->IsBranch()) return;
+      AddToWorklist(inInst);
+    });
+    if (liveInst->type_id() != 0) {
+      AddToWorklist(get_def_use_mgr()->GetDef(liveInst->type_id()));
+    }
+    // If in a structured if or loop construct, add the controlling
+    // conditional branch and its merge.
+    BasicBlock* blk = context()->get_instr_block(liveInst);
+    Instruction* branchInst = block2headerBranch_[blk];
+    if (branchInst != nullptr) {
+      AddToWorklist(branchInst);
+      Instruction* mergeInst = branch2merge_[branchInst];
+      AddToWorklist(mergeInst);
+    }
+    // If the block is a header, add the next outermost controlling
+    // conditional branch and its merge.
+    Instruction* nextBranchInst = header2nextHeaderBranch_[blk];
+    if (nextBranchInst != nullptr) {
+      AddToWorklist(nextBranchInst);
+      Instruction* mergeInst = branch2merge_[nextBranchInst];
+      AddToWorklist(mergeInst);
+    }
+    // If local load, add all variable's stores if variable not already live
+    if (liveInst->opcode() == SpvOpLoad || liveInst->IsAtomicWithLoad()) {
+      uint32_t varId;
+      (void)GetPtr(liveInst, &varId);
+      if (varId != 0) {
+        ProcessLoad(varId);
+      }
+      // Process memory copies like loads
+    } else if (liveInst->opcode() == SpvOpCopyMemory ||
+               liveInst->opcode() == SpvOpCopyMemorySized) {
+      uint32_t varId;
+      (void)GetPtr(liveInst->GetSingleWordInOperand(kCopyMemorySourceAddrInIdx),
+                   &varId);
+      if (varId != 0) {
+        ProcessLoad(varId);
+      }
+      // If merge, add other branches that are part of its control structure
+    } else if (liveInst->opcode() == SpvOpLoopMerge ||
+               liveInst->opcode() == SpvOpSelectionMerge) {
+      AddBreaksAndContinuesToWorklist(liveInst);
+      // If function call, treat as if it loads from all pointer arguments
+    } else if (liveInst->opcode() == SpvOpFunctionCall) {
+      liveInst->ForEachInId([this](const uint32_t* iid) {
+        // Skip non-ptr args
+        if (!IsPtr(*iid)) return;
+        uint32_t varId;
+        (void)GetPtr(*iid, &varId);
+        ProcessLoad(varId);
+      });
+      // If function parameter, treat as if it's result id is loaded from
+    } else if (liveInst->opcode() == SpvOpFunctionParameter) {
+      ProcessLoad(liveInst->result_id());
+      // We treat an OpImageTexelPointer as a load of the pointer, and
+      // that value is manipulated to get the result.
+    } else if (liveInst->opcode() == SpvOpImageTexelPointer) {
+      uint32_t varId;
+      (void)GetPtr(liveInst, &varId);
+      if (varId != 0) {
+        ProcessLoad(varId);
+      }
+    }
+
+    // Add OpDecorateId instructions that apply to this instruction to the work
+    // list.  We use the decoration manager to look through the group
+    // decorations to get to the OpDecorate* instructions themselves.
+    auto decorations =
+        get_decoration_mgr()->GetDecorationsFor(liveInst->result_id(), false);
+    for (Instruction* dec : decorations) {
+      // We only care about OpDecorateId instructions because the are the only
+      // decorations that will reference an id that will have to be kept live
+      // because of that use.
+      if (dec->opcode() != SpvOpDecorateId) {
+        continue;
+      }
+      if (dec->GetSingleWordInOperand(1) ==
+          SpvDecorationHlslCounterBufferGOOGLE) {
+        // These decorations should not force the use id to be live.  It will be
+        // removed if either the target or the in operand are dead.
+        continue;
+      }
+      AddToWorklist(dec);
+    }
+
+    worklist_.pop();
+  }
+}
+
+size_t AggressiveDCEPass::FunctionFingerprint(Function* func) {
+  size_t hash = 0;
+  func->ForEachInst(
+      [&hash](Instruction* inst) { HashInstruction(*inst, &hash); });
+  for (auto& entry : get_module()->entry_points()) {
+    if (entry.GetSingleWordInOperand(kEntryPointFunctionIdInIdx) ==
+        func->result_id()) {
+      HashWord(1, &hash);
+      break;
+    }
+  }
+  return hash;
+}
+
+size_t AggressiveDCEPass::ModuleFingerprint() {
+  size_t hash = 0;
+  HashWord(context()->preserve_bindings(), &hash);
+  HashWord(context()->preserve_spec_constants(), &hash);
+  for (auto& inst : get_module()->entry_points()) HashInstruction(inst, &hash);
+  for (auto& inst : get_module()->execution_modes())
+    HashInstruction(inst, &hash);
+  for (auto& inst : get_module()->debugs2()) HashInstruction(inst, &hash);
+  for (auto& inst : get_module()->annotations()) HashInstruction(inst, &hash);
+  for (auto& inst : get_module()->types_values()) HashInstruction(inst, &hash);
+  return hash;
+}
+
+bool AggressiveDCEPass::IsUnchanged(uint32_t id, size_t fingerprint) {
+  const auto* fingerprints = context()->dead_code_fingerprints();
+  auto it = fingerprints->find(id);
+  return it != fingerprints->end() && it->second == fingerprint;
+}
+
+void AggressiveDCEPass::MarkFunctionLive(Function* func) {
+  func->ForEachInst(
+      [this](Instruction* inst) { live_insts_.Set(inst->unique_id()); });
+
+  // Only the instructions outside of |func| are added to the worklist, since
+  // the ones in |func| are already live.
+  func->ForEachInst([this](Instruction* inst) {
+    inst->ForEachInId([this](const uint32_t* iid) {
+      AddToWorklist(get_def_use_mgr()->GetDef(*iid));
+    });
+    if (inst->type_id() != 0) {
+      AddToWorklist(get_def_use_mgr()->GetDef(inst->type_id()));
+    }
+  });
+  ProcessWorklist();
+}
+
+void AggressiveDCEPass::MarkDecorateIdsLive() {
+  for (auto& anno : get_module()->annotations()) {
+    if (anno.opcode() != SpvOpDecorateId ||
+        anno.GetSingleWordInOperand(1) ==
+            SpvDecorationHlslCounterBufferGOOGLE) {
+      continue;
+    }
+    // Decorations applied through a group are kept, since finding whether
+    // one of the group's targets is live is not worth it here.
+    Instruction* target =
+        get_def_use_mgr()->GetDef(anno.GetSingleWordInOperand(0));
+    if (IsLive(target) || target->opcode() == SpvOpDecorationGroup) {
+      AddToWorklist(&anno);
+    }
+  }
+  ProcessWorklist();
+}
+
 bool AggressiveDCEPass::AggressiveDCE(Function* func) {
   // Mark function parameters as live.
   AddToWorklist(&func->DefInst());
@@ -418,102 +602,7 @@ bool AggressiveDCEPass::AggressiveDCE(Function* func) {
   if (!private_like_local_)
     for (auto& ps : private_stores_) AddToWorklist(ps);
   // Perform closure on live instruction set.
-  while (!worklist_.empty()) {
-    Instruction* liveInst = worklist_.front();
-    // Add all operand instructions if not already live
-    liveInst->ForEachInId([&liveInst, this](const uint32_t* iid) {
-      Instruction* inInst = get_def_use_mgr()->GetDef(*iid);
-      // Do not add label if an operand of a branch. This is not needed
-      // as part of live code discovery and can create false live code,
-      // for example, the branch to a header of a loop.
-      if (inInst->opcode() == SpvOpLabel && liveInst->IsBranch()) return;
-      AddToWorklist(inInst);
-    });
-    if (liveInst->type_id() != 0) {
-      AddToWorklist(get_def_use_mgr()->GetDef(liveInst->type_id()));
-    }
-    // If in a structured if or loop construct, add the controlling
-    // conditional branch and its merge.
-    BasicBlock* blk = context()->get_instr_block(liveInst);
-    Instruction* branchInst = block2headerBranch_[blk];
-    if (branchInst != nullptr) {
-      AddToWorklist(branchInst);
-      Instruction* mergeInst = branch2merge_[branchInst];
-      AddToWorklist(mergeInst);
-    }
-    // If the block is a header, add the next outermost controlling
-    // conditional branch and its merge.
-    Instruction* nextBranchInst = header2nextHeaderBranch_[blk];
-    if (nextBranchInst != nullptr) {
-      AddToWorklist(nextBranchInst);
-      Instruction* mergeInst = branch2merge_[nextBranchInst];
-      AddToWorklist(mergeInst);
-    }
-    // If local load, add all variable's stores if variable not already live
-    if (liveInst->opcode() == SpvOpLoad || liveInst->IsAtomicWithLoad()) {
-      uint32_t varId;
-      (void)GetPtr(liveInst, &varId);
-      if (varId != 0) {
-        ProcessLoad(varId);
-      }
-      // Process memory copies like loads
-    } else if (liveInst->opcode() == SpvOpCopyMemory ||
-               liveInst->opcode() == SpvOpCopyMemorySized) {
-      uint32_t varId;
-      (void)GetPtr(liveInst->GetSingleWordInOperand(kCopyMemorySourceAddrInIdx),
-                   &varId);
-      if (varId != 0) {
-        ProcessLoad(varId);
-      }
-      // If merge, add other branches that are part of its control structure
-    } else if (liveInst->opcode() == SpvOpLoopMerge ||
-               liveInst->opcode() == SpvOpSelectionMerge) {
-      AddBreaksAndContinuesToWorklist(liveInst);
-      // If function call, treat as if it loads from all pointer arguments
-    } else if (liveInst->opcode() == SpvOpFunctionCall) {
-      liveInst->ForEachInId([this](const uint32_t* iid) {
-        // Skip non-ptr args
-        if (!IsPtr(*iid)) return;
-        uint32_t varId;
-        (void)GetPtr(*iid, &varId);
-        ProcessLoad(varId);
-      });
-      // If function parameter, treat as if it's result id is loaded from
-    } else if (liveInst->opcode() == SpvOpFunctionParameter) {
-      ProcessLoad(liveInst->result_id());
-      // We treat an OpImageTexelPointer as a load of the pointer, and
-      // that value is manipulated to get the result.
-    } else if (liveInst->opcode() == SpvOpImageTexelPointer) {
-      uint32_t varId;
-      (void)GetPtr(liveInst, &varId);
-      if (varId != 0) {
-        ProcessLoad(varId);
-      }
-    }
-
-    // Add OpDecorateId instructions that apply to this instruction to the work
-    // list.  We use the decoration manager to look through the group
-    // decorations to get to the OpDecorate* instructions themselves.
-    auto decorations =
-        get_decoration_mgr()->GetDecorationsFor(liveInst->result_id(), false);
-    for (Instruction* dec : decorations) {
-      // We only care about OpDecorateId instructions because the are the only
-      // decorations that will reference an id that will have to be kept live
-      // because of that use.
-      if (dec->opcode() != SpvOpDecorateId) {
-        continue;
-      }
-      if (dec->GetSingleWordInOperand(1) ==
-          SpvDecorationHlslCounterBufferGOOGLE) {
-        // These decorations should not force the use id to be live.  It will be
-        // removed if either the target or the in operand are dead.
-        continue;
-      }
-      AddToWorklist(dec);
-    }
-
-    worklist_.pop();
-  }
+  ProcessWorklist();
 
   // Kill dead instructions and remember dead blocks
   for (auto bi = structuredOrder.begin(); bi != structuredOrder.end();) {
@@ -640,14 +729,42 @@ Pass::Status AggressiveDCEPass::ProcessImpl() {
   // return unmodified.
   if (!AllExtensionsSupported()) return Status::SuccessWithoutChange;
 
+  // Find the functions in which a previous run found nothing to remove, and
+  // that have not changed since.  If that is the case for the whole module,
+  // there is nothing to do.
+  unchanged_functions_.clear();
+  bool module_unchanged = IsUnchanged(0, ModuleFingerprint());
+  bool all_unchanged = module_unchanged;
+  for (auto& func : *get_module()) {
+    if (IsUnchanged(func.result_id(), FunctionFingerprint(&func))) {
+      unchanged_functions_.insert(&func);
+    } else {
+      all_unchanged = false;
+    }
+  }
+  if (all_unchanged) return Status::SuccessWithoutChange;
+
   // Eliminate Dead functions.
   bool modified = EliminateDeadFunctions();
 
   InitializeModuleScopeLiveInstructions();
 
-  // Process all entry point functions.
-  ProcessFunction pfn = [this](Function* fp) { return AggressiveDCE(fp); };
+  // Process all entry point functions.  The unchanged functions are only
+  // marked live, so the module-level instructions they use are kept.
+  std::unordered_set<const Function*> modified_functions;
+  ProcessFunction pfn = [this, &modified_functions](Function* fp) {
+    if (unchanged_functions_.count(fp)) {
+      MarkFunctionLive(fp);
+      return false;
+    }
+    if (!AggressiveDCE(fp)) return false;
+    modified_functions.insert(fp);
+    return true;
+  };
   modified |= context()->ProcessEntryPointCallTree(pfn);
+  if (!unchanged_functions_.empty()) {
+    MarkDecorateIdsLive();
+  }
 
   // If the decoration manager is kept live then the context will try to keep it
   // up to date.  ADCE deals with group decorations by changing the operands in
@@ -662,7 +779,8 @@ Pass::Status AggressiveDCEPass::ProcessImpl() {
 
   // Process module-level instructions. Now that all live instructions have
   // been marked, it is safe to remove dead global values.
-  modified |= ProcessGlobalValues();
+  bool globals_modified = ProcessGlobalValues();
+  modified |= globals_modified;
 
   // Sanity check.
   assert(to_kill_.size() == 0 || modified);
@@ -672,10 +790,33 @@ Pass::Status AggressiveDCEPass::ProcessImpl() {
     context()->KillInst(inst);
   }
 
-  // Cleanup all CFG including all unreachable blocks.
-  ProcessFunction cleanup = [this](Function* f) { return CFGCleanup(f); };
+  // Cleanup all CFG including all unreachable blocks.  Remember the functions
+  // in which nothing was removed, so the next run can skip them while they
+  // do not change.
+  auto* fingerprints = context()->dead_code_fingerprints();
+  bool cleanup_modified = false;
+  ProcessFunction cleanup = [this, &modified_functions, &cleanup_modified,
+                             fingerprints](Function* f) {
+    if (unchanged_functions_.count(f)) return false;
+    bool cleaned = CFGCleanup(f);
+    cleanup_modified |= cleaned;
+    if (cleaned || modified_functions.count(f)) {
+      fingerprints->erase(f->result_id());
+    } else {
+      (*fingerprints)[f->result_id()] = FunctionFingerprint(f);
+    }
+    return cleaned;
+  };
   modified |= context()->ProcessEntryPointCallTree(cleanup);
 
+  // Removing unreachable blocks can leave global values unused, so the
+  // module-level instructions are only remembered if nothing was removed.
+  if (globals_modified || cleanup_modified) {
+    fingerprints->erase(0);
+  } else if (!module_unchanged) {
+    (*fingerprints)[0] = ModuleFingerprint();
+  }
+
   return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
 }
 
@@ -695,6 +836,9 @@ bool AggressiveDCEPass::EliminateDeadFunctions() {
        funcIter != get_module()->end();) {
     if (live_function_set.count(&*funcIter) == 0) {
       modified = true;
+      // A later function with the same id is not the one fingerprinted.
+      context()->dead_code_fingerprints()->erase(funcIter->result_id());
+      unchanged_functions_.erase(&*funcIter);
       EliminateFunction(&*funcIter);
       funcIter = funcIter.Erase();
     } else {
@@ -141,6 +141,32 @@ class AggressiveDCEPass : public MemPass {
   // TODO(): Remove useless control constructs.
   bool AggressiveDCE(Function* func);
 
+  // Marks as live the instructions used by the instructions in the worklist,
+  // and the instructions they use in turn, until the worklist is empty.
+  void ProcessWorklist();
+
+  // Returns a fingerprint of the instructions of |func| and of whether it is
+  // an entry point.
+  size_t FunctionFingerprint(Function* func);
+
+  // Returns a fingerprint of the module-level instructions this pass looks
+  // at.
+  size_t ModuleFingerprint();
+
+  // Returns true if |fingerprint| is the fingerprint recorded in the context
+  // for |id| by a previous run.  See IRContext::dead_code_fingerprints.
+  bool IsUnchanged(uint32_t id, size_t fingerprint);
+
+  // Marks every instruction of |func| as live, and then the module-level
+  // instructions they use.  This is done instead of AggressiveDCE for a
+  // function in which a previous run found nothing to remove.
+  void MarkFunctionLive(Function* func);
+
+  // Marks as live the OpDecorateId instructions whose target is live.  For
+  // the functions processed by AggressiveDCE this is done while computing the
+  // closure, but not for those marked by MarkFunctionLive.
+  void MarkDecorateIdsLive();
+
   Pass::Status ProcessImpl();
 
   // True if current function has a call instruction contained in it
@@ -152,6 +178,10 @@ class AggressiveDCEPass : public MemPass {
   // True if current function is entry point and has no function calls.
   bool private_like_local_;
 
+  // Functions in which a previous run found nothing to remove, and that have
+  // not changed since.
+  std::unordered_set<const Function*> unchanged_functions_;
+
   // Live Instruction Worklist.  An instruction is added to this list
   // if it might have a side effect, either directly or indirectly.
   // If we don't know, then add it to this list.  Instructions are
@@ -0,0 +1,309 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/alias_analysis.h"
+
+#include <algorithm>
+
+#include "source/opt/ir_context.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const uint32_t kTypePointerStorageClassInIdx = 0;
+const uint32_t kAccessChainBaseInIdx = 0;
+const uint32_t kPtrAccessChainElementInIdx = 1;
+const uint32_t kLoadStorePointerInIdx = 0;
+
+// Returns true if distinct variables in |storage_class| are always
+// allocated separately.  Variables in other storage classes are bound to
+// memory by the client API, which may bind the same memory more than once.
+bool VariablesAreDisjoint(uint32_t storage_class) {
+  switch (storage_class) {
+    case SpvStorageClassFunction:
+    case SpvStorageClassPrivate:
+    case SpvStorageClassWorkgroup:
+    case SpvStorageClassInput:
+    case SpvStorageClassOutput:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+AliasAnalysis::Result AliasAnalysis::Alias(uint32_t ptr1, uint32_t ptr2) {
+  analysis::DefUseManager* def_use_mgr = context_->get_def_use_mgr();
+  return Alias(def_use_mgr->GetDef(ptr1), def_use_mgr->GetDef(ptr2));
+}
+
+AliasAnalysis::Result AliasAnalysis::Alias(Instruction* ptr1,
+                                           Instruction* ptr2) {
+  return Alias(ptr1, ptr2, false);
+}
+
+AliasAnalysis::Result AliasAnalysis::AliasInSameIteration(Instruction* ptr1,
+                                                          Instruction* ptr2) {
+  return Alias(ptr1, ptr2, true);
+}
+
+AliasAnalysis::Result AliasAnalysis::Alias(Instruction* ptr1,
+                                           Instruction* ptr2,
+                                           bool same_iteration) {
+  if (ptr1 == ptr2 && (same_iteration || !IsDefinedInLoop(ptr1))) {
+    return kMustAlias;
+  }
+
+  // References to elements of an unordered_map survive inserting more
+  // elements, so both can be held at once.
+  const PointerInfo& info1 = GetPointerInfo(ptr1);
+  const PointerInfo& info2 = GetPointerInfo(ptr2);
+
+  if (info1.storage_class != info2.storage_class) {
+    // A generic pointer can point into several other storage classes.
+    if (info1.storage_class == SpvStorageClassGeneric ||
+        info2.storage_class == SpvStorageClassGeneric) {
+      return kMayAlias;
+    }
+    // The client API may bind the same memory to variables in different
+    // storage classes, such as a StorageBuffer and a Uniform buffer block, or
+    // to a physical storage buffer address.
+    if (VariablesAreDisjoint(info1.storage_class) ||
+        VariablesAreDisjoint(info2.storage_class)) {
+      return kNoAlias;
+    }
+  }
+
+  if (info1.root == nullptr || info2.root == nullptr) {
+    return kMayAlias;
+  }
+
+  if (info1.root != info2.root) {
+    return AliasDifferentRoots(info1, info2);
+  }
+  return AliasSameRoot(info1, info2, same_iteration);
+}
+
+AliasAnalysis::Result AliasAnalysis::AliasMemoryAccesses(Instruction* inst1,
+                                                         Instruction* inst2) {
+  assert((inst1->opcode() == SpvOpLoad || inst1->opcode() == SpvOpStore) &&
+         (inst2->opcode() == SpvOpLoad || inst2->opcode() == SpvOpStore) &&
+         "Expecting loads or stores.");
+  return Alias(inst1->GetSingleWordInOperand(kLoadStorePointerInIdx),
+               inst2->GetSingleWordInOperand(kLoadStorePointerInIdx));
+}
+
+Instruction* AliasAnalysis::GetRoot(Instruction* ptr) {
+  return GetPointerInfo(ptr).root;
+}
+
+const AliasAnalysis::PointerInfo& AliasAnalysis::GetPointerInfo(
+    Instruction* ptr) {
+  auto it = pointers_.find(ptr->result_id());
+  if (it != pointers_.end()) {
+    return it->second;
+  }
+
+  analysis::DefUseManager* def_use_mgr = context_->get_def_use_mgr();
+  PointerInfo info;
+  switch (ptr->opcode()) {
+    case SpvOpVariable:
+    case SpvOpFunctionParameter:
+      info.root = ptr;
+      break;
+    case SpvOpAccessChain:
+    case SpvOpInBoundsAccessChain: {
+      info = GetPointerInfo(def_use_mgr->GetDef(
+          ptr->GetSingleWordInOperand(kAccessChainBaseInIdx)));
+      for (uint32_t i = kAccessChainBaseInIdx + 1; i < ptr->NumInOperands();
+           ++i) {
+        info.indices.push_back(ptr->GetSingleWordInOperand(i));
+      }
+      break;
+    }
+    case SpvOpPtrAccessChain:
+    case SpvOpInBoundsPtrAccessChain: {
+      // The element operand moves the pointer to another element of the
+      // array containing the base, which stays inside the same memory object
+      // but is not described by the indices.
+      info = GetPointerInfo(def_use_mgr->GetDef(
+          ptr->GetSingleWordInOperand(kAccessChainBaseInIdx)));
+      const analysis::Constant* element =
+          context_->get_constant_mgr()->FindDeclaredConstant(
+              ptr->GetSingleWordInOperand(kPtrAccessChainElementInIdx));
+      if (element == nullptr || !element->IsZero()) {
+        info.exact = false;
+      }
+      for (uint32_t i = kPtrAccessChainElementInIdx + 1;
+           i < ptr->NumInOperands(); ++i) {
+        info.indices.push_back(ptr->GetSingleWordInOperand(i));
+      }
+      break;
+    }
+    case SpvOpCopyObject:
+    case SpvOpBitcast: {
+      Instruction* base = def_use_mgr->GetDef(ptr->GetSingleWordInOperand(0));
+      Instruction* base_type = def_use_mgr->GetDef(base->type_id());
+      if (base_type->opcode() != SpvOpTypePointer) {
+        // A pointer made from an integer can point anywhere.
+        info.exact = false;
+        break;
+      }
+      info = GetPointerInfo(base);
+      if (ptr->opcode() == SpvOpBitcast) {
+        info.exact = false;
+      }
+      break;
+    }
+    default:
+      // Pointers loaded from memory, selected between several pointers, and
+      // so on, are not followed.
+      info.exact = false;
+      break;
+  }
+
+  Instruction* ptr_type = def_use_mgr->GetDef(ptr->type_id());
+  assert(ptr_type->opcode() == SpvOpTypePointer && "Expecting a pointer.");
+  info.storage_class =
+      ptr_type->GetSingleWordInOperand(kTypePointerStorageClassInIdx);
+
+  return pointers_[ptr->result_id()] = std::move(info);
+}
+
+AliasAnalysis::Result AliasAnalysis::AliasDifferentRoots(
+    const PointerInfo& info1, const PointerInfo& info2) {
+  Instruction* root1 = info1.root;
+  Instruction* root2 = info2.root;
+
+  // Memory accessed through a restricted declaration is not accessed through
+  // any other declaration.
+  bool restrict1 = HasDecoration(root1, SpvDecorationRestrict) &&
+                   !HasDecoration(root1, SpvDecorationAliased);
+  bool restrict2 = HasDecoration(root2, SpvDecorationRestrict) &&
+                   !HasDecoration(root2, SpvDecorationAliased);
+  if (restrict1 || restrict2) {
+    return kNoAlias;
+  }
+
+  if (root1->opcode() == SpvOpVariable && root2->opcode() == SpvOpVariable) {
+    return VariablesAreDisjoint(info1.storage_class) ? kNoAlias : kMayAlias;
+  }
+
+  // A parameter is created by the caller, so it cannot point to a function
+  // scope variable of the function it belongs to.
+  if (root1->opcode() == SpvOpFunctionParameter) {
+    std::swap(root1, root2);
+  }
+  if (root1->opcode() == SpvOpVariable &&
+      info1.storage_class == SpvStorageClassFunction) {
+    BasicBlock* var_block = context_->get_instr_block(root1);
+    bool is_own_param = false;
+    if (var_block != nullptr) {
+      var_block->GetParent()->ForEachParam(
+          [root2, &is_own_param](Instruction* param) {
+            if (param == root2) is_own_param = true;
+          });
+    }
+    if (is_own_param) {
+      return kNoAlias;
+    }
+  }
+  return kMayAlias;
+}
+
+AliasAnalysis::Result AliasAnalysis::AliasSameRoot(const PointerInfo& info1,
+                                                   const PointerInfo& info2,
+                                                   bool same_iteration) {
+  if (!info1.exact || !info2.exact) {
+    return kMayAlias;
+  }
+
+  // Both index lists walk the same types, so a single index that is known to
+  // differ is enough to separate the pointers, even if earlier indices are
+  // unknown.
+  Result result = kMustAlias;
+  size_t num_indices = std::min(info1.indices.size(), info2.indices.size());
+  for (size_t i = 0; i < num_indices; ++i) {
+    Result index_result =
+        CompareIndices(info1.indices[i], info2.indices[i], same_iteration);
+    if (index_result == kNoAlias) {
+      return kNoAlias;
+    }
+    if (index_result == kMayAlias) {
+      result = kMayAlias;
+    }
+  }
+
+  // One pointer points inside the object pointed to by the other.
+  if (info1.indices.size() != info2.indices.size()) {
+    return kMayAlias;
+  }
+  return result;
+}
+
+AliasAnalysis::Result AliasAnalysis::CompareIndices(uint32_t index1,
+                                                    uint32_t index2,
+                                                    bool same_iteration) {
+  analysis::ConstantManager* const_mgr = context_->get_constant_mgr();
+  const analysis::Constant* const1 = const_mgr->FindDeclaredConstant(index1);
+  const analysis::Constant* const2 = const_mgr->FindDeclaredConstant(index2);
+  if (const1 != nullptr && const2 != nullptr && const1->AsIntConstant() &&
+      const2->AsIntConstant()) {
+    return const1->GetSignExtendedValue() == const2->GetSignExtendedValue()
+               ? kMustAlias
+               : kNoAlias;
+  }
+
+  // The values of an index defined inside a loop in two different iterations
+  // are unrelated.
+  analysis::DefUseManager* def_use_mgr = context_->get_def_use_mgr();
+  Instruction* def1 = def_use_mgr->GetDef(index1);
+  Instruction* def2 = def_use_mgr->GetDef(index2);
+  if (!same_iteration && (IsDefinedInLoop(def1) || IsDefinedInLoop(def2))) {
+    return kMayAlias;
+  }
+
+  if (index1 == index2) {
+    return kMustAlias;
+  }
+
+  ScalarEvolutionAnalysis* scev = context_->GetScalarEvolutionAnalysis();
+  SENode* difference = scev->SimplifyExpression(
+      scev->CreateSubtraction(scev->AnalyzeInstruction(def1),
+                              scev->AnalyzeInstruction(def2)));
+  if (SEConstantNode* constant = difference->AsSEConstantNode()) {
+    return constant->FoldToSingleValue() == 0 ? kMustAlias : kNoAlias;
+  }
+  return kMayAlias;
+}
+
+bool AliasAnalysis::IsDefinedInLoop(Instruction* inst) {
+  BasicBlock* block = context_->get_instr_block(inst);
+  if (block == nullptr) {
+    return false;
+  }
+  return (*context_->GetLoopDescriptor(block->GetParent()))[block] != nullptr;
+}
+
+bool AliasAnalysis::HasDecoration(const Instruction* inst,
+                                  uint32_t decoration) {
+  return !context_->get_decoration_mgr()->WhileEachDecoration(
+      inst->result_id(), decoration,
+      [](const Instruction&) { return false; });
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,145 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_ALIAS_ANALYSIS_H_
+#define SOURCE_OPT_ALIAS_ANALYSIS_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "source/opt/instruction.h"
+
+namespace spvtools {
+namespace opt {
+
+class IRContext;
+
+// Answers whether two pointers can refer to overlapping memory.
+//
+// A pointer is decomposed into the memory object declaration it is derived
+// from (its root) and the indices of the access chains applied to that root.
+// Two pointers with different roots are disjoint if the storage classes and
+// decorations of the roots guarantee it.  Two pointers with the same root are
+// compared index by index, using constants and the scalar evolution analysis
+// to prove that indices differ.
+//
+// A value computed inside a loop can be different in each iteration, so by
+// default indices defined inside a loop are only compared when they are
+// constants.  When both pointers are known to be computed in the same
+// iteration of every loop that contains them, AliasInSameIteration also
+// compares such indices.  The decomposition of each pointer is cached, so
+// any change to the instructions that compute a pointer must be followed by
+// a call to RemoveInstruction or by invalidating the analysis.
+class AliasAnalysis {
+ public:
+  enum Result {
+    // The pointers never refer to overlapping memory.
+    kNoAlias,
+    // The pointers may refer to overlapping memory.  This includes pointers
+    // that are known to overlap only partially, such as a pointer to a struct
+    // and a pointer to one of its members.
+    kMayAlias,
+    // The pointers always refer to exactly the same memory.
+    kMustAlias,
+  };
+
+  explicit AliasAnalysis(IRContext* context) : context_(context) {}
+
+  // Returns the relationship between the memory pointed to by the pointers
+  // with ids |ptr1| and |ptr2|, computed anywhere in the same invocation of
+  // the function.
+  Result Alias(uint32_t ptr1, uint32_t ptr2);
+
+  // Returns the relationship between the memory pointed to by the results of
+  // |ptr1| and |ptr2|, computed anywhere in the same invocation of the
+  // function.
+  Result Alias(Instruction* ptr1, Instruction* ptr2);
+
+  // Returns the relationship between the memory pointed to by the results of
+  // |ptr1| and |ptr2|, which must be computed in the same iteration of every
+  // loop that contains them, for example between two points of the same basic
+  // block with no back edge in between.
+  Result AliasInSameIteration(Instruction* ptr1, Instruction* ptr2);
+
+  // Returns the relationship between the memory accessed by |inst1| and
+  // |inst2|, which must each be an OpLoad or OpStore.
+  Result AliasMemoryAccesses(Instruction* inst1, Instruction* inst2);
+
+  // Returns the memory object declaration that |ptr| is derived from, or
+  // nullptr if it cannot be determined.  The result is an OpVariable or an
+  // OpFunctionParameter.
+  Instruction* GetRoot(Instruction* ptr);
+
+  // Forgets the cached decomposition of the pointer defined by |inst|.
+  void RemoveInstruction(Instruction* inst) {
+    pointers_.erase(inst->result_id());
+  }
+
+ private:
+  // The decomposition of a pointer.
+  struct PointerInfo {
+    // The OpVariable or OpFunctionParameter the pointer is derived from, or
+    // nullptr if it is unknown.
+    Instruction* root = nullptr;
+
+    // The ids of the indices applied to |root|, starting with the outermost
+    // access chain.
+    std::vector<uint32_t> indices;
+
+    // True if |indices| exactly describes the pointer.  It is false when the
+    // pointer goes through an OpPtrAccessChain or a bitcast.
+    bool exact = true;
+
+    // The storage class of the pointer.
+    uint32_t storage_class = 0;
+  };
+
+  // Implements Alias and AliasInSameIteration.
+  Result Alias(Instruction* ptr1, Instruction* ptr2, bool same_iteration);
+
+  // Returns the decomposition of |ptr|, computing it if it is not cached.
+  const PointerInfo& GetPointerInfo(Instruction* ptr);
+
+  // Returns the relationship between pointers with different roots.
+  Result AliasDifferentRoots(const PointerInfo& info1,
+                             const PointerInfo& info2);
+
+  // Returns the relationship between pointers with the same root.
+  Result AliasSameRoot(const PointerInfo& info1, const PointerInfo& info2,
+                       bool same_iteration);
+
+  // Returns kNoAlias if the index ids |index1| and |index2| are known to have
+  // different values, kMustAlias if they are known to be equal, and kMayAlias
+  // otherwise.  Unless |same_iteration| is true, indices defined inside a
+  // loop are only compared if they are constants.
+  Result CompareIndices(uint32_t index1, uint32_t index2, bool same_iteration);
+
+  // Returns true if |inst| is in a block that belongs to a loop, so that it
+  // may compute a different value in each iteration.
+  bool IsDefinedInLoop(Instruction* inst);
+
+  // Returns true if |inst| is decorated with |decoration|.
+  bool HasDecoration(const Instruction* inst, uint32_t decoration);
+
+  IRContext* context_;
+
+  // Maps the id of each pointer that has been queried to its decomposition.
+  std::unordered_map<uint32_t, PointerInfo> pointers_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_ALIAS_ANALYSIS_H_
@@ -46,6 +46,16 @@ spv_result_t SetSpvInst(void* builder, const spv_parsed_instruction_t* inst) {
 
 }  // namespace
 
+bool LoadModule(spv_const_context context, MessageConsumer consumer,
+                const uint32_t* binary, size_t size, opt::Module* module) {
+  opt::IrLoader loader(consumer, module);
+
+  spv_result_t status = spvBinaryParse(context, &loader, binary, size,
+                                       SetSpvHeader, SetSpvInst, nullptr);
+  loader.EndModule();
+  return status == SPV_SUCCESS;
+}
+
 std::unique_ptr<opt::IRContext> BuildModule(spv_target_env env,
                                             MessageConsumer consumer,
                                             const uint32_t* binary,
@@ -54,15 +64,12 @@ std::unique_ptr<opt::IRContext> BuildModule(spv_target_env env,
   SetContextMessageConsumer(context, consumer);
 
   auto irContext = MakeUnique<opt::IRContext>(env, consumer);
-  opt::IrLoader loader(consumer, irContext->module());
-
-  spv_result_t status = spvBinaryParse(context, &loader, binary, size,
-                                       SetSpvHeader, SetSpvInst, nullptr);
-  loader.EndModule();
+  bool loaded =
+      LoadModule(context, consumer, binary, size, irContext->module());
 
   spvContextDestroy(context);
 
-  return status == SPV_SUCCESS ? std::move(irContext) : nullptr;
+  return loaded ? std::move(irContext) : nullptr;
 }
 
 std::unique_ptr<opt::IRContext> BuildModule(spv_target_env env,
@@ -24,6 +24,12 @@
 
 namespace spvtools {
 
+// Parses the given SPIR-V |binary| of |size| words into |module|, which must be
+// empty, using the grammar tables of |context|.  Returns false if errors occur
+// and sends the errors to |consumer|.
+bool LoadModule(spv_const_context context, MessageConsumer consumer,
+                const uint32_t* binary, size_t size, opt::Module* module);
+
 // Builds an Module returns the owning IRContext from the given SPIR-V
 // |binary|. |size| specifies number of words in |binary|. The |binary| will be
 // decoded according to the given target |env|. Returns nullptr if errors occur
@@ -21,11 +21,14 @@
 
 #include <algorithm>
 #include <limits>
+#include <utility>
+#include <vector>
 
 #include "source/opt/fold.h"
 #include "source/opt/function.h"
 #include "source/opt/module.h"
 #include "source/opt/propagator.h"
+#include "source/util/make_unique.h"
 
 namespace spvtools {
 namespace opt {
@@ -41,10 +44,21 @@ const uint32_t kVaryingSSAId = std::numeric_limits<uint32_t>::max();
 
 bool CCPPass::IsVaryingValue(uint32_t id) const { return id == kVaryingSSAId; }
 
+uint32_t CCPPass::GetValue(uint32_t id) const {
+  return id < values_.size() ? values_[id] : 0;
+}
+
+void CCPPass::SetValue(uint32_t id, uint32_t value) {
+  if (id >= values_.size()) {
+    values_.resize(id + 1, 0);
+  }
+  values_[id] = value;
+}
+
 SSAPropagator::PropStatus CCPPass::MarkInstructionVarying(Instruction* instr) {
   assert(instr->result_id() != 0 &&
          "Instructions with no result cannot be marked varying.");
-  values_[instr->result_id()] = kVaryingSSAId;
+  SetValue(instr->result_id(), kVaryingSSAId);
   return SSAPropagator::kVarying;
 }
 
@@ -59,20 +73,19 @@ SSAPropagator::PropStatus CCPPass::VisitPhi(Instruction* phi) {
       // Ignore arguments coming through non-executable edges.
       continue;
     }
-    uint32_t phi_arg_id = phi->GetSingleWordOperand(i);
-    auto it = values_.find(phi_arg_id);
-    if (it != values_.end()) {
+    uint32_t phi_arg_val = GetValue(phi->GetSingleWordOperand(i));
+    if (phi_arg_val != 0) {
       // We found an argument with a constant value.  Apply the meet operation
       // with the previous arguments.
-      if (it->second == kVaryingSSAId) {
+      if (phi_arg_val == kVaryingSSAId) {
         // The "constant" value is actually a placeholder for varying. Return
         // varying for this phi.
         return MarkInstructionVarying(phi);
       } else if (meet_val_id == 0) {
         // This is the first argument we find.  Initialize the result to its
         // constant value id.
-        meet_val_id = it->second;
-      } else if (it->second == meet_val_id) {
+        meet_val_id = phi_arg_val;
+      } else if (phi_arg_val == meet_val_id) {
         // The argument is the same constant value already computed. Continue
         // looking.
         continue;
@@ -98,7 +111,19 @@ SSAPropagator::PropStatus CCPPass::VisitPhi(Instruction* phi) {
 
   // All the operands have the same constant value represented by |meet_val_id|.
   // Set the Phi's result to that value and declare it interesting.
-  values_[phi->result_id()] = meet_val_id;
+  SetValue(phi->result_id(), meet_val_id);
+  return SSAPropagator::kInteresting;
+}
+
+SSAPropagator::PropStatus CCPPass::VisitFunctionCall(Instruction* call) {
+  auto it = return_values_.find(call->GetSingleWordInOperand(0));
+  if (it == return_values_.end() || it->second == 0 ||
+      IsVaryingValue(it->second)) {
+    // If none of the returns of the callee executes yet, the result is
+    // varying until a later round finds its value.
+    return MarkInstructionVarying(call);
+  }
+  SetValue(call->result_id(), it->second);
   return SSAPropagator::kInteresting;
 }
 
@@ -106,16 +131,19 @@ SSAPropagator::PropStatus CCPPass::VisitAssignment(Instruction* instr) {
   assert(instr->result_id() != 0 &&
          "Expecting an instruction that produces a result");
 
+  if (interprocedural_ && instr->opcode() == SpvOpFunctionCall) {
+    return VisitFunctionCall(instr);
+  }
+
   // If this is a copy operation, and the RHS is a known constant, assign its
   // value to the LHS.
   if (instr->opcode() == SpvOpCopyObject) {
-    uint32_t rhs_id = instr->GetSingleWordInOperand(0);
-    auto it = values_.find(rhs_id);
-    if (it != values_.end()) {
-      if (IsVaryingValue(it->second)) {
+    uint32_t rhs_val = GetValue(instr->GetSingleWordInOperand(0));
+    if (rhs_val != 0) {
+      if (IsVaryingValue(rhs_val)) {
         return MarkInstructionVarying(instr);
       } else {
-        values_[instr->result_id()] = it->second;
+        SetValue(instr->result_id(), rhs_val);
         return SSAPropagator::kInteresting;
       }
     }
@@ -129,11 +157,11 @@ SSAPropagator::PropStatus CCPPass::VisitAssignment(Instruction* instr) {
 
   // See if the RHS of the assignment folds into a constant value.
   auto map_func = [this](uint32_t id) {
-    auto it = values_.find(id);
-    if (it == values_.end() || IsVaryingValue(it->second)) {
+    uint32_t val = GetValue(id);
+    if (val == 0 || IsVaryingValue(val)) {
       return id;
     }
-    return it->second;
+    return val;
   };
   Instruction* folded_inst =
       context()->get_instruction_folder().FoldInstructionToConstant(instr,
@@ -142,15 +170,13 @@ SSAPropagator::PropStatus CCPPass::VisitAssignment(Instruction* instr) {
     // We do not want to change the body of the function by adding new
     // instructions.  When folding we can only generate new constants.
     assert(folded_inst->IsConstant() && "CCP is only interested in constant.");
-    values_[instr->result_id()] = folded_inst->result_id();
+    SetValue(instr->result_id(), folded_inst->result_id());
     return SSAPropagator::kInteresting;
   }
 
   // Conservatively mark this instruction as varying if any input id is varying.
   if (!instr->WhileEachInId([this](uint32_t* op_id) {
-        auto iter = values_.find(*op_id);
-        if (iter != values_.end() && IsVaryingValue(iter->second)) return false;
-        return true;
+        return !IsVaryingValue(GetValue(*op_id));
       })) {
     return MarkInstructionVarying(instr);
   }
@@ -158,9 +184,7 @@ SSAPropagator::PropStatus CCPPass::VisitAssignment(Instruction* instr) {
   // If not, see if there is a least one unknown operand to the instruction.  If
   // so, we might be able to fold it later.
   if (!instr->WhileEachInId([this](uint32_t* op_id) {
-        auto it = values_.find(*op_id);
-        if (it == values_.end()) return false;
-        return true;
+        return GetValue(*op_id) != 0;
       })) {
     return SSAPropagator::kNotInteresting;
   }
@@ -183,16 +207,14 @@ SSAPropagator::PropStatus CCPPass::VisitBranch(Instruction* instr,
     // For a conditional branch, determine whether the predicate selector has a
     // known value in |values_|.  If it does, set the destination block
     // according to the selector's boolean value.
-    uint32_t pred_id = instr->GetSingleWordOperand(0);
-    auto it = values_.find(pred_id);
-    if (it == values_.end() || IsVaryingValue(it->second)) {
+    uint32_t pred_val_id = GetValue(instr->GetSingleWordOperand(0));
+    if (pred_val_id == 0 || IsVaryingValue(pred_val_id)) {
       // The predicate has an unknown value, either branch could be taken.
       return SSAPropagator::kVarying;
     }
 
     // Get the constant value for the predicate selector from the value table.
     // Use it to decide which branch will be taken.
-    uint32_t pred_val_id = it->second;
     const analysis::Constant* c = const_mgr_->FindDeclaredConstant(pred_val_id);
     assert(c && "Expected to find a constant declaration for a known value.");
     // Undef values should have returned as varying above.
@@ -214,16 +236,14 @@ SSAPropagator::PropStatus CCPPass::VisitBranch(Instruction* instr,
       // Add support for wider constants.
       return SSAPropagator::kVarying;
     }
-    uint32_t select_id = instr->GetSingleWordOperand(0);
-    auto it = values_.find(select_id);
-    if (it == values_.end() || IsVaryingValue(it->second)) {
+    uint32_t select_val_id = GetValue(instr->GetSingleWordOperand(0));
+    if (select_val_id == 0 || IsVaryingValue(select_val_id)) {
       // The selector has an unknown value, any of the branches could be taken.
       return SSAPropagator::kVarying;
     }
 
     // Get the constant value for the selector from the value table. Use it to
     // decide which branch will be taken.
-    uint32_t select_val_id = it->second;
     const analysis::Constant* c =
         const_mgr_->FindDeclaredConstant(select_val_id);
     assert(c && "Expected to find a constant declaration for a known value.");
@@ -265,15 +285,23 @@ SSAPropagator::PropStatus CCPPass::VisitInstruction(Instruction* instr,
   return SSAPropagator::kVarying;
 }
 
-bool CCPPass::ReplaceValues() {
-  bool retval = false;
-  for (const auto& it : values_) {
-    uint32_t id = it.first;
-    uint32_t cst_id = it.second;
-    if (!IsVaryingValue(cst_id) && id != cst_id) {
-      context()->KillNamesAndDecorates(id);
-      retval |= context()->ReplaceAllUsesWith(id, cst_id);
+bool CCPPass::ReplaceValues(Function* fp) {
+  // Only the parameters and instructions of |fp| get a value other than
+  // themselves or varying while |fp| is propagated.
+  std::vector<std::pair<uint32_t, uint32_t>> replacements;
+  fp->ForEachInst([this, &replacements](Instruction* inst) {
+    uint32_t id = inst->result_id();
+    uint32_t cst_id = GetValue(id);
+    if (cst_id != 0 && !IsVaryingValue(cst_id) && id != cst_id) {
+      replacements.emplace_back(id, cst_id);
     }
+  });
+
+  bool retval = false;
+  for (const auto& replacement : replacements) {
+    context()->KillNamesAndDecorates(replacement.first);
+    retval |=
+        context()->ReplaceAllUsesWith(replacement.first, replacement.second);
   }
   return retval;
 }
@@ -281,25 +309,136 @@ bool CCPPass::ReplaceValues() {
 bool CCPPass::PropagateConstants(Function* fp) {
   // Mark function parameters as varying.
   fp->ForEachParam([this](const Instruction* inst) {
-    values_[inst->result_id()] = kVaryingSSAId;
+    SetValue(inst->result_id(), kVaryingSSAId);
   });
 
-  const auto visit_fn = [this](Instruction* instr, BasicBlock** dest_bb) {
-    return VisitInstruction(instr, dest_bb);
+  if (propagator_->Run(fp)) {
+    return ReplaceValues(fp);
+  }
+
+  return false;
+}
+
+void CCPPass::RunPropagator(Function* fp) {
+  fp->ForEachParam([this](const Instruction* inst) {
+    uint32_t value_id = param_values_[inst->result_id()];
+    SetValue(inst->result_id(), value_id != 0 ? value_id : kVaryingSSAId);
+  });
+
+  propagator_->Run(fp);
+}
+
+bool CCPPass::MergeCallValue(uint32_t value_id, uint32_t* merged_id) const {
+  if (value_id == 0 || value_id == *merged_id ||
+      IsVaryingValue(*merged_id) ||
+      (IsVaryingValue(value_id) && !merge_varying_)) {
+    return false;
+  }
+  *merged_id = *merged_id == 0 ? value_id : kVaryingSSAId;
+  return true;
+}
+
+bool CCPPass::UpdateCallValues(Function* fp) {
+  bool changed = false;
+  for (auto& block : *fp) {
+    for (auto& inst : block) {
+      // Only the instructions in blocks that execute have a status.
+      if (!propagator_->HasStatus(&inst)) {
+        break;
+      }
+      if (inst.opcode() == SpvOpFunctionCall) {
+        Function* callee =
+            context()->GetFunction(inst.GetSingleWordInOperand(0));
+        uint32_t arg_index = 1;
+        callee->ForEachParam([this, &inst, &arg_index,
+                              &changed](const Instruction* param) {
+          changed |= MergeCallValue(
+              GetValue(inst.GetSingleWordInOperand(arg_index++)),
+              &param_values_[param->result_id()]);
+        });
+      } else if (inst.opcode() == SpvOpReturnValue) {
+        changed |= MergeCallValue(GetValue(inst.GetSingleWordInOperand(0)),
+                                  &return_values_[fp->result_id()]);
+      }
+    }
+  }
+  return changed;
+}
+
+bool CCPPass::PropagateConstantsAcrossCalls() {
+  param_values_.clear();
+  return_values_.clear();
+  merge_varying_ = false;
+
+  std::vector<Function*> functions;
+  ProcessFunction collect = [&functions](Function* fp) {
+    functions.push_back(fp);
+    return false;
   };
+  context()->ProcessReachableCallTree(collect);
 
-  propagator_ =
-      std::unique_ptr<SSAPropagator>(new SSAPropagator(context(), visit_fn));
+  for (Function* fp : functions) {
+    // Functions that are declared but not defined here can return anything.
+    if (fp->begin() == fp->end()) {
+      return_values_[fp->result_id()] = kVaryingSSAId;
+    }
 
-  if (propagator_->Run(fp)) {
-    return ReplaceValues();
+    // Exported functions can be called from outside the module with any
+    // arguments.
+    bool is_exported = false;
+    get_decoration_mgr()->ForEachDecoration(
+        fp->result_id(), SpvDecorationLinkageAttributes,
+        [&is_exported](const Instruction& linkage_instruction) {
+          uint32_t last_operand = linkage_instruction.NumOperands() - 1;
+          if (linkage_instruction.GetSingleWordOperand(last_operand) ==
+              SpvLinkageTypeExport) {
+            is_exported = true;
+          }
+        });
+    if (is_exported) {
+      fp->ForEachParam([this](const Instruction* inst) {
+        param_values_[inst->result_id()] = kVaryingSSAId;
+      });
+    }
   }
 
-  return false;
+  // Constants folded in a round may not be used in the end, but they are
+  // still new in the module.
+  const uint32_t id_bound = context()->module()->IdBound();
+
+  // The values of the parameters and return values only move towards
+  // varying, so this terminates.  The functions are visited callers first,
+  // so most arguments are known before their callee is propagated.  The
+  // rounds first merge only constant values, so that a value that is varying
+  // because of an unknown parameter or call result does not spread to the
+  // tables, and then merge the varying values too, until nothing changes.
+  while (true) {
+    bool changed = false;
+    Initialize();
+    for (Function* fp : functions) {
+      RunPropagator(fp);
+      changed |= UpdateCallValues(fp);
+    }
+    if (!changed) {
+      if (merge_varying_) {
+        break;
+      }
+      merge_varying_ = true;
+    }
+  }
+
+  // |values_| now holds the values from the last round, which agree with the
+  // values of the parameters and return values.
+  bool modified = false;
+  for (Function* fp : functions) {
+    modified |= ReplaceValues(fp);
+  }
+  return modified || context()->module()->IdBound() != id_bound;
 }
 
 void CCPPass::Initialize() {
   const_mgr_ = context()->get_constant_mgr();
+  values_.assign(get_module()->IdBound(), 0);
 
   // Populate the constant table with values from constant declarations in the
   // module.  The values of each OpConstant declaration is the identity
@@ -308,14 +447,26 @@ void CCPPass::Initialize() {
     // Record compile time constant ids. Treat all other global values as
     // varying.
     if (inst.IsConstant()) {
-      values_[inst.result_id()] = inst.result_id();
+      SetValue(inst.result_id(), inst.result_id());
     } else {
-      values_[inst.result_id()] = kVaryingSSAId;
+      SetValue(inst.result_id(), kVaryingSSAId);
     }
   }
 }
 
 Pass::Status CCPPass::Process() {
+  // The same propagator is run on every function, so its tables are only
+  // allocated once.
+  const auto visit_fn = [this](Instruction* instr, BasicBlock** dest_bb) {
+    return VisitInstruction(instr, dest_bb);
+  };
+  propagator_ = MakeUnique<SSAPropagator>(context(), visit_fn);
+
+  if (interprocedural_) {
+    return PropagateConstantsAcrossCalls() ? Pass::Status::SuccessWithChange
+                                           : Pass::Status::SuccessWithoutChange;
+  }
+
   Initialize();
 
   // Process all entry point functions.
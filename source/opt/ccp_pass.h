@@ -17,6 +17,7 @@
 
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include "source/opt/constants.h"
 #include "source/opt/function.h"
@@ -30,9 +31,15 @@ namespace opt {
 
 class CCPPass : public MemPass {
  public:
-  CCPPass() = default;
-
-  const char* name() const override { return "ccp"; }
+  // If |interprocedural| is true, constants are also propagated from the
+  // arguments of function calls to the parameters of the callee, and from the
+  // return values of the callee to the result of the calls.
+  explicit CCPPass(bool interprocedural = false)
+      : interprocedural_(interprocedural) {}
+
+  const char* name() const override {
+    return interprocedural_ ? "interprocedural-ccp" : "ccp";
+  }
   Status Process() override;
 
   IRContext::Analysis GetPreservedAnalyses() override {
@@ -52,6 +59,28 @@ class CCPPass : public MemPass {
   // constants were propagated and the IR modified.
   bool PropagateConstants(Function* fp);
 
+  // Runs constant propagation on the functions reachable from the entry points
+  // and exported functions, across the calls between them.  Returns true if
+  // the IR was modified.
+  bool PropagateConstantsAcrossCalls();
+
+  // Runs the propagator on |fp|, without changing it.  In interprocedural
+  // mode, the values of the parameters of |fp| are taken from
+  // |param_values_|.  Parameters with no known value yet are varying for this
+  // round.
+  void RunPropagator(Function* fp);
+
+  // Merges the values of the arguments of the calls in |fp| that were found to
+  // execute into |param_values_|, and the values it returns into
+  // |return_values_|.  Returns true if any of them changed.
+  bool UpdateCallValues(Function* fp);
+
+  // Merges |value_id|, the value found for an argument or a return value, into
+  // |*merged_id|, the value for all the calls or returns seen so far.  Both are
+  // 0 if the value is not known yet.  Varying values are ignored unless
+  // |merge_varying_| is set.  Returns true if |*merged_id| changed.
+  bool MergeCallValue(uint32_t value_id, uint32_t* merged_id) const;
+
   // Visits a single instruction |instr|.  If the instruction is a conditional
   // branch that always jumps to the same basic block, it sets the destination
   // block in |dest_bb|.
@@ -63,6 +92,11 @@ class CCPPass : public MemPass {
   // constant value C, the result for |phi| gets assigned the value C.
   SSAPropagator::PropStatus VisitPhi(Instruction* phi);
 
+  // Visits an OpFunctionCall |call| in interprocedural mode.  The result of
+  // |call| has the value returned by every return in the callee, and is
+  // varying for this round if none of them is known to execute yet.
+  SSAPropagator::PropStatus VisitFunctionCall(Instruction* call);
+
   // Visits an SSA assignment instruction |instr|.  If the RHS of |instr| folds
   // into a constant value C, then the LHS of |instr| is assigned the value C in
   // |values_|.
@@ -75,10 +109,10 @@ class CCPPass : public MemPass {
   SSAPropagator::PropStatus VisitBranch(Instruction* instr,
                                         BasicBlock** dest_bb) const;
 
-  // Replaces all operands used in |fp| with the corresponding constant values
-  // in |values_|.  Returns true if any operands were replaced, and false
-  // otherwise.
-  bool ReplaceValues();
+  // Replaces the uses of the results in |fp| with the corresponding constant
+  // values in |values_|.  Returns true if any operands were replaced, and
+  // false otherwise.
+  bool ReplaceValues(Function* fp);
 
   // Marks |instr| as varying by registering a varying value for its result
   // into the |values_| table. Returns SSAPropagator::kVarying.
@@ -88,23 +122,48 @@ class CCPPass : public MemPass {
   // value.
   bool IsVaryingValue(uint32_t id) const;
 
+  // Returns the value of |id| in |values_|, or 0 if it has no value yet.
+  uint32_t GetValue(uint32_t id) const;
+
+  // Sets the value of |id| in |values_| to |value|.
+  void SetValue(uint32_t id, uint32_t value);
+
   // Constant manager for the parent IR context.  Used to record new constants
   // generated during propagation.
   analysis::ConstantManager* const_mgr_;
 
-  // Constant value table.  Each entry <id, const_decl_id> in this map
-  // represents the compile-time constant value for |id| as declared by
-  // |const_decl_id|. Each |const_decl_id| in this table is an OpConstant
-  // declaration for the current module.
+  // Constant value table, indexed by id.  A non-zero entry |const_decl_id|
+  // at index |id| represents the compile-time constant value for |id| as
+  // declared by |const_decl_id|. Each |const_decl_id| in this table is an
+  // OpConstant declaration for the current module.  Ids with no known value
+  // yet map to 0.
   //
   // Additionally, this table keeps track of SSA IDs with varying values. If an
   // SSA ID is found to have a varying value, it will have an entry in this
   // table that maps to the special SSA id kVaryingSSAId.  These values are
   // never replaced in the IR, they are used by CCP during propagation.
-  std::unordered_map<uint32_t, uint32_t> values_;
+  std::vector<uint32_t> values_;
 
-  // Propagator engine used.
+  // Propagator engine used.  It is created once per run of the pass and
+  // reused for every function.
   std::unique_ptr<SSAPropagator> propagator_;
+
+  // True if constants are propagated across function calls.
+  bool interprocedural_;
+
+  // In interprocedural mode, maps each function parameter to the value of the
+  // arguments of all the calls that execute, and each function to the value
+  // of all the returns that execute.  Ids that are not in these tables, or
+  // that map to 0, have no known value yet.  Values are constant ids or
+  // kVaryingSSAId, as in |values_|.
+  std::unordered_map<uint32_t, uint32_t> param_values_;
+  std::unordered_map<uint32_t, uint32_t> return_values_;
+
+  // True once varying arguments and return values are merged into
+  // |param_values_| and |return_values_|.  Until then, a value may be varying
+  // only because it depends on a parameter or call result that is not known
+  // yet in the current round.
+  bool merge_varying_ = false;
 };
 
 }  // namespace opt
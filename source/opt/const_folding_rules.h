@@ -15,10 +15,10 @@
 #ifndef SOURCE_OPT_CONST_FOLDING_RULES_H_
 #define SOURCE_OPT_CONST_FOLDING_RULES_H_
 
-#include <unordered_map>
 #include <vector>
 
 #include "source/opt/constants.h"
+#include "source/opt/folding_rule_table.h"
 
 namespace spvtools {
 namespace opt {
@@ -53,29 +53,6 @@ using ConstantFoldingRule = std::function<const analysis::Constant*(
     const std::vector<const analysis::Constant*>& constants)>;
 
 class ConstantFoldingRules {
- protected:
-  // The |Key| and |Value| structs are used to by-pass a "decorated name length
-  // exceeded, name was truncated" warning on VS2013 and VS2015.
-  struct Key {
-    uint32_t instruction_set;
-    uint32_t opcode;
-  };
-
-  friend bool operator<(const Key& a, const Key& b) {
-    if (a.instruction_set < b.instruction_set) {
-      return true;
-    }
-    if (a.instruction_set > b.instruction_set) {
-      return false;
-    }
-    return a.opcode < b.opcode;
-  }
-
-  struct Value {
-    std::vector<ConstantFoldingRule> value;
-    void push_back(ConstantFoldingRule rule) { value.push_back(rule); }
-  };
-
  public:
   ConstantFoldingRules(IRContext* ctx) : context_(ctx) {}
   virtual ~ConstantFoldingRules() = default;
@@ -88,20 +65,14 @@ class ConstantFoldingRules {
   // Returns true if there is at least 1 folding rule for |inst|.
   const std::vector<ConstantFoldingRule>& GetRulesForInstruction(
       const Instruction* inst) const {
+    const std::vector<ConstantFoldingRule>* rules = nullptr;
     if (inst->opcode() != SpvOpExtInst) {
-      auto it = rules_.find(inst->opcode());
-      if (it != rules_.end()) {
-        return it->second.value;
-      }
+      rules = rules_.Find(inst->opcode());
     } else {
-      uint32_t ext_inst_id = inst->GetSingleWordInOperand(0);
-      uint32_t ext_opcode = inst->GetSingleWordInOperand(1);
-      auto it = ext_rules_.find({ext_inst_id, ext_opcode});
-      if (it != ext_rules_.end()) {
-        return it->second.value;
-      }
+      rules = ext_rules_.Find(inst->GetSingleWordInOperand(0),
+                              inst->GetSingleWordInOperand(1));
     }
-    return empty_vector_;
+    return rules ? *rules : empty_vector_;
   }
 
   // Add the folding rules.
@@ -110,10 +81,10 @@ class ConstantFoldingRules {
  protected:
   // |rules[opcode]| is the set of rules that can be applied to instructions
   // with |opcode| as the opcode.
-  std::unordered_map<uint32_t, Value> rules_;
+  OpcodeRuleTable<std::vector<ConstantFoldingRule>> rules_;
 
   // The folding rules for extended instructions.
-  std::map<Key, Value> ext_rules_;
+  ExtInstRuleTable<std::vector<ConstantFoldingRule>> ext_rules_;
 
  private:
   // The context that the instruction to be folded will be a part of.
@@ -151,6 +151,22 @@ ConstantManager::ConstantManager(IRContext* ctx) : ctx_(ctx) {
   }
 }
 
+void ConstantManager::Clear() {
+  // The maps refer to the constants owned by |owned_constants_|, so empty
+  // them first.
+  id_to_const_val_.clear();
+  const_val_to_id_.clear();
+  const_pool_.clear();
+  owned_constants_.clear();
+}
+
+void ConstantManager::Reanalyze() {
+  Clear();
+  for (const auto& inst : ctx_->module()->GetConstants()) {
+    MapInst(inst);
+  }
+}
+
 Type* ConstantManager::GetType(const Instruction* inst) const {
   return context()->get_type_mgr()->GetType(inst->type_id());
 }
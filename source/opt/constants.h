@@ -505,6 +505,14 @@ class ConstantManager {
 
   IRContext* context() const { return ctx_; }
 
+  // Discards all constants, so that the manager can be reused for another
+  // module.
+  void Clear();
+
+  // Discards all constants and maps the constant declarations of the module
+  // again.  The type manager of the context must be valid or buildable.
+  void Reanalyze();
+
   // Gets or creates a unique Constant instance of type |type| and a vector of
   // constant defining words |words|. If a Constant instance existed already in
   // the constant pool, it returns a pointer to it.  Otherwise, it creates one
@@ -0,0 +1,379 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/dead_store_elim_pass.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "source/opcode.h"
+#include "source/opt/ir_context.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const uint32_t kVariableStorageClassInIdx = 0;
+const uint32_t kAccessChainBaseInIdx = 0;
+const uint32_t kCopyObjectOperandInIdx = 0;
+const uint32_t kLoadPtrInIdx = 0;
+const uint32_t kStorePtrInIdx = 0;
+const uint32_t kStorePtrIdx = 0;
+const uint32_t kStoreMemoryAccessInIdx = 2;
+const uint32_t kFunctionCallFirstArgInIdx = 1;
+const uint32_t kEntryPointFunctionIdInIdx = 1;
+
+// Returns true if |prefix| is a prefix of |path|, or is equal to it.
+bool IsPrefix(const std::vector<uint32_t>& prefix,
+              const std::vector<uint32_t>& path) {
+  return prefix.size() <= path.size() &&
+         std::equal(prefix.begin(), prefix.end(), path.begin());
+}
+
+}  // anonymous namespace
+
+bool DeadStoreElimPass::HasOnlySupportedRefs(uint32_t ptr_id) {
+  if (supported_ref_ptrs_.count(ptr_id)) return true;
+  if (get_def_use_mgr()->WhileEachUse(
+          ptr_id, [this](Instruction* user, uint32_t index) {
+            SpvOp op = user->opcode();
+            if (IsNonPtrAccessChain(op) || op == SpvOpCopyObject) {
+              return HasOnlySupportedRefs(user->result_id());
+            }
+            if (op == SpvOpStore) {
+              // Storing the pointer itself would let it escape.
+              return index == kStorePtrIdx;
+            }
+            return op == SpvOpLoad || op == SpvOpFunctionCall ||
+                   op == SpvOpEntryPoint || op == SpvOpName ||
+                   IsNonTypeDecorate(op);
+          })) {
+    supported_ref_ptrs_.insert(ptr_id);
+    return true;
+  }
+  return false;
+}
+
+bool DeadStoreElimPass::IsTrackedVar(uint32_t var_id) {
+  auto it = tracked_vars_.find(var_id);
+  if (it != tracked_vars_.end()) return it->second;
+
+  Instruction* var = get_def_use_mgr()->GetDef(var_id);
+  bool tracked = false;
+  if (var->opcode() == SpvOpVariable) {
+    uint32_t storage_class =
+        var->GetSingleWordInOperand(kVariableStorageClassInIdx);
+    tracked = (storage_class == SpvStorageClassFunction ||
+               storage_class == SpvStorageClassPrivate) &&
+              HasOnlySupportedRefs(var_id);
+  }
+  tracked_vars_[var_id] = tracked;
+  return tracked;
+}
+
+bool DeadStoreElimPass::GetAccess(uint32_t ptr_id, Access* access) {
+  Instruction* ptr = get_def_use_mgr()->GetDef(ptr_id);
+  std::vector<Instruction*> access_chains;
+  while (true) {
+    if (ptr->opcode() == SpvOpCopyObject) {
+      ptr = get_def_use_mgr()->GetDef(
+          ptr->GetSingleWordInOperand(kCopyObjectOperandInIdx));
+    } else if (IsNonPtrAccessChain(ptr->opcode())) {
+      access_chains.push_back(ptr);
+      ptr = get_def_use_mgr()->GetDef(
+          ptr->GetSingleWordInOperand(kAccessChainBaseInIdx));
+    } else {
+      break;
+    }
+  }
+  if (ptr->opcode() != SpvOpVariable || !IsTrackedVar(ptr->result_id())) {
+    return false;
+  }
+
+  access->var_id = ptr->result_id();
+  access->path.clear();
+  access->exact = true;
+  analysis::ConstantManager* const_mgr = context()->get_constant_mgr();
+  for (auto it = access_chains.rbegin();
+       it != access_chains.rend() && access->exact; ++it) {
+    Instruction* access_chain = *it;
+    for (uint32_t i = kAccessChainBaseInIdx + 1;
+         i < access_chain->NumInOperands(); ++i) {
+      const analysis::Constant* index = const_mgr->FindDeclaredConstant(
+          access_chain->GetSingleWordInOperand(i));
+      const analysis::IntConstant* int_index =
+          index ? index->AsIntConstant() : nullptr;
+      if (int_index == nullptr || int_index->words().size() != 1) {
+        access->exact = false;
+        break;
+      }
+      access->path.push_back(int_index->words()[0]);
+    }
+  }
+  return true;
+}
+
+void DeadStoreElimPass::AddLive(uint32_t var_id, const Path& path,
+                                LocationSet* live) {
+  std::set<Path>& paths = (*live)[var_id];
+  for (auto it = paths.begin(); it != paths.end();) {
+    if (IsPrefix(*it, path)) return;
+    if (IsPrefix(path, *it)) {
+      it = paths.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  paths.insert(path);
+}
+
+void DeadStoreElimPass::RemoveLive(uint32_t var_id, const Path& path,
+                                   LocationSet* live) {
+  auto var_it = live->find(var_id);
+  if (var_it == live->end()) return;
+  std::set<Path>& paths = var_it->second;
+  for (auto it = paths.begin(); it != paths.end();) {
+    if (IsPrefix(path, *it)) {
+      it = paths.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  // Keep the sets canonical so they can be compared.
+  if (paths.empty()) live->erase(var_it);
+}
+
+bool DeadStoreElimPass::IsLive(uint32_t var_id, const Path& path,
+                               const LocationSet& live) {
+  auto var_it = live.find(var_id);
+  if (var_it == live.end()) return false;
+  for (const Path& live_path : var_it->second) {
+    if (IsPrefix(live_path, path) || IsPrefix(path, live_path)) return true;
+  }
+  return false;
+}
+
+void DeadStoreElimPass::Transfer(Instruction* inst, LocationSet* live) {
+  Access access;
+  switch (inst->opcode()) {
+    case SpvOpStore:
+      // A store with a dynamic index may not overwrite anything in
+      // particular.
+      if (GetAccess(inst->GetSingleWordInOperand(kStorePtrInIdx), &access) &&
+          access.exact) {
+        RemoveLive(access.var_id, access.path, live);
+      }
+      break;
+    case SpvOpLoad:
+      if (GetAccess(inst->GetSingleWordInOperand(kLoadPtrInIdx), &access)) {
+        AddLive(access.var_id, access.path, live);
+      }
+      break;
+    case SpvOpFunctionCall:
+      // The callee may read the memory it is given pointers to, and any
+      // Private variable.
+      for (uint32_t i = kFunctionCallFirstArgInIdx; i < inst->NumInOperands();
+           ++i) {
+        if (GetAccess(inst->GetSingleWordInOperand(i), &access)) {
+          AddLive(access.var_id, access.path, live);
+        }
+      }
+      for (uint32_t var_id : private_vars_) {
+        AddLive(var_id, Path(), live);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+DeadStoreElimPass::LocationSet DeadStoreElimPass::LiveOut(
+    BasicBlock* block,
+    const std::unordered_map<uint32_t, LocationSet>& live_in) {
+  LocationSet live;
+  if (spvOpcodeIsReturn(block->terminator()->opcode())) {
+    // The caller may read the Private variables.
+    if (!uncalled_entry_points_.count(func_->result_id())) {
+      for (uint32_t var_id : private_vars_) {
+        AddLive(var_id, Path(), &live);
+      }
+    }
+    return live;
+  }
+
+  block->ForEachSuccessorLabel([this, &live, &live_in](const uint32_t succ) {
+    auto it = live_in.find(succ);
+    if (it == live_in.end()) return;
+    for (const auto& var_and_paths : it->second) {
+      for (const Path& path : var_and_paths.second) {
+        AddLive(var_and_paths.first, path, &live);
+      }
+    }
+  });
+  return live;
+}
+
+bool DeadStoreElimPass::IsVolatileStore(const Instruction* store) const {
+  if (store->NumInOperands() <= kStoreMemoryAccessInIdx) return false;
+  return (store->GetSingleWordInOperand(kStoreMemoryAccessInIdx) &
+          SpvMemoryAccessVolatileMask) != 0;
+}
+
+void DeadStoreElimPass::FindOverwrittenStores(
+    BasicBlock* bb, std::unordered_set<Instruction*>* dead_stores) {
+  AliasAnalysis* alias_analysis = context()->GetAliasAnalysis();
+  analysis::DefUseManager* def_use_mgr = get_def_use_mgr();
+
+  // The stores that nothing may have read since they were executed.  All of
+  // the pointers compared below are used in |bb| with no back edge between
+  // them, so they are computed in the same iteration of every loop.
+  std::vector<Instruction*> unread_stores;
+  for (auto& inst : *bb) {
+    if (inst.opcode() == SpvOpFunctionCall) {
+      // The callee may read the arguments and the Private variables.
+      unread_stores.clear();
+      continue;
+    }
+    // The other uses of tracked variables are only loads and stores.
+    bool is_store = inst.opcode() == SpvOpStore;
+    if (!is_store && inst.opcode() != SpvOpLoad) continue;
+
+    uint32_t ptr_id = inst.GetSingleWordInOperand(is_store ? kStorePtrInIdx
+                                                           : kLoadPtrInIdx);
+    Instruction* ptr = def_use_mgr->GetDef(ptr_id);
+    size_t num_unread = 0;
+    for (Instruction* store : unread_stores) {
+      Instruction* store_ptr =
+          def_use_mgr->GetDef(store->GetSingleWordInOperand(kStorePtrInIdx));
+      AliasAnalysis::Result result =
+          alias_analysis->AliasInSameIteration(store_ptr, ptr);
+      if (is_store && result == AliasAnalysis::kMustAlias) {
+        dead_stores->insert(store);
+      } else if (is_store || result == AliasAnalysis::kNoAlias) {
+        unread_stores[num_unread++] = store;
+      }
+    }
+    unread_stores.resize(num_unread);
+
+    Access access;
+    if (is_store && !IsVolatileStore(&inst) && GetAccess(ptr_id, &access)) {
+      unread_stores.push_back(&inst);
+    }
+  }
+}
+
+bool DeadStoreElimPass::EliminateDeadStores(Function* func) {
+  func_ = func;
+
+  std::vector<BasicBlock*> post_order;
+  cfg()->ForEachBlockInPostOrder(
+      &*func->begin(),
+      [&post_order](BasicBlock* bb) { post_order.push_back(bb); });
+
+  // Compute the locations live at the start of each block.  Visiting the
+  // blocks in post order means most successors are visited first, so few
+  // iterations are needed.  Unreachable blocks are left alone.
+  std::unordered_map<uint32_t, LocationSet> live_in;
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (BasicBlock* bb : post_order) {
+      LocationSet live = LiveOut(bb, live_in);
+      for (auto ii = bb->rbegin(); ii != bb->rend(); ++ii) {
+        Transfer(&*ii, &live);
+      }
+      LocationSet& bb_live_in = live_in[bb->id()];
+      if (bb_live_in != live) {
+        bb_live_in = std::move(live);
+        changed = true;
+      }
+    }
+  }
+
+  // A store is dead if nothing it writes is live after it.
+  std::unordered_set<Instruction*> dead_stores;
+  for (BasicBlock* bb : post_order) {
+    LocationSet live = LiveOut(bb, live_in);
+    for (auto ii = bb->rbegin(); ii != bb->rend(); ++ii) {
+      if (ii->opcode() == SpvOpStore && !IsVolatileStore(&*ii)) {
+        Access access;
+        if (GetAccess(ii->GetSingleWordInOperand(kStorePtrInIdx), &access) &&
+            !IsLive(access.var_id, access.path, live)) {
+          dead_stores.insert(&*ii);
+        }
+      }
+      Transfer(&*ii, &live);
+    }
+    FindOverwrittenStores(bb, &dead_stores);
+  }
+
+  for (Instruction* store : dead_stores) {
+    context()->KillInst(store);
+  }
+  return !dead_stores.empty();
+}
+
+void DeadStoreElimPass::Initialize() {
+  tracked_vars_.clear();
+  supported_ref_ptrs_.clear();
+
+  private_vars_.clear();
+  for (auto& inst : get_module()->types_values()) {
+    if (inst.opcode() == SpvOpVariable &&
+        inst.GetSingleWordInOperand(kVariableStorageClassInIdx) ==
+            SpvStorageClassPrivate &&
+        IsTrackedVar(inst.result_id())) {
+      private_vars_.push_back(inst.result_id());
+    }
+  }
+
+  std::unordered_set<uint32_t> called_functions;
+  for (auto& func : *get_module()) {
+    for (auto& bb : func) {
+      for (auto& inst : bb) {
+        if (inst.opcode() == SpvOpFunctionCall) {
+          called_functions.insert(inst.GetSingleWordInOperand(0));
+        }
+      }
+    }
+  }
+  uncalled_entry_points_.clear();
+  for (auto& entry_point : get_module()->entry_points()) {
+    uint32_t func_id =
+        entry_point.GetSingleWordInOperand(kEntryPointFunctionIdInIdx);
+    if (!called_functions.count(func_id)) {
+      uncalled_entry_points_.insert(func_id);
+    }
+  }
+}
+
+Pass::Status DeadStoreElimPass::ProcessImpl() {
+  // Assumes logical addressing only.
+  if (context()->get_feature_mgr()->HasCapability(SpvCapabilityAddresses))
+    return Status::SuccessWithoutChange;
+
+  ProcessFunction pfn = [this](Function* fp) {
+    return EliminateDeadStores(fp);
+  };
+  bool modified = context()->ProcessEntryPointCallTree(pfn);
+  return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+}
+
+Pass::Status DeadStoreElimPass::Process() {
+  Initialize();
+  return ProcessImpl();
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,132 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_DEAD_STORE_ELIM_PASS_H_
+#define SOURCE_OPT_DEAD_STORE_ELIM_PASS_H_
+
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "source/opt/basic_block.h"
+#include "source/opt/mem_pass.h"
+#include "source/opt/module.h"
+
+namespace spvtools {
+namespace opt {
+
+// See optimizer.hpp for documentation.
+class DeadStoreElimPass : public MemPass {
+ public:
+  const char* name() const override { return "eliminate-dead-stores"; }
+  Status Process() override;
+
+  IRContext::Analysis GetPreservedAnalyses() override {
+    return IRContext::kAnalysisDefUse |
+           IRContext::kAnalysisInstrToBlockMapping |
+           IRContext::kAnalysisConstants | IRContext::kAnalysisTypes;
+  }
+
+ private:
+  // A path of constant indices into a variable.  A path stands for all of the
+  // memory it points to, so the empty path is the whole variable.
+  using Path = std::vector<uint32_t>;
+
+  // A set of memory locations that may be read later.  Maps a variable to
+  // the paths into it.  No path in a set is a prefix of another path in the
+  // same set.
+  using LocationSet = std::map<uint32_t, std::set<Path>>;
+
+  // The memory accessed through a pointer.
+  struct Access {
+    uint32_t var_id = 0;
+    // The constant indices leading to the memory, up to the first index that
+    // is not a constant.
+    Path path;
+    // True if |path| is the memory accessed exactly, that is, every index is
+    // a constant.
+    bool exact = true;
+  };
+
+  // Returns true if |ptr_id| points into a variable that is tracked by this
+  // pass, and describes the memory it points to in |access|.
+  bool GetAccess(uint32_t ptr_id, Access* access);
+
+  // Returns true if |var_id| is a Function or Private variable whose uses are
+  // all supported by this pass.
+  bool IsTrackedVar(uint32_t var_id);
+
+  // Returns true if every use of |ptr_id| and of the pointers derived from it
+  // is supported by this pass.
+  bool HasOnlySupportedRefs(uint32_t ptr_id);
+
+  // Marks the memory at |path| in |var_id| as possibly read in |live|.
+  void AddLive(uint32_t var_id, const Path& path, LocationSet* live);
+
+  // Removes the memory at |path| in |var_id| from |live|.  Live locations
+  // that contain |path| stay live, since only part of them is overwritten.
+  void RemoveLive(uint32_t var_id, const Path& path, LocationSet* live);
+
+  // Returns true if any location in |live| overlaps |path| in |var_id|.
+  bool IsLive(uint32_t var_id, const Path& path, const LocationSet& live);
+
+  // Updates |live| from the locations live after |inst| to the locations
+  // live before it.
+  void Transfer(Instruction* inst, LocationSet* live);
+
+  // Returns the locations live at the end of |block|, given the locations
+  // live at the start of each block in |live_in|.
+  LocationSet LiveOut(BasicBlock* block,
+                      const std::unordered_map<uint32_t, LocationSet>& live_in);
+
+  // Returns true if |store| is a volatile access, which is never removed.
+  bool IsVolatileStore(const Instruction* store) const;
+
+  // Adds to |dead_stores| the stores to tracked variables in |bb| that are
+  // overwritten by a later store in |bb| before anything can read them.
+  // Unlike the liveness analysis, this uses the alias analysis, so it also
+  // finds stores through the same dynamic index.
+  void FindOverwrittenStores(BasicBlock* bb,
+                             std::unordered_set<Instruction*>* dead_stores);
+
+  // Removes the stores in |func| whose values are never read.  Returns true
+  // if |func| was changed.
+  bool EliminateDeadStores(Function* func);
+
+  void Initialize();
+  Pass::Status ProcessImpl();
+
+  // Caches the result of IsTrackedVar.
+  std::unordered_map<uint32_t, bool> tracked_vars_;
+
+  // Pointers whose uses are all supported by this pass.
+  std::unordered_set<uint32_t> supported_ref_ptrs_;
+
+  // The tracked Private variables in the module.
+  std::vector<uint32_t> private_vars_;
+
+  // The function being processed.
+  Function* func_ = nullptr;
+
+  // Entry points that are never called.  Private variables are not live
+  // after they return, since the invocation ends.
+  std::unordered_set<uint32_t> uncalled_entry_points_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_DEAD_STORE_ELIM_PASS_H_
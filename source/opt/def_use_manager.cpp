@@ -14,6 +14,7 @@
 
 #include "source/opt/def_use_manager.h"
 
+#include <algorithm>
 #include <iostream>
 
 #include "source/opt/log.h"
@@ -66,6 +67,10 @@ void DefUseManager::AnalyzeInstUse(Instruction* inst) {
         break;
     }
   }
+
+  if (tracking_changes_) {
+    changed_insts_.insert(inst);
+  }
 }
 
 void DefUseManager::AnalyzeInstDefUse(Instruction* inst) {
@@ -229,7 +234,29 @@ void DefUseManager::AnalyzeDefUse(Module* module) {
       std::bind(&DefUseManager::AnalyzeInstUse, this, std::placeholders::_1));
 }
 
+void DefUseManager::Clear() {
+  id_to_def_.clear();
+  id_to_users_.clear();
+  inst_to_used_ids_.clear();
+  tracking_changes_ = false;
+  changed_insts_.clear();
+}
+
+bool DefUseManager::TakeChangedInstructions(std::vector<Instruction*>* insts) {
+  insts->assign(changed_insts_.begin(), changed_insts_.end());
+  std::sort(insts->begin(), insts->end(),
+            [](const Instruction* a, const Instruction* b) {
+              return a->unique_id() < b->unique_id();
+            });
+  changed_insts_.clear();
+
+  bool known = tracking_changes_;
+  tracking_changes_ = true;
+  return known;
+}
+
 void DefUseManager::ClearInst(Instruction* inst) {
+  changed_insts_.erase(inst);
   auto iter = inst_to_used_ids_.find(inst);
   if (iter != inst_to_used_ids_.end()) {
     EraseUseRecordsOfOperandIds(inst);
@@ -18,6 +18,7 @@
 #include <list>
 #include <set>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -110,6 +111,16 @@ class DefUseManager {
   DefUseManager& operator=(const DefUseManager&) = delete;
   DefUseManager& operator=(DefUseManager&&) = delete;
 
+  // Discards all def-use records, so that the manager can be reused for
+  // another module.
+  void Clear();
+
+  // Discards all def-use records and analyzes |module| again.
+  void Reanalyze(Module* module) {
+    Clear();
+    AnalyzeDefUse(module);
+  }
+
   // Analyzes the defs in the given |inst|.
   void AnalyzeInstDef(Instruction* inst);
 
@@ -219,6 +230,13 @@ class DefUseManager {
   // uses.
   void UpdateDefUse(Instruction* inst);
 
+  // Returns in |insts| the instructions whose uses were analyzed since the
+  // previous call, which are the instructions added or changed since then,
+  // ordered by unique id.  Returns false, with an empty |insts|, if they are
+  // not known because there was no previous call or the manager was cleared
+  // since then.  The instructions are recorded from the first call on.
+  bool TakeChangedInstructions(std::vector<Instruction*>* insts);
+
  private:
   using InstToUsedIdsMap =
       std::unordered_map<const Instruction*, std::vector<uint32_t>>;
@@ -247,6 +265,11 @@ class DefUseManager {
   IdToUsersMap id_to_users_;  // Mapping from ids to their users
   // Mapping from instructions to the ids used in the instruction.
   InstToUsedIdsMap inst_to_used_ids_;
+
+  // True if the instructions whose uses are analyzed are recorded in
+  // |changed_insts_|.
+  bool tracking_changes_ = false;
+  std::unordered_set<Instruction*> changed_insts_;
 };
 
 }  // namespace analysis
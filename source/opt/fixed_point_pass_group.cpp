@@ -0,0 +1,67 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/fixed_point_pass_group.h"
+
+namespace spvtools {
+namespace opt {
+
+const uint32_t FixedPointPassGroup::kDefaultMaxIterations;
+
+Pass::Status FixedPointPassGroup::Process() {
+  // |generation| counts the changes made to the module by the passes in the
+  // group.  |clean_at[i]| is the generation at which the i'th pass last ran
+  // without making a change, or |kNotClean| if there is no such run that is
+  // still current.
+  const uint32_t kNotClean = 0;
+  uint32_t generation = 1;
+  std::vector<uint32_t> clean_at(factories_.size(), kNotClean);
+
+  Status status = Status::SuccessWithoutChange;
+  iterations_ = 0;
+  runs_ = 0;
+  skipped_runs_ = 0;
+
+  bool changed = true;
+  while (changed && iterations_ < max_iterations_) {
+    changed = false;
+    ++iterations_;
+    for (size_t i = 0; i < factories_.size(); ++i) {
+      if (clean_at[i] == generation) {
+        ++skipped_runs_;
+        continue;
+      }
+
+      std::unique_ptr<Pass> pass = factories_[i]();
+      pass->SetMessageConsumer(consumer());
+      ++runs_;
+      Status pass_status = pass->Run(context());
+      if (pass_status == Status::Failure) {
+        return Status::Failure;
+      }
+      if (pass_status == Status::SuccessWithChange) {
+        ++generation;
+        changed = true;
+        status = Status::SuccessWithChange;
+        clean_at[i] = kNotClean;
+      } else {
+        clean_at[i] = generation;
+      }
+    }
+  }
+  return status;
+}
+
+}  // namespace opt
+}  // namespace spvtools
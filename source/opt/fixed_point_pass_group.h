@@ -0,0 +1,85 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_FIXED_POINT_PASS_GROUP_H_
+#define SOURCE_OPT_FIXED_POINT_PASS_GROUP_H_
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "source/opt/pass.h"
+
+namespace spvtools {
+namespace opt {
+
+// A group of cleanup passes that is run repeatedly until the module stops
+// changing.
+//
+// Each iteration runs the passes of the group in the order they were given.
+// The group stops iterating once a complete iteration leaves the module
+// unchanged, or after |max_iterations| iterations.  A pass is skipped when
+// the last time it ran it reported no change, and no pass has changed the
+// module since then.  Passes are deterministic functions of the module, so
+// running it again could not find anything new.
+//
+// A pass instance can only be run once, so the group holds a factory for each
+// of its passes and creates a fresh instance every time the pass has to run.
+class FixedPointPassGroup : public Pass {
+ public:
+  using PassFactory = std::function<std::unique_ptr<Pass>()>;
+
+  // The default bound on the number of iterations of a group.
+  static const uint32_t kDefaultMaxIterations = 4;
+
+  explicit FixedPointPassGroup(std::vector<PassFactory> factories,
+                               uint32_t max_iterations = kDefaultMaxIterations)
+      : factories_(std::move(factories)),
+        max_iterations_(max_iterations),
+        iterations_(0),
+        runs_(0),
+        skipped_runs_(0) {}
+
+  const char* name() const override { return "fixed-point-group"; }
+
+  Status Process() override;
+
+  // Returns the number of iterations the group made in its last run.
+  uint32_t iterations() const { return iterations_; }
+
+  // Returns the number of times a pass of the group was run.
+  uint32_t runs() const { return runs_; }
+
+  // Returns the number of times a pass of the group was skipped because
+  // nothing changed since it last ran without making a change.
+  uint32_t skipped_runs() const { return skipped_runs_; }
+
+ private:
+  // The factories for the passes in the group, in the order they are run.
+  std::vector<PassFactory> factories_;
+
+  // The maximum number of times the group is iterated.
+  uint32_t max_iterations_;
+
+  // Statistics on the last run of the group.
+  uint32_t iterations_;
+  uint32_t runs_;
+  uint32_t skipped_runs_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_FIXED_POINT_PASS_GROUP_H_
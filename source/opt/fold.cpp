@@ -238,12 +238,17 @@ bool InstructionFolder::FoldInstructionInternal(Instruction* inst) const {
     return true;
   }
 
+  const FoldingRules::FoldingRuleSet& rules =
+      GetFoldingRules().GetRulesForInstruction(inst);
+  if (rules.empty()) {
+    return false;
+  }
+
   analysis::ConstantManager* const_manager = context_->get_constant_mgr();
   std::vector<const analysis::Constant*> constants =
       const_manager->GetOperandConstants(inst);
 
-  for (const FoldingRule& rule :
-       GetFoldingRules().GetRulesForInstruction(inst)) {
+  for (const FoldingRule& rule : rules) {
     if (rule(context_, inst, constants)) {
       return true;
     }
@@ -624,7 +629,7 @@ bool InstructionFolder::IsFoldableConstant(
 }
 
 Instruction* InstructionFolder::FoldInstructionToConstant(
-    Instruction* inst, std::function<uint32_t(uint32_t)> id_map) const {
+    Instruction* inst, const std::function<uint32_t(uint32_t)>& id_map) const {
   analysis::ConstantManager* const_mgr = context_->get_constant_mgr();
 
   if (!inst->IsFoldableByFoldScalar() &&
@@ -647,7 +652,8 @@ Instruction* InstructionFolder::FoldInstructionToConstant(
   });
 
   const analysis::Constant* folded_const = nullptr;
-  for (auto rule : GetConstantFoldingRules().GetRulesForInstruction(inst)) {
+  for (const ConstantFoldingRule& rule :
+       GetConstantFoldingRules().GetRulesForInstruction(inst)) {
     folded_const = rule(context_, inst, constants);
     if (folded_const != nullptr) {
       Instruction* const_inst =
@@ -96,7 +96,7 @@ class InstructionFolder {
   // constant, but the instruction itself has not been updated yet.  This can
   // map those ids to the appropriate constants.
   Instruction* FoldInstructionToConstant(
-      Instruction* inst, std::function<uint32_t(uint32_t)> id_map) const;
+      Instruction* inst, const std::function<uint32_t(uint32_t)>& id_map) const;
   // Returns true if |inst| can be folded into a simpler instruction.
   // If |inst| can be simplified, |inst| is overwritten with the simplified
   // instruction reusing the same result id.
@@ -0,0 +1,106 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_FOLDING_RULE_TABLE_H_
+#define SOURCE_OPT_FOLDING_RULE_TABLE_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace spvtools {
+namespace opt {
+
+// A table of rule sets indexed by opcode, used to find the folding rules of an
+// instruction without hashing.  The table maps each opcode to a slot in a
+// dense array of rule sets.  Since the core opcodes are small numbers, the
+// index is small, except for the tables with rules for the vendor opcodes.
+template <typename RuleSet>
+class OpcodeRuleTable {
+ public:
+  // Returns the rule set for |opcode|, adding an empty one if there is none.
+  // The reference is invalidated by the next call.
+  RuleSet& operator[](uint32_t opcode) {
+    if (opcode >= slots_.size()) {
+      slots_.resize(opcode + 1, kNoSlot);
+    }
+    if (slots_[opcode] == kNoSlot) {
+      slots_[opcode] = static_cast<uint32_t>(rule_sets_.size());
+      rule_sets_.emplace_back();
+    }
+    return rule_sets_[slots_[opcode]];
+  }
+
+  // Returns the rule set for |opcode|, or nullptr if there is none.
+  const RuleSet* Find(uint32_t opcode) const {
+    if (opcode >= slots_.size() || slots_[opcode] == kNoSlot) {
+      return nullptr;
+    }
+    return &rule_sets_[slots_[opcode]];
+  }
+
+ private:
+  static constexpr uint32_t kNoSlot = UINT32_MAX;
+
+  // |slots_[opcode]| is the index in |rule_sets_| of the rules for |opcode|.
+  std::vector<uint32_t> slots_;
+  std::vector<RuleSet> rule_sets_;
+};
+
+template <typename RuleSet>
+constexpr uint32_t OpcodeRuleTable<RuleSet>::kNoSlot;
+
+// A table of rule sets for extended instructions, indexed by the id of the
+// instruction set import and the extended opcode.  A module imports few
+// instruction sets, so each one has its own opcode table, found by a linear
+// search.
+template <typename RuleSet>
+class ExtInstRuleTable {
+ public:
+  struct Key {
+    uint32_t instruction_set;
+    uint32_t opcode;
+  };
+
+  // Returns the rule set for |key|, adding an empty one if there is none.  The
+  // reference is invalidated by the next call.
+  RuleSet& operator[](const Key& key) {
+    for (auto& table : tables_) {
+      if (table.first == key.instruction_set) {
+        return table.second[key.opcode];
+      }
+    }
+    tables_.emplace_back(key.instruction_set, OpcodeRuleTable<RuleSet>());
+    return tables_.back().second[key.opcode];
+  }
+
+  // Returns the rule set for |opcode| in the instruction set imported by
+  // |instruction_set|, or nullptr if there is none.
+  const RuleSet* Find(uint32_t instruction_set, uint32_t opcode) const {
+    for (const auto& table : tables_) {
+      if (table.first == instruction_set) {
+        return table.second.Find(opcode);
+      }
+    }
+    return nullptr;
+  }
+
+ private:
+  std::vector<std::pair<uint32_t, OpcodeRuleTable<RuleSet>>> tables_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_FOLDING_RULE_TABLE_H_
@@ -16,10 +16,10 @@
 #define SOURCE_OPT_FOLDING_RULES_H_
 
 #include <cstdint>
-#include <unordered_map>
 #include <vector>
 
 #include "source/opt/constants.h"
+#include "source/opt/folding_rule_table.h"
 
 namespace spvtools {
 namespace opt {
@@ -64,20 +64,14 @@ class FoldingRules {
   virtual ~FoldingRules() = default;
 
   const FoldingRuleSet& GetRulesForInstruction(Instruction* inst) const {
+    const FoldingRuleSet* rules = nullptr;
     if (inst->opcode() != SpvOpExtInst) {
-      auto it = rules_.find(inst->opcode());
-      if (it != rules_.end()) {
-        return it->second;
-      }
+      rules = rules_.Find(inst->opcode());
     } else {
-      uint32_t ext_inst_id = inst->GetSingleWordInOperand(0);
-      uint32_t ext_opcode = inst->GetSingleWordInOperand(1);
-      auto it = ext_rules_.find({ext_inst_id, ext_opcode});
-      if (it != ext_rules_.end()) {
-        return it->second;
-      }
+      rules = ext_rules_.Find(inst->GetSingleWordInOperand(0),
+                              inst->GetSingleWordInOperand(1));
     }
-    return empty_vector_;
+    return rules ? *rules : empty_vector_;
   }
 
   IRContext* context() { return context_; }
@@ -87,25 +81,10 @@ class FoldingRules {
 
  protected:
   // The folding rules for core instructions.
-  std::unordered_map<uint32_t, FoldingRuleSet> rules_;
+  OpcodeRuleTable<FoldingRuleSet> rules_;
 
   // The folding rules for extended instructions.
-  struct Key {
-    uint32_t instruction_set;
-    uint32_t opcode;
-  };
-
-  friend bool operator<(const Key& a, const Key& b) {
-    if (a.instruction_set < b.instruction_set) {
-      return true;
-    }
-    if (a.instruction_set > b.instruction_set) {
-      return false;
-    }
-    return a.opcode < b.opcode;
-  }
-
-  std::map<Key, FoldingRuleSet> ext_rules_;
+  ExtInstRuleTable<FoldingRuleSet> ext_rules_;
 
  private:
   IRContext* context_;
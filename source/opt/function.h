@@ -56,6 +56,9 @@ class Function {
 
   // Appends a parameter to this function.
   inline void AddParameter(std::unique_ptr<Instruction> p);
+  // Removes the parameter whose result id is |id| from this function, and
+  // deletes it.  The type of the function must be updated by the caller.
+  inline void RemoveParameter(uint32_t id);
   // Appends a debug instruction in function header to this function.
   inline void AddDebugInstructionInHeader(std::unique_ptr<Instruction> p);
   // Appends a basic block to this function.
@@ -181,6 +184,14 @@ inline void Function::AddParameter(std::unique_ptr<Instruction> p) {
   params_.emplace_back(std::move(p));
 }
 
+inline void Function::RemoveParameter(uint32_t id) {
+  params_.erase(std::remove_if(params_.begin(), params_.end(),
+                               [id](const std::unique_ptr<Instruction>& p) {
+                                 return p->result_id() == id;
+                               }),
+                params_.end());
+}
+
 inline void Function::AddDebugInstructionInHeader(
     std::unique_ptr<Instruction> p) {
   debug_insts_in_header_.push_back(std::move(p));
@@ -0,0 +1,411 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/function_specialization_pass.h"
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "source/opt/eliminate_dead_functions_util.h"
+#include "source/opt/reflect.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const uint32_t kCallFunctionInIdx = 0;
+const uint32_t kCallFirstArgInIdx = 1;
+const uint32_t kEntryPointFunctionIdInIdx = 1;
+const uint32_t kFunctionTypeInIdx = 1;
+
+// Returns true if |id| has no uses other than names and decorations.
+bool IsUnused(IRContext* context, uint32_t id) {
+  return context->get_def_use_mgr()->WhileEachUser(
+      id, [](Instruction* user) {
+        return user->opcode() == SpvOpName ||
+               IsAnnotationInst(user->opcode());
+      });
+}
+
+// Returns the ids of the parameters of |func|.
+std::vector<uint32_t> GetParamIds(Function* func) {
+  std::vector<uint32_t> param_ids;
+  func->ForEachParam([&param_ids](Instruction* param) {
+    param_ids.push_back(param->result_id());
+  });
+  return param_ids;
+}
+
+}  // namespace
+
+Pass::Status FunctionSpecializationPass::Process() {
+  Status status = SpecializeFunctions();
+  if (status == Status::Failure) {
+    return status;
+  }
+  if (EliminateUncalledFunctions()) {
+    status = Status::SuccessWithChange;
+  }
+
+  Status dead_arguments_status = EliminateDeadArguments();
+  if (dead_arguments_status != Status::SuccessWithoutChange) {
+    status = dead_arguments_status;
+  }
+  return status;
+}
+
+bool FunctionSpecializationPass::IsSpecializableConstant(uint32_t id) const {
+  switch (get_def_use_mgr()->GetDef(id)->opcode()) {
+    case SpvOpConstantTrue:
+    case SpvOpConstantFalse:
+    case SpvOpConstant:
+    case SpvOpConstantComposite:
+    case SpvOpConstantNull:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool FunctionSpecializationPass::IsExported(Function* func) {
+  bool is_exported = false;
+  get_decoration_mgr()->ForEachDecoration(
+      func->result_id(), SpvDecorationLinkageAttributes,
+      [&is_exported](const Instruction& linkage_instruction) {
+        uint32_t last_operand = linkage_instruction.NumOperands() - 1;
+        if (linkage_instruction.GetSingleWordOperand(last_operand) ==
+            SpvLinkageTypeExport) {
+          is_exported = true;
+        }
+      });
+  return is_exported;
+}
+
+Pass::Status FunctionSpecializationPass::SpecializeFunctions() {
+  // Group the calls by their callee and the constants passed to it.  A 0
+  // stands for an argument that is not a constant, or for a parameter that
+  // cannot be specialized because debug information refers to it.
+  using CallPattern = std::pair<uint32_t, std::vector<uint32_t>>;
+  std::map<CallPattern, std::vector<Instruction*>> calls_by_pattern;
+  std::unordered_map<uint32_t, uint32_t> call_counts;
+  for (auto& func : *get_module()) {
+    for (auto& block : func) {
+      for (auto& inst : block) {
+        if (inst.opcode() != SpvOpFunctionCall) continue;
+        uint32_t callee_id = inst.GetSingleWordInOperand(kCallFunctionInIdx);
+        ++call_counts[callee_id];
+
+        std::vector<uint32_t> param_ids =
+            GetParamIds(context()->GetFunction(callee_id));
+        std::vector<uint32_t> args;
+        bool has_constant_arg = false;
+        for (uint32_t i = 0; i < param_ids.size(); ++i) {
+          uint32_t arg_id = inst.GetSingleWordInOperand(kCallFirstArgInIdx + i);
+          bool has_debug_uses = !get_def_use_mgr()->WhileEachUser(
+              param_ids[i], [](Instruction* user) {
+                return user->GetOpenCL100DebugOpcode() ==
+                       OpenCLDebugInfo100InstructionsMax;
+              });
+          if (IsSpecializableConstant(arg_id) && !has_debug_uses) {
+            args.push_back(arg_id);
+            has_constant_arg = true;
+          } else {
+            args.push_back(0);
+          }
+        }
+        if (has_constant_arg) {
+          calls_by_pattern[{callee_id, args}].push_back(&inst);
+        }
+      }
+    }
+  }
+
+  // The patterns with the most calls are specialized first.
+  std::vector<const std::pair<const CallPattern, std::vector<Instruction*>>*>
+      patterns;
+  for (const auto& entry : calls_by_pattern) {
+    patterns.push_back(&entry);
+  }
+  std::stable_sort(patterns.begin(), patterns.end(),
+                   [](const std::pair<const CallPattern,
+                                      std::vector<Instruction*>>* a,
+                      const std::pair<const CallPattern,
+                                      std::vector<Instruction*>>* b) {
+                     return a->second.size() > b->second.size();
+                   });
+
+  std::unordered_set<uint32_t> entry_points;
+  for (auto& entry_point : get_module()->entry_points()) {
+    entry_points.insert(
+        entry_point.GetSingleWordInOperand(kEntryPointFunctionIdInIdx));
+  }
+
+  Status status = Status::SuccessWithoutChange;
+  uint32_t growth = 0;
+  for (const auto* pattern : patterns) {
+    Function* callee = context()->GetFunction(pattern->first.first);
+    const std::vector<uint32_t>& args = pattern->first.second;
+    const std::vector<Instruction*>& calls = pattern->second;
+    if (callee->begin() == callee->end()) continue;
+
+    // The callee is removed once all of its calls are changed, unless it is
+    // an entry point or exported, so only the other clones make the module
+    // grow.  The calls made by the clones count as calls of their callees.
+    uint32_t& remaining_calls = call_counts[callee->result_id()];
+    uint32_t size = 0;
+    if (remaining_calls != calls.size() ||
+        entry_points.count(callee->result_id()) != 0 || IsExported(callee)) {
+      callee->ForEachInst([&size](Instruction*) { ++size; });
+      if (growth + size > max_growth_) continue;
+    }
+
+    Function* clone = CreateSpecialization(callee, args);
+    if (clone == nullptr) {
+      return Status::Failure;
+    }
+    clones_.insert(clone);
+    growth += size;
+    remaining_calls -= static_cast<uint32_t>(calls.size());
+    for (auto& block : *clone) {
+      for (auto& inst : block) {
+        if (inst.opcode() == SpvOpFunctionCall) {
+          ++call_counts[inst.GetSingleWordInOperand(kCallFunctionInIdx)];
+        }
+      }
+    }
+
+    for (Instruction* call : calls) {
+      Instruction::OperandList operands = {
+          {SPV_OPERAND_TYPE_ID, {clone->result_id()}}};
+      for (uint32_t i = 0; i < args.size(); ++i) {
+        if (args[i] == 0) {
+          operands.push_back(call->GetInOperand(kCallFirstArgInIdx + i));
+        }
+      }
+      call->SetInOperands(std::move(operands));
+    }
+    specialized_functions_.insert(callee);
+    status = Status::SuccessWithChange;
+  }
+
+  if (status == Status::SuccessWithChange) {
+    // The calls and the new functions are not in the analyses.
+    context()->InvalidateAnalysesExceptFor(IRContext::kAnalysisNone);
+  }
+  return status;
+}
+
+Function* FunctionSpecializationPass::CreateSpecialization(
+    Function* callee, const std::vector<uint32_t>& args) {
+  std::unique_ptr<Function> clone(callee->Clone(context()));
+
+  // Each parameter that is specialized is replaced by its constant, and every
+  // other id defined in the clone is given a new id.
+  std::unordered_map<uint32_t, uint32_t> new_ids;
+  std::vector<uint32_t> param_ids = GetParamIds(clone.get());
+  for (uint32_t i = 0; i < param_ids.size(); ++i) {
+    if (args[i] != 0) {
+      new_ids[param_ids[i]] = args[i];
+      clone->RemoveParameter(param_ids[i]);
+    }
+  }
+
+  // The linkage attributes of the callee are not copied, since the clone
+  // cannot be called from outside the module.
+  Instruction* def_inst = &clone->DefInst();
+  bool ids_available = clone->WhileEachInst(
+      [this, def_inst, &new_ids](Instruction* inst) {
+        if (!inst->HasResultId()) return true;
+        uint32_t new_id = TakeNextId();
+        if (new_id == 0) return false;
+        new_ids[inst->result_id()] = new_id;
+        if (inst != def_inst) {
+          get_decoration_mgr()->CloneDecorations(inst->result_id(), new_id);
+        }
+        return true;
+      },
+      true);
+  if (!ids_available) {
+    return nullptr;
+  }
+
+  clone->ForEachInst(
+      [&new_ids](Instruction* inst) {
+        inst->ForEachId([&new_ids](uint32_t* id) {
+          auto it = new_ids.find(*id);
+          if (it != new_ids.end()) *id = it->second;
+        });
+      },
+      true);
+
+  uint32_t type_id = GetFunctionTypeId(clone->type_id(), clone.get());
+  if (type_id == 0) {
+    return nullptr;
+  }
+  clone->DefInst().SetInOperand(kFunctionTypeInIdx, {type_id});
+
+  Function* result = clone.get();
+  context()->AddFunction(std::move(clone));
+  return result;
+}
+
+uint32_t FunctionSpecializationPass::GetFunctionTypeId(uint32_t return_type_id,
+                                                       Function* func) {
+  analysis::TypeManager* type_mgr = context()->get_type_mgr();
+  std::vector<const analysis::Type*> param_types;
+  func->ForEachParam([type_mgr, &param_types](Instruction* param) {
+    param_types.push_back(type_mgr->GetType(param->type_id()));
+  });
+  analysis::Function func_type(type_mgr->GetType(return_type_id),
+                               param_types);
+  return type_mgr->GetTypeInstruction(&func_type);
+}
+
+bool FunctionSpecializationPass::EliminateUncalledFunctions() {
+  std::unordered_set<const Function*> live_functions;
+  ProcessFunction mark_live = [&live_functions](Function* fp) {
+    live_functions.insert(fp);
+    return false;
+  };
+  context()->ProcessReachableCallTree(mark_live);
+
+  bool modified = false;
+  for (auto func_iter = get_module()->begin();
+       func_iter != get_module()->end();) {
+    // A clone made for a call in a function that is removed is not called
+    // anymore either.  Reachability covers such chains in one sweep.
+    if ((specialized_functions_.count(&*func_iter) != 0 ||
+         clones_.count(&*func_iter) != 0) &&
+        live_functions.count(&*func_iter) == 0) {
+      modified = true;
+      func_iter =
+          eliminatedeadfunctionsutil::EliminateFunction(context(), &func_iter);
+    } else {
+      ++func_iter;
+    }
+  }
+  specialized_functions_.clear();
+  clones_.clear();
+  return modified;
+}
+
+Pass::Status FunctionSpecializationPass::EliminateDeadArguments() {
+  std::vector<Function*> functions;
+  for (auto& func : *get_module()) {
+    functions.push_back(&func);
+  }
+
+  Status status = Status::SuccessWithoutChange;
+  for (Function* func : functions) {
+    if (func->begin() == func->end() || IsExported(func)) continue;
+
+    // The function must only be used by calls, which excludes entry points
+    // and functions described by debug information.
+    std::vector<Instruction*> calls;
+    bool only_called = get_def_use_mgr()->WhileEachUse(
+        func->result_id(), [&calls](Instruction* user, uint32_t index) {
+          if (user->opcode() == SpvOpFunctionCall &&
+              index == user->NumOperands() - user->NumInOperands() +
+                           kCallFunctionInIdx) {
+            calls.push_back(user);
+            return true;
+          }
+          return user->opcode() == SpvOpName ||
+                 IsAnnotationInst(user->opcode());
+        });
+    if (!only_called) continue;
+
+    std::vector<uint32_t> dead_params;
+    std::vector<uint32_t> param_ids = GetParamIds(func);
+    for (uint32_t i = 0; i < param_ids.size(); ++i) {
+      if (IsUnused(context(), param_ids[i])) {
+        dead_params.push_back(i);
+      }
+    }
+
+    bool dead_return =
+        get_def_use_mgr()->GetDef(func->type_id())->opcode() !=
+            SpvOpTypeVoid &&
+        std::all_of(calls.begin(), calls.end(), [this](Instruction* call) {
+          return IsUnused(context(), call->result_id());
+        });
+
+    if (dead_params.empty() && !dead_return) continue;
+    if (!RemoveArguments(func, calls, dead_params, dead_return)) {
+      return Status::Failure;
+    }
+    status = Status::SuccessWithChange;
+  }
+  return status;
+}
+
+bool FunctionSpecializationPass::RemoveArguments(
+    Function* func, const std::vector<Instruction*>& calls,
+    const std::vector<uint32_t>& dead_params, bool dead_return) {
+  uint32_t void_type_id = 0;
+  if (dead_return) {
+    analysis::Void void_type;
+    void_type_id = context()->get_type_mgr()->GetTypeInstruction(&void_type);
+    if (void_type_id == 0) return false;
+  }
+
+  for (Instruction* call : calls) {
+    Instruction::OperandList operands;
+    for (uint32_t i = 0; i < call->NumInOperands(); ++i) {
+      if (i < kCallFirstArgInIdx ||
+          !std::binary_search(dead_params.begin(), dead_params.end(),
+                              i - kCallFirstArgInIdx)) {
+        operands.push_back(call->GetInOperand(i));
+      }
+    }
+    call->SetInOperands(std::move(operands));
+    if (dead_return) {
+      context()->KillNamesAndDecorates(call->result_id());
+      call->SetResultType(void_type_id);
+    }
+    get_def_use_mgr()->AnalyzeInstUse(call);
+  }
+
+  std::vector<uint32_t> param_ids = GetParamIds(func);
+  for (uint32_t index : dead_params) {
+    context()->KillNamesAndDecorates(param_ids[index]);
+    get_def_use_mgr()->ClearInst(
+        get_def_use_mgr()->GetDef(param_ids[index]));
+    func->RemoveParameter(param_ids[index]);
+  }
+
+  if (dead_return) {
+    func->DefInst().SetResultType(void_type_id);
+    for (auto& block : *func) {
+      Instruction* terminator = block.terminator();
+      if (terminator->opcode() == SpvOpReturnValue) {
+        terminator->SetOpcode(SpvOpReturn);
+        terminator->SetInOperands({});
+        get_def_use_mgr()->AnalyzeInstUse(terminator);
+      }
+    }
+  }
+
+  uint32_t type_id = GetFunctionTypeId(func->type_id(), func);
+  if (type_id == 0) return false;
+  func->DefInst().SetInOperand(kFunctionTypeInIdx, {type_id});
+  get_def_use_mgr()->AnalyzeInstUse(&func->DefInst());
+  return true;
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,105 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_FUNCTION_SPECIALIZATION_PASS_H_
+#define SOURCE_OPT_FUNCTION_SPECIALIZATION_PASS_H_
+
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+#include "source/opt/function.h"
+#include "source/opt/ir_context.h"
+#include "source/opt/pass.h"
+
+namespace spvtools {
+namespace opt {
+
+// This pass specializes functions for the constant arguments they are called
+// with, and removes the parameters and return values that are not used.
+//
+// The calls that pass constants for the same parameters are grouped by those
+// constants.  For each group, starting with the largest, the callee is cloned
+// with the parameters that are constant replaced by the constants, and the
+// calls are changed to call the clone.  A function that is no longer called
+// is removed, so specializing a function for all of its calls does not grow
+// the module.  The instructions added by the other clones are limited by a
+// budget.
+//
+// Then the parameters that are not used by a function, and the return value
+// if no call uses it, are removed from the function and its calls.  This is
+// not done for entry points and exported functions.
+class FunctionSpecializationPass : public Pass {
+ public:
+  explicit FunctionSpecializationPass(uint32_t max_growth)
+      : max_growth_(max_growth) {}
+
+  const char* name() const override { return "specialize-functions"; }
+  Status Process() override;
+
+ private:
+  // Clones functions for the constant arguments of their calls.  Adds the
+  // functions whose calls were changed to |specialized_functions_|, and the
+  // clones to |clones_|.
+  Status SpecializeFunctions();
+
+  // Returns a clone of |callee| in which each parameter whose entry in
+  // |args| is not 0 is replaced by that entry.  The clone is added to the
+  // module.  Returns nullptr if the ids ran out.
+  Function* CreateSpecialization(Function* callee,
+                                 const std::vector<uint32_t>& args);
+
+  // Removes the functions in |specialized_functions_| and |clones_| that are
+  // not reachable from an entry point or an exported function anymore.
+  // Returns true if any was removed.
+  bool EliminateUncalledFunctions();
+
+  // Removes the unused parameters and return values of the functions in the
+  // module.  Returns Failure if a type could not be created.
+  Status EliminateDeadArguments();
+
+  // Removes the parameters at the positions in |dead_params| from |func| and
+  // its |calls|, and its return value if |dead_return| is true.  Returns
+  // false if the new type of |func| could not be created.
+  bool RemoveArguments(Function* func, const std::vector<Instruction*>& calls,
+                       const std::vector<uint32_t>& dead_params,
+                       bool dead_return);
+
+  // Returns the id of the type of a function returning |return_type_id| with
+  // parameters of the types of the parameters of |func|, or 0 if it could
+  // not be created.
+  uint32_t GetFunctionTypeId(uint32_t return_type_id, Function* func);
+
+  // Returns true if |id| is a constant that can be substituted for a
+  // parameter.
+  bool IsSpecializableConstant(uint32_t id) const;
+
+  // Returns true if |func| can be called from outside the module.
+  bool IsExported(Function* func);
+
+  // The number of instructions that specializing functions can add to the
+  // module.
+  uint32_t max_growth_;
+
+  // The functions whose calls were changed to call a clone.
+  std::unordered_set<Function*> specialized_functions_;
+
+  // The functions created by this pass.
+  std::unordered_set<Function*> clones_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_FUNCTION_SPECIALIZATION_PASS_H_
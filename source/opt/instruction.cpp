@@ -155,6 +155,9 @@ Instruction* Instruction::Clone(IRContext* c) const {
   clone->unique_id_ = c->TakeNextUniqueId();
   clone->operands_ = operands_;
   clone->dbg_line_insts_ = dbg_line_insts_;
+  for (auto& line : clone->dbg_line_insts_) {
+    line.context_ = c;
+  }
   clone->dbg_scope_ = dbg_scope_;
   clone->is_cl100_dbg_inst_ = is_cl100_dbg_inst_;
   return clone;
@@ -0,0 +1,221 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/instruction_scheduling_pass.h"
+
+#include <algorithm>
+#include <cassert>
+#include <set>
+#include <unordered_map>
+
+#include "source/opt/reflect.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const uint32_t kLoadMemoryAccessInIdx = 1;
+
+// How an instruction is ordered with respect to the memory accesses and side
+// effects around it.
+enum class MemoryKind {
+  // It can move freely.
+  kNone,
+  // It reads memory, so it can move past other reads only.
+  kRead,
+  // It keeps its order with all the other instructions that are not kNone.
+  kOrdered
+};
+
+MemoryKind GetMemoryKind(const Instruction* inst) {
+  if (inst->opcode() == SpvOpLoad) {
+    if (inst->NumInOperands() > kLoadMemoryAccessInIdx &&
+        (inst->GetSingleWordInOperand(kLoadMemoryAccessInIdx) &
+         SpvMemoryAccessVolatileMask) != 0) {
+      return MemoryKind::kOrdered;
+    }
+    return MemoryKind::kRead;
+  }
+  return inst->IsOpcodeCodeMotionSafe() ? MemoryKind::kNone
+                                        : MemoryKind::kOrdered;
+}
+
+}  // namespace
+
+Pass::Status InstructionSchedulingPass::Process() {
+  bool modified = false;
+  for (auto& func : *get_module()) {
+    const RegisterLiveness* liveness =
+        context()->GetLivenessAnalysis()->Get(&func);
+    // Reordering the instructions of a block does not change the values live
+    // at its boundaries, so the liveness stays valid for the other blocks.
+    for (auto& block : func) {
+      const RegisterLiveness::RegionRegisterLiveness* block_liveness =
+          liveness->Get(&block);
+      if (block_liveness == nullptr) continue;
+      modified |= ScheduleBlock(&block, block_liveness->live_out_);
+    }
+  }
+  return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+}
+
+bool InstructionSchedulingPass::NeedsRegister(Instruction* inst) {
+  if (inst->type_id() == 0 || inst->opcode() == SpvOpUndef ||
+      IsConstantInst(inst->opcode())) {
+    return false;
+  }
+  // Module scope variables are not held in registers.
+  return inst->opcode() != SpvOpVariable ||
+         context()->get_instr_block(inst) != nullptr;
+}
+
+std::vector<Instruction*> InstructionSchedulingPass::GetRegisterOperands(
+    Instruction* inst) {
+  std::vector<Instruction*> operands;
+  inst->ForEachInId([this, &operands](const uint32_t* id) {
+    Instruction* def = get_def_use_mgr()->GetDef(*id);
+    if (NeedsRegister(def) &&
+        std::find(operands.begin(), operands.end(), def) == operands.end()) {
+      operands.push_back(def);
+    }
+  });
+  return operands;
+}
+
+size_t InstructionSchedulingPass::GetPeakPressure(
+    const std::vector<Instruction*>& order, LiveSet live) {
+  size_t peak = live.size();
+  for (auto inst = order.rbegin(); inst != order.rend(); ++inst) {
+    live.erase(*inst);
+    for (Instruction* operand : GetRegisterOperands(*inst)) {
+      live.insert(operand);
+    }
+    peak = std::max(peak, live.size());
+  }
+  return peak;
+}
+
+bool InstructionSchedulingPass::ScheduleBlock(BasicBlock* block,
+                                              const LiveSet& live_out) {
+  Instruction* merge = block->GetMergeInst();
+  Instruction* end = merge != nullptr ? merge : block->terminator();
+
+  std::vector<Instruction*> region;
+  std::unordered_map<Instruction*, size_t> index;
+  for (auto& inst : *block) {
+    if (&inst == end) break;
+    if (inst.opcode() == SpvOpPhi || inst.opcode() == SpvOpVariable) continue;
+    index[&inst] = region.size();
+    region.push_back(&inst);
+  }
+  if (region.size() < 2) return false;
+
+  // The values used by the merge instruction and the terminator are live at
+  // the end of the region.
+  LiveSet live_after(live_out);
+  for (Instruction* inst = end; inst != nullptr; inst = inst->NextNode()) {
+    for (Instruction* operand : GetRegisterOperands(inst)) {
+      live_after.insert(operand);
+    }
+  }
+
+  // Build the dependences.  |predecessors[i]| are the instructions that must
+  // come before |region[i]|, and |successor_counts[i]| is the number of
+  // instructions that must come after it and have not been placed yet.
+  std::vector<std::vector<size_t>> predecessors(region.size());
+  std::vector<size_t> successor_counts(region.size(), 0);
+  auto add_dependence = [&predecessors, &successor_counts](size_t from,
+                                                           size_t to) {
+    predecessors[to].push_back(from);
+    ++successor_counts[from];
+  };
+
+  const size_t kNoInstruction = region.size();
+  size_t last_ordered = kNoInstruction;
+  std::vector<size_t> reads_since_ordered;
+  for (size_t i = 0; i < region.size(); ++i) {
+    region[i]->ForEachInId([this, i, &index, &add_dependence](
+                               const uint32_t* id) {
+      auto def = index.find(get_def_use_mgr()->GetDef(*id));
+      if (def != index.end()) add_dependence(def->second, i);
+    });
+
+    switch (GetMemoryKind(region[i])) {
+      case MemoryKind::kNone:
+        break;
+      case MemoryKind::kRead:
+        if (last_ordered != kNoInstruction) add_dependence(last_ordered, i);
+        reads_since_ordered.push_back(i);
+        break;
+      case MemoryKind::kOrdered:
+        if (last_ordered != kNoInstruction) add_dependence(last_ordered, i);
+        for (size_t read : reads_since_ordered) add_dependence(read, i);
+        reads_since_ordered.clear();
+        last_ordered = i;
+        break;
+    }
+  }
+
+  // Schedule from the bottom up.  The ready instructions are kept sorted by
+  // their original position.
+  std::set<size_t> ready;
+  for (size_t i = 0; i < region.size(); ++i) {
+    if (successor_counts[i] == 0) ready.insert(i);
+  }
+
+  LiveSet live(live_after);
+  std::vector<Instruction*> schedule;
+  while (!ready.empty()) {
+    size_t best = kNoInstruction;
+    std::ptrdiff_t best_growth = 0;
+    for (auto candidate = ready.rbegin(); candidate != ready.rend();
+         ++candidate) {
+      Instruction* inst = region[*candidate];
+      std::ptrdiff_t growth = live.count(inst) != 0 ? -1 : 0;
+      for (Instruction* operand : GetRegisterOperands(inst)) {
+        if (live.count(operand) == 0) ++growth;
+      }
+      if (best == kNoInstruction || growth < best_growth) {
+        best = *candidate;
+        best_growth = growth;
+      }
+    }
+
+    ready.erase(best);
+    schedule.push_back(region[best]);
+    live.erase(region[best]);
+    for (Instruction* operand : GetRegisterOperands(region[best])) {
+      live.insert(operand);
+    }
+    for (size_t predecessor : predecessors[best]) {
+      if (--successor_counts[predecessor] == 0) ready.insert(predecessor);
+    }
+  }
+  assert(schedule.size() == region.size() &&
+         "The dependences in a block cannot form a cycle.");
+  std::reverse(schedule.begin(), schedule.end());
+
+  if (schedule == region || GetPeakPressure(schedule, live_after) >=
+                                GetPeakPressure(region, live_after)) {
+    return false;
+  }
+
+  for (Instruction* inst : schedule) {
+    inst->InsertBefore(end);
+  }
+  return true;
+}
+
+}  // namespace opt
+}  // namespace spvtools
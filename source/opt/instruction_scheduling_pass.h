@@ -0,0 +1,78 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_INSTRUCTION_SCHEDULING_PASS_H_
+#define SOURCE_OPT_INSTRUCTION_SCHEDULING_PASS_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "source/opt/ir_context.h"
+#include "source/opt/pass.h"
+#include "source/opt/register_pressure.h"
+
+namespace spvtools {
+namespace opt {
+
+// This pass reorders the instructions in each basic block to lower the number
+// of values that are live at the same time.
+//
+// The instructions are list scheduled from the bottom of the block up.  Among
+// the instructions whose users have all been placed, the one that adds the
+// fewest values to the live set is placed next, which puts each instruction
+// as close to its uses as its operands allow.  Ties go to the instruction
+// that came last, so the result only depends on the input.
+//
+// Loads may be reordered with each other, but not with the other
+// instructions that access memory or have side effects, which all keep their
+// order.  Phis, variables, merge instructions and terminators do not move.
+// The new order is only kept if the largest number of values live at once in
+// the block goes down.
+class InstructionSchedulingPass : public Pass {
+ public:
+  const char* name() const override { return "schedule-instructions"; }
+  Status Process() override;
+
+  IRContext::Analysis GetPreservedAnalyses() override {
+    return IRContext::kAnalysisDefUse |
+           IRContext::kAnalysisInstrToBlockMapping |
+           IRContext::kAnalysisDecorations | IRContext::kAnalysisCombinators |
+           IRContext::kAnalysisCFG | IRContext::kAnalysisDominatorAnalysis |
+           IRContext::kAnalysisLoopAnalysis | IRContext::kAnalysisNameMap |
+           IRContext::kAnalysisConstants | IRContext::kAnalysisTypes;
+  }
+
+ private:
+  using LiveSet = RegisterLiveness::RegionRegisterLiveness::LiveSet;
+
+  // Reorders the instructions of |block|, where |live_out| is the set of
+  // values live at its end.  Returns true if |block| changed.
+  bool ScheduleBlock(BasicBlock* block, const LiveSet& live_out);
+
+  // Returns true if the result of |inst| is held in a register.
+  bool NeedsRegister(Instruction* inst);
+
+  // Returns the distinct operands of |inst| that need a register.
+  std::vector<Instruction*> GetRegisterOperands(Instruction* inst);
+
+  // Returns the largest number of values live at once in the sequence of
+  // instructions |order|, given that |live| are live after it.
+  size_t GetPeakPressure(const std::vector<Instruction*>& order,
+                         LiveSet live);
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_INSTRUCTION_SCHEDULING_PASS_H_
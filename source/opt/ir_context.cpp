@@ -14,10 +14,13 @@
 
 #include "source/opt/ir_context.h"
 
+#include <atomic>
 #include <cstring>
+#include <thread>
 
 #include "OpenCLDebugInfo100.h"
 #include "source/latest_version_glsl_std_450_header.h"
+#include "source/opt/build_module.h"
 #include "source/opt/log.h"
 #include "source/opt/mem_pass.h"
 #include "source/opt/reflect.h"
@@ -40,6 +43,56 @@ static const uint32_t kDebugGlobalVariableOperandVariableIndex = 11;
 namespace spvtools {
 namespace opt {
 
+bool IRContext::Reset(const uint32_t* binary, size_t size) {
+  // Everything that refers to the old module is dropped, except that the
+  // def-use, type and constant managers are emptied and kept so that their
+  // tables can be reused.
+  std::unique_ptr<analysis::DefUseManager> def_use_mgr =
+      std::move(def_use_mgr_);
+  std::unique_ptr<analysis::TypeManager> type_mgr = std::move(type_mgr_);
+  std::unique_ptr<analysis::ConstantManager> constant_mgr =
+      std::move(constant_mgr_);
+  InvalidateAnalyses(Analysis(kAnalysisEnd - 1));
+  loop_descriptors_.clear();
+  scalar_evolution_analysis_.reset(nullptr);
+  reg_pressure_.reset(nullptr);
+  feature_mgr_.reset(nullptr);
+  dead_code_fingerprints_.clear();
+  if (def_use_mgr) {
+    def_use_mgr->Clear();
+    def_use_mgr_ = std::move(def_use_mgr);
+  }
+  if (constant_mgr) {
+    constant_mgr->Clear();
+    constant_mgr_ = std::move(constant_mgr);
+  }
+  if (type_mgr) {
+    type_mgr->Clear();
+    type_mgr_ = std::move(type_mgr);
+  }
+
+  module_ = MakeUnique<Module>();
+  module_->SetContext(this);
+  unique_id_ = 0;
+  bool loaded =
+      LoadModule(syntax_context_, consumer_, binary, size, module_.get());
+  InitializeCombinators();
+  return loaded;
+}
+
+std::unique_ptr<IRContext> IRContext::Clone() const {
+  std::unique_ptr<IRContext> clone =
+      MakeUnique<IRContext>(syntax_context_->target_env, consumer_);
+  clone->module_.reset(module_->Clone(clone.get()));
+  clone->module_->SetContext(clone.get());
+  clone->InitializeCombinators();
+  clone->max_id_bound_ = max_id_bound_;
+  clone->preserve_bindings_ = preserve_bindings_;
+  clone->preserve_spec_constants_ = preserve_spec_constants_;
+  clone->num_threads_ = num_threads_;
+  return clone;
+}
+
 void IRContext::BuildInvalidAnalyses(IRContext::Analysis set) {
   if (set & kAnalysisDefUse) {
     BuildDefUseManager();
@@ -50,6 +103,9 @@ void IRContext::BuildInvalidAnalyses(IRContext::Analysis set) {
   if (set & kAnalysisDecorations) {
     BuildDecorationManager();
   }
+  if (set & kAnalysisCombinators) {
+    InitializeCombinators();
+  }
   if (set & kAnalysisCFG) {
     BuildCFG();
   }
@@ -86,6 +142,12 @@ void IRContext::BuildInvalidAnalyses(IRContext::Analysis set) {
   if (set & kAnalysisTypes) {
     BuildTypeManager();
   }
+  if (set & kAnalysisMemorySSA) {
+    BuildMemorySSA();
+  }
+  if (set & kAnalysisAliasAnalysis) {
+    BuildAliasAnalysis();
+  }
 }
 
 void IRContext::InvalidateAnalysesExceptFor(
@@ -108,6 +170,17 @@ void IRContext::InvalidateAnalyses(IRContext::Analysis analyses_to_invalidate) {
     analyses_to_invalidate |= kAnalysisDominatorAnalysis;
   }
 
+  // The memory SSA analysis follows the edges of the CFG.
+  if (analyses_to_invalidate & kAnalysisCFG) {
+    analyses_to_invalidate |= kAnalysisMemorySSA;
+  }
+
+  // The recurrent expressions of the scalar evolution analysis point to the
+  // loops of the loop analysis.
+  if (analyses_to_invalidate & kAnalysisLoopAnalysis) {
+    analyses_to_invalidate |= kAnalysisScalarEvolution;
+  }
+
   if (analyses_to_invalidate & kAnalysisDefUse) {
     def_use_mgr_.reset(nullptr);
   }
@@ -148,6 +221,12 @@ void IRContext::InvalidateAnalyses(IRContext::Analysis analyses_to_invalidate) {
   if (analyses_to_invalidate & kAnalysisTypes) {
     type_mgr_.reset(nullptr);
   }
+  if (analyses_to_invalidate & kAnalysisMemorySSA) {
+    memory_ssa_.reset(nullptr);
+  }
+  if (analyses_to_invalidate & kAnalysisAliasAnalysis) {
+    alias_analysis_.reset(nullptr);
+  }
 
   valid_analyses_ = Analysis(valid_analyses_ & ~analyses_to_invalidate);
 }
@@ -178,6 +257,22 @@ Instruction* IRContext::KillInst(Instruction* inst) {
   if (constant_mgr_ && IsConstantInst(inst->opcode())) {
     constant_mgr_->RemoveId(inst->result_id());
   }
+  if (AreAnalysesValid(kAnalysisMemorySSA)) {
+    if (inst->opcode() == SpvOpLoad) {
+      memory_ssa_->RemoveLoad(inst);
+    } else if ((inst->opcode() == SpvOpStore &&
+                memory_ssa_->IsModeledVariable(
+                    inst->GetSingleWordInOperand(0))) ||
+               memory_ssa_->IsModeledVariable(inst->result_id())) {
+      InvalidateAnalyses(kAnalysisMemorySSA);
+    }
+  }
+  if (AreAnalysesValid(kAnalysisAliasAnalysis) && inst->HasResultId()) {
+    alias_analysis_->RemoveInstruction(inst);
+  }
+  if (AreAnalysesValid(kAnalysisScalarEvolution)) {
+    scalar_evolution_analysis_->RemoveInstruction(inst);
+  }
   if (inst->opcode() == SpvOpCapability || inst->opcode() == SpvOpExtension) {
     // We reset the feature manager, instead of updating it, because it is just
     // as much work.  We would have to remove all capabilities implied by this
@@ -221,6 +316,19 @@ bool IRContext::ReplaceAllUsesWithPredicate(
     const std::function<bool(Instruction*, uint32_t)>& predicate) {
   if (before == after) return false;
 
+  // Memory SSA only knows the uses of a variable that it has analyzed.
+  if (AreAnalysesValid(kAnalysisMemorySSA) &&
+      (memory_ssa_->IsModeledVariable(before) ||
+       memory_ssa_->IsModeledVariable(after))) {
+    InvalidateAnalyses(kAnalysisMemorySSA);
+  }
+
+  // The alias analysis caches how each pointer is computed, which may change
+  // if |before| is a pointer or an index.
+  if (AreAnalysesValid(kAnalysisAliasAnalysis)) {
+    InvalidateAnalyses(kAnalysisAliasAnalysis);
+  }
+
   // Ensure that |after| has been registered as def.
   assert(get_def_use_mgr()->GetDef(after) &&
          "'after' is not a registered def.");
@@ -239,6 +347,10 @@ bool IRContext::ReplaceAllUsesWithPredicate(
     uint32_t index = p.second;
     if (prev == nullptr || prev != user) {
       ForgetUses(user);
+      // The evolutions computed through |user| may change.
+      if (AreAnalysesValid(kAnalysisScalarEvolution)) {
+        scalar_evolution_analysis_->InvalidateInstruction(user);
+      }
       prev = user;
     }
     const uint32_t type_result_id_count =
@@ -697,6 +809,42 @@ void IRContext::RemoveFromIdToName(const Instruction* inst) {
   }
 }
 
+void IRContext::ForEachFunctionInParallel(
+    const std::function<void(Function*, size_t)>& fn) {
+  std::vector<Function*> functions;
+  for (auto& func : *module()) {
+    functions.push_back(&func);
+  }
+
+  size_t num_workers = std::min<size_t>(num_threads_, functions.size());
+  if (num_workers <= 1) {
+    for (size_t i = 0; i < functions.size(); ++i) {
+      fn(functions[i], i);
+    }
+    return;
+  }
+
+  // Each worker repeatedly claims the next function that nobody has claimed.
+  std::atomic<size_t> next_function(0);
+  auto worker = [&functions, &fn, &next_function]() {
+    for (size_t i = next_function++; i < functions.size();
+         i = next_function++) {
+      fn(functions[i], i);
+    }
+  };
+
+  // The calling thread is one of the workers.
+  std::vector<std::thread> threads;
+  threads.reserve(num_workers - 1);
+  for (size_t t = 1; t < num_workers; ++t) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
 LoopDescriptor* IRContext::GetLoopDescriptor(const Function* f) {
   if (!AreAnalysesValid(kAnalysisLoopAnalysis)) {
     ResetLoopAnalysis();
@@ -16,6 +16,7 @@
 #define SOURCE_OPT_IR_CONTEXT_H_
 
 #include <algorithm>
+#include <functional>
 #include <iostream>
 #include <limits>
 #include <map>
@@ -27,6 +28,7 @@
 #include <vector>
 
 #include "source/assembly_grammar.h"
+#include "source/opt/alias_analysis.h"
 #include "source/opt/cfg.h"
 #include "source/opt/constants.h"
 #include "source/opt/decoration_manager.h"
@@ -35,6 +37,7 @@
 #include "source/opt/feature_manager.h"
 #include "source/opt/fold.h"
 #include "source/opt/loop_descriptor.h"
+#include "source/opt/memory_ssa.h"
 #include "source/opt/module.h"
 #include "source/opt/register_pressure.h"
 #include "source/opt/scalar_analysis.h"
@@ -78,7 +81,9 @@ class IRContext {
     kAnalysisIdToFuncMapping = 1 << 13,
     kAnalysisConstants = 1 << 14,
     kAnalysisTypes = 1 << 15,
-    kAnalysisEnd = 1 << 16
+    kAnalysisMemorySSA = 1 << 16,
+    kAnalysisAliasAnalysis = 1 << 17,
+    kAnalysisEnd = 1 << 18
   };
 
   using ProcessFunction = std::function<bool(Function*)>;
@@ -102,7 +107,8 @@ class IRContext {
         id_to_name_(nullptr),
         max_id_bound_(kDefaultMaxIdBound),
         preserve_bindings_(false),
-        preserve_spec_constants_(false) {
+        preserve_spec_constants_(false),
+        num_threads_(1) {
     SetContextMessageConsumer(syntax_context_, consumer_);
     module_->SetContext(this);
   }
@@ -119,7 +125,8 @@ class IRContext {
         id_to_name_(nullptr),
         max_id_bound_(kDefaultMaxIdBound),
         preserve_bindings_(false),
-        preserve_spec_constants_(false) {
+        preserve_spec_constants_(false),
+        num_threads_(1) {
     SetContextMessageConsumer(syntax_context_, consumer_);
     module_->SetContext(this);
     InitializeCombinators();
@@ -127,6 +134,22 @@ class IRContext {
 
   ~IRContext() { spvContextDestroy(syntax_context_); }
 
+  // Replaces the module of this context with the module in the SPIR-V
+  // |binary| of |size| words.  The options of the context are kept, and the
+  // grammar tables, the def-use manager, the type manager and the constant
+  // manager are emptied and reused, which avoids most of the allocations of
+  // building a new context for each module.  Returns false if
+  // the binary could not be parsed; the errors are sent to the consumer.
+  bool Reset(const uint32_t* binary, size_t size);
+
+  // Returns a new context holding a deep copy of this context's module.  The
+  // copy is made directly from the in-memory IR, which is much cheaper than
+  // serializing the module and parsing it again, so it can be used to
+  // optimize several variants of the same module.  The options of this
+  // context are copied as well.  No analyses are copied; they are rebuilt on
+  // demand in the new context.
+  std::unique_ptr<IRContext> Clone() const;
+
   Module* module() const { return module_.get(); }
 
   // Returns a vector of pointers to constant-creation instructions in this
@@ -252,6 +275,24 @@ class IRContext {
     return vn_table_.get();
   }
 
+  // Returns a pointer to the memory SSA analysis.  If the analysis is invalid,
+  // it is rebuilt first.
+  MemorySSA* GetMemorySSA() {
+    if (!AreAnalysesValid(kAnalysisMemorySSA)) {
+      BuildMemorySSA();
+    }
+    return memory_ssa_.get();
+  }
+
+  // Returns a pointer to the alias analysis.  If the analysis is invalid, it
+  // is rebuilt first.
+  AliasAnalysis* GetAliasAnalysis() {
+    if (!AreAnalysesValid(kAnalysisAliasAnalysis)) {
+      BuildAliasAnalysis();
+    }
+    return alias_analysis_.get();
+  }
+
   // Returns a pointer to a StructuredCFGAnalysis.  If the analysis is invalid,
   // it is rebuilt first.
   StructuredCFGAnalysis* GetStructuredCFGAnalysis() {
@@ -446,13 +487,15 @@ class IRContext {
     const uint32_t kExtInstSetIdInIndx = 0;
     const uint32_t kExtInstInstructionInIndx = 1;
 
-    if (inst->opcode() != SpvOpExtInst) {
-      return combinator_ops_[0].count(inst->opcode()) != 0;
-    } else {
-      uint32_t set = inst->GetSingleWordInOperand(kExtInstSetIdInIndx);
-      uint32_t op = inst->GetSingleWordInOperand(kExtInstInstructionInIndx);
-      return combinator_ops_[set].count(op) != 0;
+    // Use find() so that this is safe to call from concurrent readers.
+    uint32_t set = 0;
+    uint32_t op = inst->opcode();
+    if (inst->opcode() == SpvOpExtInst) {
+      set = inst->GetSingleWordInOperand(kExtInstSetIdInIndx);
+      op = inst->GetSingleWordInOperand(kExtInstInstructionInIndx);
     }
+    auto ops = combinator_ops_.find(set);
+    return ops != combinator_ops_.end() && ops->second.count(op) != 0;
   }
 
   // Returns a pointer to the CFG for all the functions in |module_|.
@@ -531,6 +574,32 @@ class IRContext {
     preserve_spec_constants_ = should_preserve_spec_constants;
   }
 
+  uint32_t num_threads() const { return num_threads_; }
+  void set_num_threads(uint32_t num_threads) {
+    num_threads_ = num_threads == 0 ? 1 : num_threads;
+  }
+
+  // Returns the fingerprints of the functions in which AggressiveDCEPass last
+  // found nothing to remove, keyed by function id.  The entry for id 0 is the
+  // fingerprint of the module-level instructions.
+  //
+  // This is not an analysis, and passes do not have to keep it up to date: a
+  // part of the module is only taken to be unchanged if its fingerprint is
+  // still the same.
+  std::unordered_map<uint32_t, size_t>* dead_code_fingerprints() {
+    return &dead_code_fingerprints_;
+  }
+
+  // Calls |fn| once for every function in the module, passing the function
+  // and its position in the module.  Up to |num_threads()| threads are used,
+  // so the calls may run concurrently and in any order.  |fn| must not change
+  // the module or the context, including building analyses on demand: every
+  // analysis it reads must be valid before this is called.  Callers get
+  // deterministic output by keeping per-function results indexed by position
+  // and applying them afterwards, in module order, on the calling thread.
+  void ForEachFunctionInParallel(
+      const std::function<void(Function*, size_t)>& fn);
+
   // Return id of input variable only decorated with |builtin|, if in module.
   // Create variable and return its id otherwise. If builtin not currently
   // supported, return 0.
@@ -580,7 +649,12 @@ class IRContext {
  private:
   // Builds the def-use manager from scratch, even if it was already valid.
   void BuildDefUseManager() {
-    def_use_mgr_ = MakeUnique<analysis::DefUseManager>(module());
+    if (def_use_mgr_) {
+      // Reuse the tables of the manager kept by Reset().
+      def_use_mgr_->Reanalyze(module());
+    } else {
+      def_use_mgr_ = MakeUnique<analysis::DefUseManager>(module());
+    }
     valid_analyses_ = valid_analyses_ | kAnalysisDefUse;
   }
 
@@ -634,6 +708,19 @@ class IRContext {
     valid_analyses_ = valid_analyses_ | kAnalysisValueNumberTable;
   }
 
+  // Builds the memory SSA analysis from scratch, even if it was already
+  // valid.
+  void BuildMemorySSA() {
+    memory_ssa_ = MakeUnique<MemorySSA>(this);
+    valid_analyses_ = valid_analyses_ | kAnalysisMemorySSA;
+  }
+
+  // Builds the alias analysis from scratch, even if it was already valid.
+  void BuildAliasAnalysis() {
+    alias_analysis_ = MakeUnique<AliasAnalysis>(this);
+    valid_analyses_ = valid_analyses_ | kAnalysisAliasAnalysis;
+  }
+
   // Builds the structured CFG analysis from scratch, even if it was already
   // valid.
   void BuildStructuredCFGAnalysis() {
@@ -644,14 +731,24 @@ class IRContext {
   // Builds the constant manager from scratch, even if it was already
   // valid.
   void BuildConstantManager() {
-    constant_mgr_ = MakeUnique<analysis::ConstantManager>(this);
+    if (constant_mgr_) {
+      // Reuse the tables of the manager kept by Reset().
+      constant_mgr_->Reanalyze();
+    } else {
+      constant_mgr_ = MakeUnique<analysis::ConstantManager>(this);
+    }
     valid_analyses_ = valid_analyses_ | kAnalysisConstants;
   }
 
   // Builds the type manager from scratch, even if it was already
   // valid.
   void BuildTypeManager() {
-    type_mgr_ = MakeUnique<analysis::TypeManager>(consumer(), this);
+    if (type_mgr_) {
+      // Reuse the tables of the manager kept by Reset().
+      type_mgr_->Reanalyze(*module());
+    } else {
+      type_mgr_ = MakeUnique<analysis::TypeManager>(consumer(), this);
+    }
     valid_analyses_ = valid_analyses_ | kAnalysisTypes;
   }
 
@@ -792,6 +889,10 @@ class IRContext {
 
   std::unique_ptr<StructuredCFGAnalysis> struct_cfg_analysis_;
 
+  std::unique_ptr<MemorySSA> memory_ssa_;
+
+  std::unique_ptr<AliasAnalysis> alias_analysis_;
+
   // The maximum legal value for the id bound.
   uint32_t max_id_bound_;
 
@@ -801,6 +902,12 @@ class IRContext {
   // Whether all specialization constants within |module_|
   // should be preserved.
   bool preserve_spec_constants_;
+
+  // The maximum number of threads used by ForEachFunctionInParallel.
+  uint32_t num_threads_;
+
+  // See |dead_code_fingerprints|.
+  std::unordered_map<uint32_t, size_t> dead_code_fingerprints_;
 };
 
 inline IRContext::Analysis operator|(IRContext::Analysis lhs,
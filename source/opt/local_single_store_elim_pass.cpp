@@ -130,7 +130,7 @@ bool LocalSingleStoreElimPass::ProcessVariable(Instruction* var_inst) {
   Instruction* store_inst = FindSingleStoreAndCheckUses(var_inst, users);
 
   if (store_inst == nullptr) {
-    return false;
+    return RewriteLoadsFromUniqueStores(var_inst, users);
   }
 
   return RewriteLoads(store_inst, users);
@@ -235,9 +235,7 @@ bool LocalSingleStoreElimPass::RewriteLoads(
     if (use->opcode() == SpvOpLoad) {
       if (dominator_analysis->Dominates(store_inst, use)) {
         modified = true;
-        context()->KillNamesAndDecorates(use->result_id());
-        context()->ReplaceAllUsesWith(use->result_id(), stored_id);
-        context()->KillInst(use);
+        ReplaceLoad(use, stored_id);
       }
     }
   }
@@ -245,5 +243,40 @@ bool LocalSingleStoreElimPass::RewriteLoads(
   return modified;
 }
 
+bool LocalSingleStoreElimPass::RewriteLoadsFromUniqueStores(
+    Instruction* var_inst, const std::vector<Instruction*>& uses) {
+  // The memory SSA analysis is kept up to date while loads are killed, so it
+  // is only built once for all of the functions.
+  MemorySSA* memory_ssa = context()->GetMemorySSA();
+  if (!memory_ssa->IsModeledVariable(var_inst->result_id())) {
+    return false;
+  }
+
+  DominatorAnalysis* dominator_analysis = context()->GetDominatorAnalysis(
+      context()->get_instr_block(var_inst)->GetParent());
+  bool modified = false;
+  for (Instruction* use : uses) {
+    if (use->opcode() != SpvOpLoad) {
+      continue;
+    }
+    // A store that reaches the load on every path dominates it, unless the
+    // load is unreachable.
+    Instruction* store_inst = memory_ssa->GetUniqueReachingStore(use);
+    if (store_inst != nullptr &&
+        dominator_analysis->Dominates(store_inst, use)) {
+      modified = true;
+      ReplaceLoad(use, store_inst->GetSingleWordInOperand(kStoreValIdInIdx));
+    }
+  }
+  return modified;
+}
+
+void LocalSingleStoreElimPass::ReplaceLoad(Instruction* load,
+                                           uint32_t value_id) {
+  context()->KillNamesAndDecorates(load->result_id());
+  context()->ReplaceAllUsesWith(load->result_id(), value_id);
+  context()->KillInst(load);
+}
+
 }  // namespace opt
 }  // namespace spvtools
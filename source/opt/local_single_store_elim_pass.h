@@ -67,8 +67,10 @@ class LocalSingleStoreElimPass : public Pass {
 
   // If there is a single store to |var_inst|, and it covers the entire
   // variable, then replace all of the loads of the entire variable that are
-  // dominated by the store by the value that was stored.  Returns true if the
-  // module was changed.
+  // dominated by the store by the value that was stored.  Otherwise, if the
+  // memory SSA analysis models |var_inst|, replace each load that always reads
+  // the value of the same store by that value.  Returns true if the module was
+  // changed.
   bool ProcessVariable(Instruction* var_inst);
 
   // Collects all of the uses of |var_inst| into |uses|.  This looks through
@@ -93,6 +95,15 @@ class LocalSingleStoreElimPass : public Pass {
   bool RewriteLoads(Instruction* store_inst,
                     const std::vector<Instruction*>& uses);
 
+  // Replaces each load in |uses| whose value, according to the memory SSA
+  // analysis, always comes from the same store to |var_inst| by the value
+  // stored.  The load instructions are then killed.
+  bool RewriteLoadsFromUniqueStores(Instruction* var_inst,
+                                    const std::vector<Instruction*>& uses);
+
+  // Replaces all uses of |load| by |value_id| and kills |load|.
+  void ReplaceLoad(Instruction* load, uint32_t value_id);
+
   // Extensions supported by this pass.
   std::unordered_set<std::string> extensions_whitelist_;
 };
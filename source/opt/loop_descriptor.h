@@ -260,6 +260,16 @@ class Loop {
     return loop_header_->GetLoopMergeInst()->GetSingleWordOperand(2) == 1;
   }
 
+  // Returns true if the OpLoopMerge control operand has the DontUnroll bit
+  // set.
+  inline bool HasDontUnrollLoopControl() const {
+    assert(loop_header_);
+    if (!loop_header_->GetLoopMergeInst()) return false;
+
+    return (loop_header_->GetLoopMergeInst()->GetSingleWordOperand(2) &
+            SpvLoopControlDontUnrollMask) != 0;
+  }
+
   // Finds the conditional block with a branch to the merge and continue blocks
   // within the loop body.
   BasicBlock* FindConditionBlock() const;
@@ -719,11 +719,16 @@ void LoopFusion::Fuse() {
 
   containing_function_->RemoveEmptyBlocks();
 
-  // Invalidate analyses.
+  // Invalidate analyses.  Only the evolutions of the phis of the fused loop
+  // changed.
+  if (context_->AreAnalysesValid(IRContext::kAnalysisScalarEvolution)) {
+    context_->GetScalarEvolutionAnalysis()->InvalidateLoop(loop_0_);
+  }
   context_->InvalidateAnalysesExceptFor(
       IRContext::Analysis::kAnalysisInstrToBlockMapping |
       IRContext::Analysis::kAnalysisLoopAnalysis |
-      IRContext::Analysis::kAnalysisDefUse | IRContext::Analysis::kAnalysisCFG);
+      IRContext::Analysis::kAnalysisDefUse | IRContext::Analysis::kAnalysisCFG |
+      IRContext::Analysis::kAnalysisScalarEvolution);
 }
 
 }  // namespace opt
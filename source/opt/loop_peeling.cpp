@@ -468,9 +468,14 @@ void LoopPeeling::PeelBefore(uint32_t peel_factor) {
         context_->get_def_use_mgr()->AnalyzeInstUse(phi);
       });
 
+  // Only the evolutions of the phis around the peeled loop changed.
+  if (context_->AreAnalysesValid(IRContext::kAnalysisScalarEvolution)) {
+    context_->GetScalarEvolutionAnalysis()->InvalidateLoop(GetOriginalLoop());
+  }
   context_->InvalidateAnalysesExceptFor(
       IRContext::kAnalysisDefUse | IRContext::kAnalysisInstrToBlockMapping |
-      IRContext::kAnalysisLoopAnalysis | IRContext::kAnalysisCFG);
+      IRContext::kAnalysisLoopAnalysis | IRContext::kAnalysisCFG |
+      IRContext::kAnalysisScalarEvolution);
 }
 
 void LoopPeeling::PeelAfter(uint32_t peel_factor) {
@@ -560,9 +565,14 @@ void LoopPeeling::PeelAfter(uint32_t peel_factor) {
         def_use_mgr->AnalyzeInstUse(phi);
       });
 
+  // Only the evolutions of the phis around the peeled loop changed.
+  if (context_->AreAnalysesValid(IRContext::kAnalysisScalarEvolution)) {
+    context_->GetScalarEvolutionAnalysis()->InvalidateLoop(GetOriginalLoop());
+  }
   context_->InvalidateAnalysesExceptFor(
       IRContext::kAnalysisDefUse | IRContext::kAnalysisInstrToBlockMapping |
-      IRContext::kAnalysisLoopAnalysis | IRContext::kAnalysisCFG);
+      IRContext::kAnalysisLoopAnalysis | IRContext::kAnalysisCFG |
+      IRContext::kAnalysisScalarEvolution);
 }
 
 Pass::Status LoopPeelingPass::Process() {
@@ -587,8 +597,6 @@ bool LoopPeelingPass::ProcessFunction(Function* f) {
     to_process_loop.push_back(&l);
   }
 
-  ScalarEvolutionAnalysis scev_analysis(context());
-
   for (Loop* loop : to_process_loop) {
     CodeMetrics loop_size;
     loop_size.Analyze(*loop);
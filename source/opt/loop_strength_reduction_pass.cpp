@@ -0,0 +1,397 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/loop_strength_reduction_pass.h"
+
+#include <utility>
+#include <vector>
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const IRContext::Analysis kBuilderAnalyses =
+    IRContext::kAnalysisDefUse | IRContext::kAnalysisInstrToBlockMapping;
+
+bool IsIntegerArithmetic(SpvOp opcode) {
+  return opcode == SpvOpIAdd || opcode == SpvOpISub || opcode == SpvOpIMul;
+}
+
+}  // namespace
+
+Pass::Status LoopStrengthReductionPass::Process() {
+  bool modified = false;
+  for (auto& func : *get_module()) {
+    // The loops are visited from the innermost out.
+    for (auto& loop : *context()->GetLoopDescriptor(&func)) {
+      modified |= ProcessLoop(&loop);
+    }
+  }
+  return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+}
+
+bool LoopStrengthReductionPass::ProcessLoop(Loop* loop) {
+  if (loop->GetPreHeaderBlock() == nullptr ||
+      loop->GetLatchBlock() == nullptr ||
+      context()->cfg()->preds(loop->GetHeaderBlock()->id()).size() != 2) {
+    return false;
+  }
+
+  bool modified = MergeInductionVariables(loop);
+  modified |= ReduceMultiplications(loop);
+  modified |= ReplaceExitValues(loop);
+  return modified;
+}
+
+bool LoopStrengthReductionPass::MergeInductionVariables(Loop* loop) {
+  // Pairs of a redundant phi and the phi that replaces it.
+  std::vector<std::pair<Instruction*, Instruction*>> replacements;
+  std::vector<std::pair<SENode*, Instruction*>> kept;
+  loop->GetHeaderBlock()->ForEachPhiInst(
+      [this, loop, &replacements, &kept](Instruction* phi) {
+        if (!IsInt32(phi->type_id())) return;
+        SENode* evolution = GetEvolution(phi);
+        SERecurrentNode* rec = evolution->AsSERecurrentNode();
+        if (rec == nullptr || rec->GetLoop() != loop) return;
+
+        for (auto& other : kept) {
+          if (other.first == evolution &&
+              other.second->type_id() == phi->type_id()) {
+            replacements.emplace_back(phi, other.second);
+            return;
+          }
+        }
+        kept.emplace_back(evolution, phi);
+      });
+  if (replacements.empty()) return false;
+
+  const uint32_t latch_id = loop->GetLatchBlock()->id();
+  for (auto& replacement : replacements) {
+    Instruction* phi = replacement.first;
+    uint32_t latch_value = 0;
+    for (uint32_t i = 0; i < phi->NumInOperands(); i += 2) {
+      if (phi->GetSingleWordInOperand(i + 1) == latch_id) {
+        latch_value = phi->GetSingleWordInOperand(i);
+      }
+    }
+    context()->ReplaceAllUsesWith(phi->result_id(),
+                                  replacement.second->result_id());
+    context()->KillInst(phi);
+    KillDeadArithmetic(get_def_use_mgr()->GetDef(latch_value), loop);
+  }
+  return true;
+}
+
+bool LoopStrengthReductionPass::ReduceMultiplications(Loop* loop) {
+  Function* function = loop->GetHeaderBlock()->GetParent();
+  std::vector<uint32_t> multiplications;
+  for (auto& block : *function) {
+    if (!loop->IsInsideLoop(&block)) continue;
+    for (auto& inst : block) {
+      if (inst.opcode() == SpvOpIMul && IsInt32(inst.type_id())) {
+        multiplications.push_back(inst.result_id());
+      }
+    }
+  }
+
+  BasicBlock* header = loop->GetHeaderBlock();
+  BasicBlock* preheader = loop->GetPreHeaderBlock();
+  BasicBlock* latch = loop->GetLatchBlock();
+  bool modified = false;
+  for (uint32_t id : multiplications) {
+    Instruction* multiplication = get_def_use_mgr()->GetDef(id);
+    SENode* start = nullptr;
+    SENode* step = nullptr;
+    if (multiplication == nullptr ||
+        !GetAffineForm(GetEvolution(multiplication), loop, &start, &step)) {
+      continue;
+    }
+
+    // Find the largest expression containing the multiplication that still
+    // evolves the same way, such as |base + i * stride|.
+    Instruction* expression = multiplication;
+    while (get_def_use_mgr()->NumUses(expression) == 1) {
+      Instruction* user = nullptr;
+      get_def_use_mgr()->ForEachUser(
+          expression, [&user](Instruction* use) { user = use; });
+      if (!IsIntegerArithmetic(user->opcode()) ||
+          user->type_id() != expression->type_id() ||
+          !loop->IsInsideLoop(user) ||
+          !GetAffineForm(GetEvolution(user), loop, &start, &step)) {
+        break;
+      }
+      expression = user;
+    }
+
+    // On exit, the new induction variable is one step ahead of the last value
+    // of the expression, so the expression must only be used in the loop.
+    if (!get_def_use_mgr()->WhileEachUser(
+            expression,
+            [loop](Instruction* user) { return loop->IsInsideLoop(user); })) {
+      continue;
+    }
+
+    SENode* evolution = GetEvolution(expression);
+    GetAffineForm(evolution, loop, &start, &step);
+    uint32_t type_id = expression->type_id();
+    uint32_t induction_variable = 0;
+    if (evolution->AsSERecurrentNode() != nullptr) {
+      induction_variable = FindPhi(evolution->AsSERecurrentNode());
+      if (induction_variable != 0 &&
+          get_def_use_mgr()->GetDef(induction_variable)->type_id() !=
+              type_id) {
+        induction_variable = 0;
+      }
+    }
+
+    if (induction_variable == 0) {
+      InstructionBuilder preheader_builder(
+          context(), GetInsertionPoint(preheader), kBuilderAnalyses);
+      uint32_t start_id = Generate(start, type_id, &preheader_builder);
+      uint32_t step_id = Generate(step, type_id, &preheader_builder);
+
+      // The phi takes the start value on both edges until the increment
+      // exists.
+      InstructionBuilder header_builder(context(), &*header->begin(),
+                                        kBuilderAnalyses);
+      Instruction* phi = header_builder.AddPhi(
+          type_id, {start_id, preheader->id(), start_id, latch->id()});
+      InstructionBuilder latch_builder(context(), GetInsertionPoint(latch),
+                                       kBuilderAnalyses);
+      Instruction* increment =
+          latch_builder.AddIAdd(type_id, phi->result_id(), step_id);
+      phi->SetInOperand(2, {increment->result_id()});
+      get_def_use_mgr()->AnalyzeInstUse(phi);
+
+      induction_variable = phi->result_id();
+    }
+
+    context()->ReplaceAllUsesWith(expression->result_id(), induction_variable);
+    KillDeadArithmetic(expression, loop);
+    modified = true;
+  }
+  return modified;
+}
+
+bool LoopStrengthReductionPass::ReplaceExitValues(Loop* loop) {
+  // The trip count is the number of times the header is left for the body, so
+  // the values of the header are only known on exit if it is tested there.
+  BasicBlock* header = loop->GetHeaderBlock();
+  if (loop->FindConditionBlock() != header) return false;
+  Instruction* induction = loop->FindConditionVariable(header);
+  if (induction == nullptr) return false;
+  size_t iterations = 0;
+  if (!loop->FindNumberOfIterations(induction, &*header->ctail(),
+                                    &iterations)) {
+    return false;
+  }
+
+  // The loop must not be left from any other block.
+  BasicBlock* merge = loop->GetMergeBlock();
+  if (context()->cfg()->preds(merge->id()).size() != 1) return false;
+
+  std::vector<Instruction*> values;
+  for (auto& inst : *header) {
+    if (IsInt32(inst.type_id()) &&
+        !get_def_use_mgr()->WhileEachUser(&inst, [loop](Instruction* user) {
+          return loop->IsInsideLoop(user);
+        })) {
+      values.push_back(&inst);
+    }
+  }
+
+  Instruction* insertion_point = &*merge->begin();
+  while (insertion_point->opcode() == SpvOpPhi) {
+    insertion_point = insertion_point->NextNode();
+  }
+
+  ScalarEvolutionAnalysis* scev = context()->GetScalarEvolutionAnalysis();
+  bool modified = false;
+  for (Instruction* value : values) {
+    SENode* start = nullptr;
+    SENode* step = nullptr;
+    if (!GetAffineForm(GetEvolution(value), loop, &start, &step)) continue;
+    SENode* exit_value = scev->SimplifyExpression(scev->CreateAddNode(
+        start, scev->CreateMultiplyNode(
+                   step, scev->CreateConstant(
+                             static_cast<int64_t>(iterations)))));
+    if (!CanGenerate(exit_value, loop)) continue;
+
+    // A computed exit value is not available in the predecessors of the phis
+    // after the loop, so only constants replace uses in phis.
+    bool is_constant = exit_value->AsSEConstantNode() != nullptr;
+    auto is_replaced = [loop, is_constant](Instruction* user, uint32_t) {
+      return !loop->IsInsideLoop(user) &&
+             (is_constant || user->opcode() != SpvOpPhi);
+    };
+    if (get_def_use_mgr()->WhileEachUse(
+            value, [&is_replaced](Instruction* user, uint32_t index) {
+              return !is_replaced(user, index);
+            })) {
+      continue;
+    }
+
+    InstructionBuilder builder(context(), insertion_point, kBuilderAnalyses);
+    uint32_t exit_id = Generate(exit_value, value->type_id(), &builder);
+    context()->ReplaceAllUsesWithPredicate(value->result_id(), exit_id,
+                                           is_replaced);
+    modified = true;
+  }
+  return modified;
+}
+
+bool LoopStrengthReductionPass::GetAffineForm(SENode* node, const Loop* loop,
+                                              SENode** start, SENode** step) {
+  SERecurrentNode* rec = node->AsSERecurrentNode();
+  if (rec == nullptr || rec->GetLoop() != loop) {
+    rec = nullptr;
+    if (node->GetType() != SENode::Add) return false;
+    for (SENode* child : *node) {
+      SERecurrentNode* child_rec = child->AsSERecurrentNode();
+      if (child_rec != nullptr && child_rec->GetLoop() == loop) {
+        rec = child_rec;
+      }
+    }
+    if (rec == nullptr) return false;
+  }
+
+  ScalarEvolutionAnalysis* scev = context()->GetScalarEvolutionAnalysis();
+  *step = rec->GetCoefficient();
+  *start = scev->BuildGraphWithoutRecurrentTerm(node, loop);
+  return CanGenerate(*start, loop) && CanGenerate(*step, loop);
+}
+
+bool LoopStrengthReductionPass::CanGenerate(SENode* node, const Loop* loop) {
+  switch (node->GetType()) {
+    case SENode::Constant:
+      return true;
+    case SENode::ValueUnknown: {
+      Instruction* inst =
+          get_def_use_mgr()->GetDef(node->AsSEValueUnknown()->ResultId());
+      BasicBlock* block = context()->get_instr_block(inst);
+      return IsInt32(inst->type_id()) &&
+             (block == nullptr || !loop->IsInsideLoop(block));
+    }
+    case SENode::RecurrentAddExpr: {
+      SERecurrentNode* rec = node->AsSERecurrentNode();
+      return !loop->IsInsideLoop(rec->GetLoop()->GetHeaderBlock()) &&
+             FindPhi(rec) != 0;
+    }
+    case SENode::Add:
+    case SENode::Multiply:
+    case SENode::Negative:
+      for (SENode* child : *node) {
+        if (!CanGenerate(child, loop)) return false;
+      }
+      return true;
+    default:
+      return false;
+  }
+}
+
+uint32_t LoopStrengthReductionPass::Generate(SENode* node, uint32_t type_id,
+                                             InstructionBuilder* builder) {
+  switch (node->GetType()) {
+    case SENode::Constant: {
+      analysis::ConstantManager* const_mgr = context()->get_constant_mgr();
+      const analysis::Constant* constant = const_mgr->GetConstant(
+          context()->get_type_mgr()->GetType(type_id),
+          {static_cast<uint32_t>(
+              node->AsSEConstantNode()->FoldToSingleValue())});
+      return const_mgr->GetDefiningInstruction(constant, type_id)
+          ->result_id();
+    }
+    case SENode::ValueUnknown:
+    case SENode::RecurrentAddExpr: {
+      uint32_t id = node->AsSEValueUnknown() != nullptr
+                        ? node->AsSEValueUnknown()->ResultId()
+                        : FindPhi(node->AsSERecurrentNode());
+      if (get_def_use_mgr()->GetDef(id)->type_id() != type_id) {
+        id = builder->AddUnaryOp(type_id, SpvOpBitcast, id)->result_id();
+      }
+      return id;
+    }
+    case SENode::Negative:
+      return builder
+          ->AddUnaryOp(type_id, SpvOpSNegate,
+                       Generate(node->GetChild(0), type_id, builder))
+          ->result_id();
+    default: {
+      assert((node->GetType() == SENode::Add ||
+              node->GetType() == SENode::Multiply) &&
+             "CanGenerate must hold for the node.");
+      SpvOp opcode =
+          node->GetType() == SENode::Add ? SpvOpIAdd : SpvOpIMul;
+      uint32_t result = 0;
+      for (SENode* child : *node) {
+        uint32_t id = Generate(child, type_id, builder);
+        result = result == 0
+                     ? id
+                     : builder->AddBinaryOp(type_id, opcode, result, id)
+                           ->result_id();
+      }
+      return result;
+    }
+  }
+}
+
+uint32_t LoopStrengthReductionPass::FindPhi(SERecurrentNode* rec) {
+  for (const Instruction& inst : *rec->GetLoop()->GetHeaderBlock()) {
+    if (inst.opcode() != SpvOpPhi) break;
+    if (IsInt32(inst.type_id()) && GetEvolution(&inst) == rec) {
+      return inst.result_id();
+    }
+  }
+  return 0;
+}
+
+SENode* LoopStrengthReductionPass::GetEvolution(const Instruction* inst) {
+  ScalarEvolutionAnalysis* scev = context()->GetScalarEvolutionAnalysis();
+  return scev->SimplifyExpression(scev->AnalyzeInstruction(inst));
+}
+
+void LoopStrengthReductionPass::KillDeadArithmetic(Instruction* inst,
+                                                   const Loop* loop) {
+  if (inst == nullptr) return;
+
+  // Ids are used, since an instruction can appear more than once.
+  std::vector<uint32_t> worklist = {inst->result_id()};
+  while (!worklist.empty()) {
+    Instruction* current = get_def_use_mgr()->GetDef(worklist.back());
+    worklist.pop_back();
+    if (current == nullptr || !IsIntegerArithmetic(current->opcode()) ||
+        !loop->IsInsideLoop(current) ||
+        get_def_use_mgr()->NumUses(current) != 0) {
+      continue;
+    }
+    current->ForEachInId(
+        [&worklist](const uint32_t* id) { worklist.push_back(*id); });
+    context()->KillInst(current);
+  }
+}
+
+bool LoopStrengthReductionPass::IsInt32(uint32_t type_id) {
+  const analysis::Type* type =
+      type_id == 0 ? nullptr : context()->get_type_mgr()->GetType(type_id);
+  return type != nullptr && type->AsInteger() != nullptr &&
+         type->AsInteger()->width() == 32;
+}
+
+Instruction* LoopStrengthReductionPass::GetInsertionPoint(BasicBlock* block) {
+  Instruction* merge = block->GetMergeInst();
+  return merge != nullptr ? merge : block->terminator();
+}
+
+}  // namespace opt
+}  // namespace spvtools
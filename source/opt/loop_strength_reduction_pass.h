@@ -0,0 +1,113 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_LOOP_STRENGTH_REDUCTION_PASS_H_
+#define SOURCE_OPT_LOOP_STRENGTH_REDUCTION_PASS_H_
+
+#include <cstdint>
+
+#include "source/opt/ir_builder.h"
+#include "source/opt/loop_descriptor.h"
+#include "source/opt/pass.h"
+#include "source/opt/scalar_analysis.h"
+
+namespace spvtools {
+namespace opt {
+
+// This pass simplifies the induction variables of loops, using the scalar
+// evolution analysis.  For each loop, innermost first, it
+//
+// - replaces the header phis that evolve the same way as an earlier phi of the
+//   same type by that phi,
+//
+// - strength reduces the integer multiplications whose result evolves as
+//   |base + i * stride| in the loop, where |base| and |stride| are loop
+//   invariant: the largest such expression containing the multiplication is
+//   replaced by a new induction variable, starting at |base| and incremented
+//   by |stride| on each iteration,
+//
+// - replaces the uses after the loop of header values that evolve that way by
+//   their value on exit, computed from the trip count of the loop.
+//
+// Only 32-bit integers are handled.  The loops must have a preheader, and a
+// header with no other predecessor than the preheader and the latch.
+class LoopStrengthReductionPass : public Pass {
+ public:
+  const char* name() const override { return "loop-strength-reduction"; }
+  Status Process() override;
+
+  IRContext::Analysis GetPreservedAnalyses() override {
+    return IRContext::kAnalysisDefUse |
+           IRContext::kAnalysisInstrToBlockMapping |
+           IRContext::kAnalysisDecorations | IRContext::kAnalysisCombinators |
+           IRContext::kAnalysisCFG | IRContext::kAnalysisDominatorAnalysis |
+           IRContext::kAnalysisLoopAnalysis | IRContext::kAnalysisNameMap |
+           IRContext::kAnalysisScalarEvolution | IRContext::kAnalysisConstants |
+           IRContext::kAnalysisTypes;
+  }
+
+ private:
+  // Simplifies the induction variables of |loop|.  Returns true if something
+  // changed.
+  bool ProcessLoop(Loop* loop);
+
+  // Replaces the header phis of |loop| that are equal to an earlier one.
+  // Returns true if something changed.
+  bool MergeInductionVariables(Loop* loop);
+
+  // Replaces multiplications in |loop| by new induction variables.  Returns
+  // true if something changed.
+  bool ReduceMultiplications(Loop* loop);
+
+  // Replaces the uses after |loop| of the values of its header by their value
+  // on exit.  Returns true if something changed.
+  bool ReplaceExitValues(Loop* loop);
+
+  // Returns true if |node| evolves as |start + i * step| in |loop|, and sets
+  // |start| and |step|, which can be computed before |loop|.
+  bool GetAffineForm(SENode* node, const Loop* loop, SENode** start,
+                     SENode** step);
+
+  // Returns true if the value of |node| can be computed outside of |loop|.
+  bool CanGenerate(SENode* node, const Loop* loop);
+
+  // Adds the instructions computing |node| as a value of type |type_id| with
+  // |builder|, and returns the id of the result.  CanGenerate must be true
+  // for |node|.
+  uint32_t Generate(SENode* node, uint32_t type_id,
+                    InstructionBuilder* builder);
+
+  // Returns the id of a header phi of the loop of |rec| that evolves as
+  // |rec|, or 0 if there is none.
+  uint32_t FindPhi(SERecurrentNode* rec);
+
+  // Returns the simplified scalar evolution of |inst|.
+  SENode* GetEvolution(const Instruction* inst);
+
+  // Kills |inst| if it is an integer operation in |loop| without uses, then
+  // does the same with its operands.
+  void KillDeadArithmetic(Instruction* inst, const Loop* loop);
+
+  // Returns true if |type_id| is a 32-bit integer type.
+  bool IsInt32(uint32_t type_id);
+
+  // Returns the instruction before which code can be added at the end of
+  // |block|.
+  Instruction* GetInsertionPoint(BasicBlock* block);
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_LOOP_STRENGTH_REDUCTION_PASS_H_
@@ -14,6 +14,7 @@
 
 #include "source/opt/loop_unroller.h"
 
+#include <algorithm>
 #include <limits>
 #include <map>
 #include <memory>
@@ -1065,12 +1066,123 @@ void LoopUtils::Finalize() {
  *
  */
 
+size_t LoopUnroller::GetUnrolledBodySize(
+    const Loop& loop,
+    const std::unordered_map<const Loop*, size_t>& unrolled_sizes) const {
+  CodeMetrics metrics;
+  metrics.Analyze(loop);
+  size_t body_size = metrics.roi_size_;
+
+  // The nested loops are counted at the size they have once unrolled.
+  for (const Loop* nested : loop) {
+    auto unrolled = unrolled_sizes.find(nested);
+    if (unrolled == unrolled_sizes.end()) continue;
+    CodeMetrics nested_metrics;
+    nested_metrics.Analyze(*nested);
+    body_size = body_size - nested_metrics.roi_size_ + unrolled->second;
+  }
+  return std::max<size_t>(body_size, 1);
+}
+
+size_t LoopUnroller::GetAutomaticUnrollFactor(
+    Loop* loop, const RegisterLiveness* liveness,
+    std::unordered_map<const Loop*, size_t>* unrolled_sizes) const {
+  size_t body_size = GetUnrolledBodySize(*loop, *unrolled_sizes);
+  (*unrolled_sizes)[loop] = body_size;
+
+  const BasicBlock* condition = loop->FindConditionBlock();
+  const Instruction* induction = loop->FindConditionVariable(condition);
+  size_t iterations = 0;
+  loop->FindNumberOfIterations(induction, &*condition->ctail(), &iterations);
+  if (iterations == 0) return 0;
+
+  // The values live through the loop need a register for the whole unrolled
+  // loop.  The others are assumed to be needed once per copy of the body,
+  // as later passes may interleave the copies.
+  RegisterLiveness::RegionRegisterLiveness pressure;
+  liveness->ComputeLoopRegisterPressure(*loop, &pressure);
+  size_t live_through = 0;
+  for (Instruction* value : pressure.live_in_) {
+    if (!loop->IsInsideLoop(value)) ++live_through;
+  }
+  size_t body_registers = pressure.used_registers_ > live_through
+                              ? pressure.used_registers_ - live_through
+                              : 0;
+  auto fits = [this, body_size, live_through, body_registers](size_t factor,
+                                                              size_t copies) {
+    return body_size * copies <= max_unrolled_size_ &&
+           live_through + body_registers * factor <= max_registers_;
+  };
+
+  // A loop that runs once only loses its control flow.
+  if (iterations == 1) {
+    return fits(1, 1) ? 1 : 0;
+  }
+
+  size_t max_factor =
+      std::min<size_t>(iterations, max_unrolled_size_ / body_size);
+  // Prefer a factor that divides the trip count, since otherwise another
+  // copy of the loop runs the remaining iterations.
+  for (size_t factor = max_factor; factor > 1; --factor) {
+    if (iterations % factor == 0 && fits(factor, factor)) {
+      (*unrolled_sizes)[loop] = body_size * factor;
+      return factor;
+    }
+  }
+  for (size_t factor = max_factor; factor > 1; --factor) {
+    if (fits(factor, factor + 1)) {
+      (*unrolled_sizes)[loop] = body_size * (factor + 1);
+      return factor;
+    }
+  }
+  return 0;
+}
+
 Pass::Status LoopUnroller::Process() {
   bool changed = false;
   for (Function& f : *context()->module()) {
     LoopDescriptor* LD = context()->GetLoopDescriptor(&f);
+
+    // The factors are chosen before any loop is changed, while the register
+    // liveness of the function is still valid.  The loops are visited inner
+    // loops first, so the size of each loop can account for the unrolling of
+    // the loops nested in it.
+    std::unordered_map<Loop*, size_t> automatic_factors;
+    if (automatic_) {
+      const RegisterLiveness* liveness =
+          context()->GetLivenessAnalysis()->Get(&f);
+      std::unordered_map<const Loop*, size_t> unrolled_sizes;
+      for (Loop& loop : *LD) {
+        LoopUtils loop_utils{context(), &loop};
+        if (loop.HasDontUnrollLoopControl() ||
+            !loop_utils.CanPerformUnroll()) {
+          unrolled_sizes[&loop] = GetUnrolledBodySize(loop, unrolled_sizes);
+          continue;
+        }
+        automatic_factors[&loop] =
+            GetAutomaticUnrollFactor(&loop, liveness, &unrolled_sizes);
+      }
+    }
+
     for (Loop& loop : *LD) {
       LoopUtils loop_utils{context(), &loop};
+      if (automatic_) {
+        auto factor = automatic_factors.find(&loop);
+        if (factor == automatic_factors.end() || factor->second == 0 ||
+            !loop_utils.CanPerformUnroll()) {
+          continue;
+        }
+        // PartiallyUnroll fully unrolls the loop if the factor is its trip
+        // count, but it does nothing for a factor of 1.
+        if (factor->second == 1) {
+          loop_utils.FullyUnroll();
+        } else {
+          loop_utils.PartiallyUnroll(factor->second);
+        }
+        changed = true;
+        continue;
+      }
+
       if (!loop.HasUnrollLoopControl() || !loop_utils.CanPerformUnroll()) {
         continue;
       }
@@ -15,16 +15,48 @@
 #ifndef SOURCE_OPT_LOOP_UNROLLER_H_
 #define SOURCE_OPT_LOOP_UNROLLER_H_
 
+#include <cstdint>
+#include <unordered_map>
+
+#include "source/opt/loop_descriptor.h"
 #include "source/opt/pass.h"
+#include "source/opt/register_pressure.h"
 
 namespace spvtools {
 namespace opt {
 
+// Unrolls the loops marked with the Unroll loop control, either fully or by
+// a fixed factor.  In the automatic mode, every loop that is not marked
+// DontUnroll is considered instead, and the unroll factor is chosen for each
+// loop from its trip count, its size and the registers it needs.
 class LoopUnroller : public Pass {
  public:
-  LoopUnroller() : Pass(), fully_unroll_(true), unroll_factor_(0) {}
+  LoopUnroller()
+      : Pass(),
+        fully_unroll_(true),
+        unroll_factor_(0),
+        automatic_(false),
+        max_unrolled_size_(0),
+        max_registers_(0) {}
   LoopUnroller(bool fully_unroll, int unroll_factor)
-      : Pass(), fully_unroll_(fully_unroll), unroll_factor_(unroll_factor) {}
+      : Pass(),
+        fully_unroll_(fully_unroll),
+        unroll_factor_(unroll_factor),
+        automatic_(false),
+        max_unrolled_size_(0),
+        max_registers_(0) {}
+
+  // Creates an unroller in the automatic mode.  A loop is unrolled by the
+  // largest factor for which the unrolled loop has at most
+  // |max_unrolled_size| instructions and is not expected to need more than
+  // |max_registers| registers.
+  LoopUnroller(uint32_t max_unrolled_size, uint32_t max_registers)
+      : Pass(),
+        fully_unroll_(false),
+        unroll_factor_(0),
+        automatic_(true),
+        max_unrolled_size_(max_unrolled_size),
+        max_registers_(max_registers) {}
 
   const char* name() const override { return "loop-unroll"; }
 
@@ -39,8 +71,31 @@ class LoopUnroller : public Pass {
   }
 
  private:
+  // Returns the number of instructions in the body of |loop|, counting each
+  // loop nested in it at its size in |unrolled_sizes| if it has one.
+  size_t GetUnrolledBodySize(
+      const Loop& loop,
+      const std::unordered_map<const Loop*, size_t>& unrolled_sizes) const;
+
+  // Returns the factor by which |loop| should be unrolled in the automatic
+  // mode, given the register liveness of its function.  A result equal to the
+  // trip count means the loop should be fully unrolled, and 0 that it should
+  // be left alone.  The size of |loop| once unrolled is added to
+  // |unrolled_sizes|, which must already hold the sizes of the loops nested
+  // in it.  |loop| must satisfy LoopUtils::CanPerformUnroll.
+  size_t GetAutomaticUnrollFactor(
+      Loop* loop, const RegisterLiveness* liveness,
+      std::unordered_map<const Loop*, size_t>* unrolled_sizes) const;
+
   bool fully_unroll_;
   int unroll_factor_;
+
+  // True if the unroll factor is chosen for each loop.
+  bool automatic_;
+
+  // The limits used in the automatic mode.
+  uint32_t max_unrolled_size_;
+  uint32_t max_registers_;
 };
 
 }  // namespace opt
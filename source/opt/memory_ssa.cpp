@@ -0,0 +1,284 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/memory_ssa.h"
+
+#include <unordered_set>
+
+#include "source/opt/ir_context.h"
+#include "source/util/make_unique.h"
+
+namespace spvtools {
+namespace opt {
+
+MemorySSA::MemorySSA(IRContext* context) : context_(context) { Analyze(); }
+
+void MemorySSA::Analyze() {
+  analysis::DefUseManager* def_use_mgr = context_->get_def_use_mgr();
+  for (auto& func : *context_->module()) {
+    if (func.begin() == func.end()) {
+      continue;
+    }
+
+    BasicBlock* entry = &*func.begin();
+    for (auto& inst : *entry) {
+      if (inst.opcode() != SpvOpVariable ||
+          inst.GetSingleWordInOperand(0) != SpvStorageClassFunction) {
+        continue;
+      }
+
+      bool is_modeled = def_use_mgr->WhileEachUse(
+          &inst, [](Instruction* user, uint32_t index) {
+            switch (user->opcode()) {
+              case SpvOpLoad:
+              case SpvOpName:
+                return true;
+              case SpvOpStore:
+                // The variable must be the pointer, not the stored object.
+                return index == 0;
+              default:
+                return user->IsDecoration();
+            }
+          });
+      if (is_modeled) {
+        modeled_variables_.insert(inst.result_id());
+        live_on_entry_[inst.result_id()] = NewAccess(
+            MemoryAccess::kLiveOnEntry, inst.result_id(), &inst, entry);
+      }
+    }
+
+    for (auto& block : func) {
+      for (auto& inst : block) {
+        if (inst.opcode() != SpvOpStore) {
+          continue;
+        }
+        uint32_t var_id = inst.GetSingleWordInOperand(0);
+        if (!IsModeledVariable(var_id)) {
+          continue;
+        }
+        MemoryAccess* def =
+            NewAccess(MemoryAccess::kDef, var_id, &inst, &block);
+        store_to_def_[&inst] = def;
+        last_def_in_block_[BlockKey(&block, var_id)] = def;
+      }
+    }
+  }
+}
+
+MemoryAccess* MemorySSA::GetReachingDef(Instruction* load) {
+  if (load->opcode() != SpvOpLoad ||
+      !IsModeledVariable(load->GetSingleWordInOperand(0))) {
+    return nullptr;
+  }
+
+  auto it = load_to_def_.find(load);
+  if (it == load_to_def_.end()) {
+    BasicBlock* block = context_->get_instr_block(load);
+    if (block == nullptr) {
+      return nullptr;
+    }
+    AnalyzeLoadsInBlock(block);
+    it = load_to_def_.find(load);
+    if (it == load_to_def_.end()) {
+      return nullptr;
+    }
+  }
+  return Resolve(it->second);
+}
+
+bool MemorySSA::GetReachingStores(Instruction* load,
+                                  std::vector<Instruction*>* stores) {
+  MemoryAccess* def = GetReachingDef(load);
+  if (def == nullptr) {
+    return true;
+  }
+
+  bool reaches_live_on_entry = false;
+  std::vector<MemoryAccess*> worklist = {def};
+  std::unordered_set<MemoryAccess*> visited;
+  while (!worklist.empty()) {
+    MemoryAccess* access = Resolve(worklist.back());
+    worklist.pop_back();
+    if (!visited.insert(access).second) {
+      continue;
+    }
+
+    switch (access->kind()) {
+      case MemoryAccess::kLiveOnEntry:
+        reaches_live_on_entry = true;
+        break;
+      case MemoryAccess::kDef:
+        stores->push_back(access->instruction());
+        break;
+      case MemoryAccess::kPhi:
+        worklist.insert(worklist.end(), access->operands().begin(),
+                        access->operands().end());
+        break;
+    }
+  }
+  return reaches_live_on_entry;
+}
+
+Instruction* MemorySSA::GetUniqueReachingStore(Instruction* load) {
+  std::vector<Instruction*> stores;
+  if (GetReachingStores(load, &stores) || stores.size() != 1) {
+    return nullptr;
+  }
+  return stores[0];
+}
+
+MemoryAccess* MemorySSA::Resolve(MemoryAccess* access) {
+  while (access->replacement_ != nullptr) {
+    access = access->replacement_;
+  }
+  return access;
+}
+
+void MemorySSA::AnalyzeLoadsInBlock(BasicBlock* block) {
+  std::unordered_map<uint32_t, MemoryAccess*> current_def;
+  for (auto& inst : *block) {
+    if (inst.opcode() == SpvOpStore) {
+      auto def = store_to_def_.find(&inst);
+      if (def != store_to_def_.end()) {
+        current_def[def->second->variable_id()] = def->second;
+      }
+    } else if (inst.opcode() == SpvOpLoad) {
+      uint32_t var_id = inst.GetSingleWordInOperand(0);
+      if (!IsModeledVariable(var_id)) {
+        continue;
+      }
+      auto def = current_def.find(var_id);
+      load_to_def_[&inst] = def != current_def.end()
+                                ? def->second
+                                : GetDefAtEntry(var_id, block);
+    }
+  }
+}
+
+MemoryAccess* MemorySSA::GetDefAtEntry(uint32_t var_id, BasicBlock* block) {
+  // Walk up through blocks with a single predecessor until a block whose
+  // definition is known is found.  The result is recorded for every block on
+  // the way.
+  std::vector<uint64_t> visited_keys;
+  std::unordered_set<BasicBlock*> visited_blocks;
+  MemoryAccess* def = nullptr;
+  while (def == nullptr) {
+    const uint64_t key = BlockKey(block, var_id);
+    auto it = def_at_entry_.find(key);
+    if (it != def_at_entry_.end()) {
+      def = Resolve(it->second);
+      break;
+    }
+
+    if (!visited_blocks.insert(block).second) {
+      // A cycle of blocks with a single predecessor cannot be reached from the
+      // entry block.
+      def = live_on_entry_[var_id];
+      break;
+    }
+
+    std::vector<BasicBlock*> preds = GetUniquePredecessors(block);
+    if (preds.size() > 1) {
+      def = CreatePhi(var_id, block, preds);
+      break;
+    }
+
+    visited_keys.push_back(key);
+    if (preds.empty()) {
+      def = live_on_entry_[var_id];
+    } else {
+      block = preds[0];
+      auto last_def = last_def_in_block_.find(BlockKey(block, var_id));
+      if (last_def != last_def_in_block_.end()) {
+        def = last_def->second;
+      }
+    }
+  }
+
+  for (uint64_t key : visited_keys) {
+    def_at_entry_[key] = def;
+  }
+  return def;
+}
+
+MemoryAccess* MemorySSA::CreatePhi(uint32_t var_id, BasicBlock* block,
+                                   const std::vector<BasicBlock*>& preds) {
+  // Record the phi before visiting the predecessors, so that loops find it
+  // instead of visiting this block again.
+  const uint64_t key = BlockKey(block, var_id);
+  MemoryAccess* phi = NewAccess(MemoryAccess::kPhi, var_id, nullptr, block);
+  def_at_entry_[key] = phi;
+  for (BasicBlock* pred : preds) {
+    phi->operands_.push_back(GetDefAtExit(var_id, pred));
+  }
+  MemoryAccess* def = TryRemoveTrivialPhi(phi);
+  def_at_entry_[key] = def;
+  return def;
+}
+
+std::vector<BasicBlock*> MemorySSA::GetUniquePredecessors(BasicBlock* block) {
+  std::vector<BasicBlock*> preds;
+  if (block == &*block->GetParent()->begin()) {
+    return preds;
+  }
+
+  std::unordered_set<uint32_t> seen_preds;
+  for (uint32_t pred_id : context_->cfg()->preds(block->id())) {
+    if (seen_preds.insert(pred_id).second) {
+      preds.push_back(context_->get_instr_block(pred_id));
+    }
+  }
+  return preds;
+}
+
+MemoryAccess* MemorySSA::GetDefAtExit(uint32_t var_id, BasicBlock* block) {
+  auto it = last_def_in_block_.find(BlockKey(block, var_id));
+  if (it != last_def_in_block_.end()) {
+    return it->second;
+  }
+  return GetDefAtEntry(var_id, block);
+}
+
+MemoryAccess* MemorySSA::TryRemoveTrivialPhi(MemoryAccess* phi) {
+  MemoryAccess* same = nullptr;
+  for (MemoryAccess* operand : phi->operands_) {
+    operand = Resolve(operand);
+    if (operand == same || operand == phi) {
+      continue;
+    }
+    if (same != nullptr) {
+      // The phi merges at least two definitions.
+      return phi;
+    }
+    same = operand;
+  }
+
+  if (same == nullptr) {
+    // Only the phi itself reaches the block, so it cannot be reached from the
+    // entry block.
+    same = live_on_entry_[phi->variable_id()];
+  }
+  phi->replacement_ = same;
+  return same;
+}
+
+MemoryAccess* MemorySSA::NewAccess(MemoryAccess::Kind kind,
+                                   uint32_t variable_id, Instruction* inst,
+                                   BasicBlock* block) {
+  accesses_.push_back(MakeUnique<MemoryAccess>(kind, variable_id, inst, block));
+  return accesses_.back().get();
+}
+
+}  // namespace opt
+}  // namespace spvtools
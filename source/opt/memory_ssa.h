@@ -0,0 +1,200 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_MEMORY_SSA_H_
+#define SOURCE_OPT_MEMORY_SSA_H_
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "source/opt/basic_block.h"
+#include "source/opt/instruction.h"
+
+namespace spvtools {
+namespace opt {
+
+class IRContext;
+
+// A point in a function where the contents of a variable are defined.  It is
+// either the initial contents of the variable, a store to the variable, or a
+// merge of the definitions reaching a block from its predecessors.
+class MemoryAccess {
+ public:
+  enum Kind {
+    // The contents of the variable when the function is entered: its
+    // initializer if it has one, and undefined otherwise.
+    kLiveOnEntry,
+    // An OpStore to the variable.
+    kDef,
+    // A merge of the definitions coming from the predecessors of a block.
+    kPhi,
+  };
+
+  MemoryAccess(Kind kind, uint32_t variable_id, Instruction* inst,
+               BasicBlock* block)
+      : kind_(kind),
+        variable_id_(variable_id),
+        inst_(inst),
+        block_(block),
+        replacement_(nullptr) {}
+
+  Kind kind() const { return kind_; }
+
+  // Returns the id of the variable that is defined.
+  uint32_t variable_id() const { return variable_id_; }
+
+  // Returns the OpStore for a def, the OpVariable for the initial contents,
+  // and nullptr for a phi.
+  Instruction* instruction() const { return inst_; }
+
+  // Returns the block containing the access.  For the initial contents, this
+  // is the entry block of the function.
+  BasicBlock* block() const { return block_; }
+
+  // Returns the definitions coming from each predecessor of the block of a
+  // phi.  The definitions are in the same order as the unique predecessors
+  // of the block in the CFG.
+  const std::vector<MemoryAccess*>& operands() const { return operands_; }
+
+ private:
+  friend class MemorySSA;
+
+  Kind kind_;
+  uint32_t variable_id_;
+  Instruction* inst_;
+  BasicBlock* block_;
+  std::vector<MemoryAccess*> operands_;
+
+  // A phi whose operands are all the same definition is replaced by that
+  // definition.  Queries look through replaced phis.
+  MemoryAccess* replacement_;
+};
+
+// This class links the loads of function scope variables to the stores whose
+// value they read, in the style of memory SSA.  Each OpStore is a definition
+// of the contents of its variable, and a phi is created where definitions of
+// the same variable meet.  The definition reaching a load is computed the
+// first time it is requested and cached, so later queries take constant time.
+//
+// Only variables in the Function storage class whose only uses are OpLoad,
+// OpStore to the variable, names, and decorations are modeled.  Any other
+// use, such as an access chain or passing the variable to a function, could
+// change the contents in ways that are not seen here.
+//
+// The analysis depends on the CFG.  Loads can be added or removed, and the
+// values they produce replaced, without invalidating it, as long as RemoveLoad
+// is called for removed loads.  IRContext::KillInst does so.  Adding or
+// removing a store to a modeled variable invalidates it.
+class MemorySSA {
+ public:
+  explicit MemorySSA(IRContext* context);
+
+  MemorySSA(const MemorySSA&) = delete;
+  MemorySSA& operator=(const MemorySSA&) = delete;
+
+  // Returns true if the loads and stores of the variable |var_id| are
+  // modeled by this analysis.
+  bool IsModeledVariable(uint32_t var_id) const {
+    return modeled_variables_.count(var_id) != 0;
+  }
+
+  // Returns the definition whose value is read by |load|, or nullptr if
+  // |load| is not a load from a modeled variable.  The result may be a phi.
+  MemoryAccess* GetReachingDef(Instruction* load);
+
+  // Adds to |stores| the stores whose value may be read by |load|.  Returns
+  // true if the value read may also be the initial contents of the variable,
+  // or if |load| does not read a modeled variable.
+  bool GetReachingStores(Instruction* load, std::vector<Instruction*>* stores);
+
+  // Returns the store whose value is always read by |load|, or nullptr if the
+  // value may come from more than one store or from the initial contents.
+  Instruction* GetUniqueReachingStore(Instruction* load);
+
+  // Forgets the cached definition for |load|.  Must be called before |load|
+  // is deleted.
+  void RemoveLoad(Instruction* load) { load_to_def_.erase(load); }
+
+ private:
+  // Returns |access| after looking through the phis that have been replaced.
+  static MemoryAccess* Resolve(MemoryAccess* access);
+
+  // Returns the key used in the per block maps for |block| and |var_id|.
+  static uint64_t BlockKey(const BasicBlock* block, uint32_t var_id) {
+    return (static_cast<uint64_t>(block->id()) << 32) | var_id;
+  }
+
+  // Finds the variables that can be modeled and the last store to each of
+  // them in every block.
+  void Analyze();
+
+  // Computes the definition read by every load of a modeled variable in
+  // |block|.
+  void AnalyzeLoadsInBlock(BasicBlock* block);
+
+  // Returns the definition of |var_id| at the start of |block|.
+  MemoryAccess* GetDefAtEntry(uint32_t var_id, BasicBlock* block);
+
+  // Returns the definition of |var_id| at the start of |block|, which has the
+  // predecessors |preds|, creating a phi if different definitions reach it.
+  MemoryAccess* CreatePhi(uint32_t var_id, BasicBlock* block,
+                          const std::vector<BasicBlock*>& preds);
+
+  // Returns the predecessors of |block| without duplicates, in the order of
+  // the CFG.  The entry block has no predecessors.
+  std::vector<BasicBlock*> GetUniquePredecessors(BasicBlock* block);
+
+  // Returns the definition of |var_id| at the end of |block|.
+  MemoryAccess* GetDefAtExit(uint32_t var_id, BasicBlock* block);
+
+  // Replaces |phi| by its only operand if all of its operands, other than
+  // itself, are the same definition.  Returns the definition to use in place
+  // of |phi|.
+  MemoryAccess* TryRemoveTrivialPhi(MemoryAccess* phi);
+
+  // Returns a new access owned by this analysis.
+  MemoryAccess* NewAccess(MemoryAccess::Kind kind, uint32_t variable_id,
+                          Instruction* inst, BasicBlock* block);
+
+  IRContext* context_;
+
+  // The variables whose loads and stores are modeled.
+  std::unordered_set<uint32_t> modeled_variables_;
+
+  // Owns all of the accesses.
+  std::vector<std::unique_ptr<MemoryAccess>> accesses_;
+
+  // The definition for each store to a modeled variable.
+  std::unordered_map<const Instruction*, MemoryAccess*> store_to_def_;
+
+  // The definition of a variable at the end of a block that stores to it.
+  std::unordered_map<uint64_t, MemoryAccess*> last_def_in_block_;
+
+  // The definition of a variable at the start of a block, once computed.
+  std::unordered_map<uint64_t, MemoryAccess*> def_at_entry_;
+
+  // The initial contents of each modeled variable.
+  std::unordered_map<uint32_t, MemoryAccess*> live_on_entry_;
+
+  // The definition read by each load, once computed.
+  std::unordered_map<const Instruction*, MemoryAccess*> load_to_def_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_MEMORY_SSA_H_
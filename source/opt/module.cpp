@@ -37,6 +37,54 @@ uint32_t Module::TakeNextIdBound() {
   return header_.bound++;
 }
 
+Module* Module::Clone(IRContext* ctx) const {
+  Module* clone = new Module();
+  clone->header_ = header_;
+
+  auto clone_list = [ctx](const InstructionList& from, InstructionList* to) {
+    for (const auto& inst : from) {
+      to->push_back(std::unique_ptr<Instruction>(inst.Clone(ctx)));
+    }
+  };
+  clone_list(capabilities_, &clone->capabilities_);
+  clone_list(extensions_, &clone->extensions_);
+  clone_list(ext_inst_imports_, &clone->ext_inst_imports_);
+  if (memory_model_) {
+    clone->memory_model_.reset(memory_model_->Clone(ctx));
+  }
+  clone_list(entry_points_, &clone->entry_points_);
+  clone_list(execution_modes_, &clone->execution_modes_);
+  clone_list(debugs1_, &clone->debugs1_);
+  clone_list(debugs2_, &clone->debugs2_);
+  clone_list(debugs3_, &clone->debugs3_);
+  clone_list(ext_inst_debuginfo_, &clone->ext_inst_debuginfo_);
+  clone_list(annotations_, &clone->annotations_);
+  clone_list(types_values_, &clone->types_values_);
+
+  clone->functions_.reserve(functions_.size());
+  for (const auto& func : functions_) {
+    clone->functions_.emplace_back(func->Clone(ctx));
+  }
+
+  clone->trailing_dbg_line_info_.reserve(trailing_dbg_line_info_.size());
+  for (const auto& line : trailing_dbg_line_info_) {
+    std::unique_ptr<Instruction> line_clone(line.Clone(ctx));
+    clone->trailing_dbg_line_info_.push_back(std::move(*line_clone));
+  }
+
+  clone->contains_debug_scope_ = contains_debug_scope_;
+  clone->contains_opencl_100_debug_insts_ = contains_opencl_100_debug_insts_;
+  if (debug_info_none_) {
+    for (auto& inst : clone->ext_inst_debuginfo_) {
+      if (inst.result_id() == debug_info_none_->result_id()) {
+        clone->debug_info_none_ = &inst;
+        break;
+      }
+    }
+  }
+  return clone;
+}
+
 std::vector<Instruction*> Module::GetTypes() {
   std::vector<Instruction*> type_insts;
   for (auto& inst : types_values_) {
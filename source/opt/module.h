@@ -55,6 +55,12 @@ class Module {
         contains_opencl_100_debug_insts_(false),
         debug_info_none_(nullptr) {}
 
+  // Returns a deep copy of this module whose instructions belong to |ctx|.  The
+  // instructions keep their result ids, so the clone is identical to this
+  // module when serialized.  The caller is responsible for associating the
+  // clone with |ctx|.
+  Module* Clone(IRContext* ctx) const;
+
   // Sets the header to the given |header|.
   void SetHeader(const ModuleHeader& header) { header_ = header; }
 
@@ -15,6 +15,7 @@
 #include "spirv-tools/optimizer.hpp"
 
 #include <cassert>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -229,6 +230,108 @@ Optimizer& Optimizer::RegisterSizePasses() {
       .RegisterPass(CreateCFGCleanupPass());
 }
 
+namespace {
+
+// Returns a factory that creates the pass held by the token returned by
+// |create|.  Used to build the groups of passes that are iterated to a fixed
+// point, since each iteration needs a new instance of the pass.
+opt::FixedPointPassGroup::PassFactory Factory(
+    std::function<Optimizer::PassToken()> create) {
+  return [create]() { return std::move(create().impl_->pass); };
+}
+
+// Returns a token for a group of passes, created by |factories|, that is
+// iterated until the module stops changing.
+Optimizer::PassToken CreateFixedPointPassGroup(
+    std::vector<opt::FixedPointPassGroup::PassFactory> factories) {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::FixedPointPassGroup>(std::move(factories)));
+}
+
+}  // namespace
+
+Optimizer& Optimizer::RegisterFixedPointPerformancePasses() {
+  // Promote memory to SSA values until nothing more can be promoted.
+  std::vector<opt::FixedPointPassGroup::PassFactory> memory_group = {
+      Factory(CreateLocalSingleBlockLoadStoreElimPass),
+      Factory(CreateLocalSingleStoreElimPass),
+      Factory(CreateAggressiveDCEPass),
+      Factory([]() { return CreateScalarReplacementPass(); }),
+      Factory(CreateLocalAccessChainConvertPass),
+      Factory(CreateLocalMultiStoreElimPass),
+      Factory(CreateAggressiveDCEPass)};
+
+  // Clean up the SSA form until it stops changing.
+  std::vector<opt::FixedPointPassGroup::PassFactory> cleanup_group = {
+      Factory(CreateCCPPass),
+      Factory(CreateAggressiveDCEPass),
+      Factory(CreateRedundancyEliminationPass),
+      Factory(CreateCombineAccessChainsPass),
+      Factory(CreateSimplificationPass),
+      Factory(CreateVectorDCEPass),
+      Factory(CreateDeadInsertElimPass),
+      Factory(CreateDeadBranchElimPass),
+      Factory(CreateIfConversionPass),
+      Factory(CreateCopyPropagateArraysPass),
+      Factory(CreateReduceLoadSizePass),
+      Factory(CreateAggressiveDCEPass),
+      Factory(CreateBlockMergePass)};
+
+  return RegisterPass(CreateWrapOpKillPass())
+      .RegisterPass(CreateDeadBranchElimPass())
+      .RegisterPass(CreateMergeReturnPass())
+      .RegisterPass(CreateInlineExhaustivePass())
+      .RegisterPass(CreateAggressiveDCEPass())
+      .RegisterPass(CreatePrivateToLocalPass())
+      .RegisterPass(CreateFixedPointPassGroup(std::move(memory_group)))
+      .RegisterPass(CreateFixedPointPassGroup(std::move(cleanup_group)));
+}
+
+Optimizer& Optimizer::RegisterFixedPointSizePasses() {
+  // Promote memory to SSA values, and unroll the loops whose trip count
+  // becomes known.
+  std::vector<opt::FixedPointPassGroup::PassFactory> memory_group = {
+      Factory([]() { return CreateScalarReplacementPass(0); }),
+      Factory(CreateLocalMultiStoreElimPass),
+      Factory(CreateCCPPass),
+      Factory([]() { return CreateLoopUnrollPass(true); }),
+      Factory(CreateDeadBranchElimPass),
+      Factory(CreateSimplificationPass)};
+
+  // Clean up the SSA form until it stops changing.
+  std::vector<opt::FixedPointPassGroup::PassFactory> cleanup_group = {
+      Factory([]() { return CreateScalarReplacementPass(0); }),
+      Factory(CreateLocalSingleStoreElimPass),
+      Factory(CreateIfConversionPass),
+      Factory(CreateSimplificationPass),
+      Factory(CreateAggressiveDCEPass),
+      Factory(CreateDeadBranchElimPass),
+      Factory(CreateBlockMergePass),
+      Factory(CreateLocalAccessChainConvertPass),
+      Factory(CreateLocalSingleBlockLoadStoreElimPass),
+      Factory(CreateAggressiveDCEPass),
+      Factory(CreateCopyPropagateArraysPass),
+      Factory(CreateVectorDCEPass),
+      Factory(CreateDeadInsertElimPass),
+      Factory(CreateEliminateDeadMembersPass),
+      Factory(CreateLocalSingleStoreElimPass),
+      Factory(CreateBlockMergePass),
+      Factory(CreateLocalMultiStoreElimPass),
+      Factory(CreateRedundancyEliminationPass),
+      Factory(CreateSimplificationPass),
+      Factory(CreateAggressiveDCEPass)};
+
+  return RegisterPass(CreateWrapOpKillPass())
+      .RegisterPass(CreateDeadBranchElimPass())
+      .RegisterPass(CreateMergeReturnPass())
+      .RegisterPass(CreateInlineExhaustivePass())
+      .RegisterPass(CreateEliminateDeadFunctionsPass())
+      .RegisterPass(CreatePrivateToLocalPass())
+      .RegisterPass(CreateFixedPointPassGroup(std::move(memory_group)))
+      .RegisterPass(CreateFixedPointPassGroup(std::move(cleanup_group)))
+      .RegisterPass(CreateCFGCleanupPass());
+}
+
 Optimizer& Optimizer::RegisterVulkanToWebGPUPasses() {
   return RegisterPass(CreateStripAtomicCounterMemoryPass())
       .RegisterPass(CreateGenerateWebGPUInitializersPass())
@@ -491,6 +594,10 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
     RegisterPerformancePasses();
   } else if (pass_name == "Os") {
     RegisterSizePasses();
+  } else if (pass_name == "fixed-point-O") {
+    RegisterFixedPointPerformancePasses();
+  } else if (pass_name == "fixed-point-Os") {
+    RegisterFixedPointSizePasses();
   } else if (pass_name == "legalize-hlsl") {
     RegisterLegalizationPasses();
   } else if (pass_name == "generate-webgpu-initializers") {
@@ -507,6 +614,74 @@ bool Optimizer::RegisterPassFromFlag(const std::string& flag) {
     RegisterPass(CreateWrapOpKillPass());
   } else if (pass_name == "amd-ext-to-khr") {
     RegisterPass(CreateAmdExtToKhrPass());
+  } else if (pass_name == "partial-redundancy-elimination") {
+    RegisterPass(CreatePartialRedundancyEliminationPass());
+  } else if (pass_name == "eliminate-dead-stores") {
+    RegisterPass(CreateDeadStoreElimPass());
+  } else if (pass_name == "value-range-propagation") {
+    RegisterPass(CreateValueRangePropagationPass());
+  } else if (pass_name == "interprocedural-ccp") {
+    RegisterPass(CreateInterproceduralCCPPass());
+  } else if (pass_name == "specialize-functions") {
+    if (pass_args.size() == 0) {
+      RegisterPass(CreateFunctionSpecializationPass());
+    } else {
+      int max_growth = -1;
+      if (pass_args.find_first_not_of("0123456789") == std::string::npos) {
+        max_growth = atoi(pass_args.c_str());
+      }
+
+      if (max_growth >= 0) {
+        RegisterPass(CreateFunctionSpecializationPass(max_growth));
+      } else {
+        Error(consumer(), nullptr, {},
+              "--specialize-functions must have no arguments or a "
+              "non-negative integer argument");
+        return false;
+      }
+    }
+  } else if (pass_name == "slp-vectorize") {
+    RegisterPass(CreateSLPVectorizerPass());
+  } else if (pass_name == "loop-unroll-auto") {
+    if (pass_args.size() == 0) {
+      RegisterPass(CreateAutoLoopUnrollPass());
+    } else {
+      int max_unrolled_size = -1;
+      if (pass_args.find_first_not_of("0123456789") == std::string::npos) {
+        max_unrolled_size = atoi(pass_args.c_str());
+      }
+
+      if (max_unrolled_size >= 0) {
+        RegisterPass(CreateAutoLoopUnrollPass(max_unrolled_size));
+      } else {
+        Error(consumer(), nullptr, {},
+              "--loop-unroll-auto must have no arguments or a "
+              "non-negative integer argument");
+        return false;
+      }
+    }
+  } else if (pass_name == "schedule-instructions") {
+    RegisterPass(CreateInstructionSchedulingPass());
+  } else if (pass_name == "rematerialize") {
+    if (pass_args.size() == 0) {
+      RegisterPass(CreateRematerializationPass());
+    } else {
+      int max_registers = -1;
+      if (pass_args.find_first_not_of("0123456789") == std::string::npos) {
+        max_registers = atoi(pass_args.c_str());
+      }
+
+      if (max_registers >= 0) {
+        RegisterPass(CreateRematerializationPass(max_registers));
+      } else {
+        Error(consumer(), nullptr, {},
+              "--rematerialize must have no arguments or a non-negative "
+              "integer argument");
+        return false;
+      }
+    }
+  } else if (pass_name == "loop-strength-reduction") {
+    RegisterPass(CreateLoopStrengthReductionPass());
   } else {
     Errorf(consumer(), nullptr, {},
            "Unknown flag '--%s'. Use --help for a list of valid flags",
@@ -559,6 +734,7 @@ bool Optimizer::Run(const uint32_t* original_binary,
   context->set_max_id_bound(opt_options->max_id_bound_);
   context->set_preserve_bindings(opt_options->preserve_bindings_);
   context->set_preserve_spec_constants(opt_options->preserve_spec_constants_);
+  context->set_num_threads(opt_options->num_threads_);
 
   impl_->pass_manager.SetValidatorOptions(&opt_options->val_options_);
   impl_->pass_manager.SetTargetEnv(impl_->target_env);
@@ -606,6 +782,11 @@ Optimizer& Optimizer::SetTimeReport(std::ostream* out) {
   return *this;
 }
 
+Optimizer& Optimizer::SetProfileJson(std::ostream* out) {
+  impl_->pass_manager.SetProfileJson(out);
+  return *this;
+}
+
 Optimizer& Optimizer::SetValidateAfterAll(bool validate) {
   impl_->pass_manager.SetValidateAfterAll(validate);
   return *this;
@@ -965,4 +1146,55 @@ Optimizer::PassToken CreateAmdExtToKhrPass() {
       MakeUnique<opt::AmdExtensionToKhrPass>());
 }
 
+Optimizer::PassToken CreatePartialRedundancyEliminationPass() {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::PartialRedundancyEliminationPass>());
+}
+
+Optimizer::PassToken CreateDeadStoreElimPass() {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::DeadStoreElimPass>());
+}
+
+Optimizer::PassToken CreateValueRangePropagationPass() {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::ValueRangePropagationPass>());
+}
+
+Optimizer::PassToken CreateInterproceduralCCPPass() {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::CCPPass>(/* interprocedural = */ true));
+}
+
+Optimizer::PassToken CreateFunctionSpecializationPass(uint32_t max_growth) {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::FunctionSpecializationPass>(max_growth));
+}
+
+Optimizer::PassToken CreateSLPVectorizerPass() {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::SLPVectorizerPass>());
+}
+
+Optimizer::PassToken CreateAutoLoopUnrollPass(uint32_t max_unrolled_size,
+                                              uint32_t max_registers) {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::LoopUnroller>(max_unrolled_size, max_registers));
+}
+
+Optimizer::PassToken CreateInstructionSchedulingPass() {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::InstructionSchedulingPass>());
+}
+
+Optimizer::PassToken CreateRematerializationPass(uint32_t max_registers) {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::RematerializationPass>(max_registers));
+}
+
+Optimizer::PassToken CreateLoopStrengthReductionPass() {
+  return MakeUnique<Optimizer::PassToken::Impl>(
+      MakeUnique<opt::LoopStrengthReductionPass>());
+}
+
 }  // namespace spvtools
@@ -0,0 +1,344 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/partial_redundancy_elimination.h"
+
+#include <memory>
+#include <unordered_set>
+#include <utility>
+
+#include "source/opt/ir_builder.h"
+
+namespace spvtools {
+namespace opt {
+
+Pass::Status PartialRedundancyEliminationPass::Process() {
+  ValueNumberTable vn_table(context());
+
+  Status status = Status::SuccessWithoutChange;
+  for (auto& func : *get_module()) {
+    Status function_status = ProcessFunction(&func, vn_table);
+    if (function_status == Status::Failure) {
+      return Status::Failure;
+    }
+    if (function_status == Status::SuccessWithChange) {
+      status = Status::SuccessWithChange;
+    }
+  }
+  return status;
+}
+
+Pass::Status PartialRedundancyEliminationPass::ProcessFunction(
+    Function* function, const ValueNumberTable& vn_table) {
+  if (function->begin() == function->end()) {
+    return Status::SuccessWithoutChange;
+  }
+
+  ValueToInstructions value_to_insts;
+  for (auto& block : *function) {
+    for (auto& inst : block) {
+      if (IsCandidate(&inst) && vn_table.GetValueNumber(&inst) != 0) {
+        value_to_insts[vn_table.GetValueNumber(&inst)].push_back(&inst);
+      }
+    }
+  }
+
+  // Visit the blocks in reverse post order, so the values added to the
+  // predecessors of a block are available when the block is processed.
+  Status status = Status::SuccessWithoutChange;
+  context()->cfg()->ForEachBlockInReversePostOrder(
+      &*function->begin(),
+      [this, &vn_table, &value_to_insts, &status](BasicBlock* block) {
+        if (status == Status::Failure) {
+          return;
+        }
+        Status block_status = ProcessBlock(block, vn_table, &value_to_insts);
+        if (block_status != Status::SuccessWithoutChange) {
+          status = block_status;
+        }
+      });
+  return status;
+}
+
+Pass::Status PartialRedundancyEliminationPass::ProcessBlock(
+    BasicBlock* block, const ValueNumberTable& vn_table,
+    ValueToInstructions* value_to_insts) {
+  std::vector<BasicBlock*> preds;
+  std::unordered_set<uint32_t> seen_preds;
+  for (uint32_t pred_id : context()->cfg()->preds(block->id())) {
+    if (seen_preds.insert(pred_id).second) {
+      preds.push_back(context()->get_instr_block(pred_id));
+    }
+  }
+  if (preds.size() < 2) {
+    return Status::SuccessWithoutChange;
+  }
+
+  DominatorAnalysis* dom_analysis =
+      context()->GetDominatorAnalysis(block->GetParent());
+  Status status = Status::SuccessWithoutChange;
+  std::unordered_set<uint32_t> values_in_block;
+  for (auto inst = block->begin(); inst != block->end();) {
+    Instruction* current_inst = &*inst;
+    ++inst;
+
+    if (!IsCandidate(current_inst)) {
+      continue;
+    }
+
+    // Only the first instruction computing a value in the block can be
+    // partially redundant.  The others are fully redundant.  Instructions
+    // added by this pass have no value number.
+    uint32_t value = vn_table.GetValueNumber(current_inst);
+    if (value == 0 || !values_in_block.insert(value).second) {
+      continue;
+    }
+
+    if (!OperandsDominate(current_inst, block)) {
+      continue;
+    }
+
+    std::vector<Instruction*>& candidates = (*value_to_insts)[value];
+    bool fully_redundant = false;
+    for (Instruction* candidate : candidates) {
+      BasicBlock* candidate_block = context()->get_instr_block(candidate);
+      if (candidate_block != block &&
+          dom_analysis->Dominates(candidate_block, block)) {
+        fully_redundant = true;
+        break;
+      }
+    }
+    if (fully_redundant) {
+      continue;
+    }
+
+    // Find the value at the end of each predecessor.  A copy of
+    // |current_inst| can only be added to a predecessor that always branches
+    // to |block|.
+    std::vector<Instruction*> available(preds.size(), nullptr);
+    bool any_available = false;
+    bool can_insert = true;
+    for (size_t i = 0; i < preds.size(); ++i) {
+      available[i] = FindAvailable(candidates, block, preds[i]);
+      if (available[i] != nullptr) {
+        any_available = true;
+      } else if (preds[i] == block ||
+                 preds[i]->terminator()->opcode() != SpvOpBranch) {
+        can_insert = false;
+      }
+    }
+    if (!any_available || !can_insert) {
+      continue;
+    }
+
+    std::vector<uint32_t> incomings;
+    for (size_t i = 0; i < preds.size(); ++i) {
+      if (available[i] == nullptr) {
+        uint32_t copy_id = TakeNextId();
+        if (copy_id == 0) {
+          return Status::Failure;
+        }
+        std::unique_ptr<Instruction> copy(current_inst->Clone(context()));
+        copy->SetResultId(copy_id);
+
+        Instruction* insert_before = preds[i]->GetMergeInst();
+        if (insert_before == nullptr) {
+          insert_before = preds[i]->terminator();
+        }
+        InstructionBuilder builder(
+            context(), insert_before,
+            IRContext::kAnalysisDefUse |
+                IRContext::kAnalysisInstrToBlockMapping);
+        available[i] = builder.AddInstruction(std::move(copy));
+        context()->get_decoration_mgr()->CloneDecorations(
+            current_inst->result_id(), copy_id);
+        candidates.push_back(available[i]);
+      }
+      incomings.push_back(available[i]->result_id());
+      incomings.push_back(preds[i]->id());
+    }
+
+    uint32_t phi_id = TakeNextId();
+    if (phi_id == 0) {
+      return Status::Failure;
+    }
+    InstructionBuilder builder(
+        context(), &*block->begin(),
+        IRContext::kAnalysisDefUse | IRContext::kAnalysisInstrToBlockMapping);
+    Instruction* phi = builder.AddPhi(current_inst->type_id(), incomings,
+                                      phi_id);
+    context()->get_decoration_mgr()->CloneDecorations(
+        current_inst->result_id(), phi_id);
+
+    for (auto it = candidates.begin(); it != candidates.end(); ++it) {
+      if (*it == current_inst) {
+        candidates.erase(it);
+        break;
+      }
+    }
+    candidates.push_back(phi);
+
+    context()->KillNamesAndDecorates(current_inst);
+    context()->ReplaceAllUsesWith(current_inst->result_id(), phi_id);
+    context()->KillInst(current_inst);
+    status = Status::SuccessWithChange;
+  }
+  return status;
+}
+
+bool PartialRedundancyEliminationPass::IsCandidate(
+    const Instruction* inst) const {
+  if (inst->result_id() == 0 || inst->type_id() == 0) {
+    return false;
+  }
+
+  // Only pure computations on their operands are moved.  Loads, image
+  // operations, derivatives and anything else that depends on memory or on
+  // the invocation must stay where they are.
+  switch (inst->opcode()) {
+    // Arithmetic.
+    case SpvOpSNegate:
+    case SpvOpFNegate:
+    case SpvOpIAdd:
+    case SpvOpFAdd:
+    case SpvOpISub:
+    case SpvOpFSub:
+    case SpvOpIMul:
+    case SpvOpFMul:
+    case SpvOpUDiv:
+    case SpvOpSDiv:
+    case SpvOpFDiv:
+    case SpvOpUMod:
+    case SpvOpSRem:
+    case SpvOpSMod:
+    case SpvOpFRem:
+    case SpvOpFMod:
+    case SpvOpVectorTimesScalar:
+    case SpvOpMatrixTimesScalar:
+    case SpvOpVectorTimesMatrix:
+    case SpvOpMatrixTimesVector:
+    case SpvOpMatrixTimesMatrix:
+    case SpvOpOuterProduct:
+    case SpvOpDot:
+    case SpvOpIAddCarry:
+    case SpvOpISubBorrow:
+    case SpvOpUMulExtended:
+    case SpvOpSMulExtended:
+    // Bit operations.
+    case SpvOpShiftRightLogical:
+    case SpvOpShiftRightArithmetic:
+    case SpvOpShiftLeftLogical:
+    case SpvOpBitwiseOr:
+    case SpvOpBitwiseXor:
+    case SpvOpBitwiseAnd:
+    case SpvOpNot:
+    case SpvOpBitFieldInsert:
+    case SpvOpBitFieldSExtract:
+    case SpvOpBitFieldUExtract:
+    case SpvOpBitReverse:
+    case SpvOpBitCount:
+    // Logical operations and comparisons.
+    case SpvOpAny:
+    case SpvOpAll:
+    case SpvOpIsNan:
+    case SpvOpIsInf:
+    case SpvOpLogicalEqual:
+    case SpvOpLogicalNotEqual:
+    case SpvOpLogicalOr:
+    case SpvOpLogicalAnd:
+    case SpvOpLogicalNot:
+    case SpvOpSelect:
+    case SpvOpIEqual:
+    case SpvOpINotEqual:
+    case SpvOpUGreaterThan:
+    case SpvOpSGreaterThan:
+    case SpvOpUGreaterThanEqual:
+    case SpvOpSGreaterThanEqual:
+    case SpvOpULessThan:
+    case SpvOpSLessThan:
+    case SpvOpULessThanEqual:
+    case SpvOpSLessThanEqual:
+    case SpvOpFOrdEqual:
+    case SpvOpFUnordEqual:
+    case SpvOpFOrdNotEqual:
+    case SpvOpFUnordNotEqual:
+    case SpvOpFOrdLessThan:
+    case SpvOpFUnordLessThan:
+    case SpvOpFOrdGreaterThan:
+    case SpvOpFUnordGreaterThan:
+    case SpvOpFOrdLessThanEqual:
+    case SpvOpFUnordLessThanEqual:
+    case SpvOpFOrdGreaterThanEqual:
+    case SpvOpFUnordGreaterThanEqual:
+    // Conversions.
+    case SpvOpConvertFToU:
+    case SpvOpConvertFToS:
+    case SpvOpConvertSToF:
+    case SpvOpConvertUToF:
+    case SpvOpUConvert:
+    case SpvOpSConvert:
+    case SpvOpFConvert:
+    case SpvOpQuantizeToF16:
+    case SpvOpBitcast:
+    // Composites.
+    case SpvOpVectorExtractDynamic:
+    case SpvOpVectorInsertDynamic:
+    case SpvOpVectorShuffle:
+    case SpvOpCompositeConstruct:
+    case SpvOpCompositeExtract:
+    case SpvOpCompositeInsert:
+    case SpvOpCopyObject:
+    case SpvOpTranspose:
+      break;
+    default:
+      return false;
+  }
+
+  // Pointers and opaque values cannot always be merged with an OpPhi.
+  const analysis::Type* type =
+      context()->get_type_mgr()->GetType(inst->type_id());
+  return type != nullptr && type->AsPointer() == nullptr &&
+         type->AsImage() == nullptr && type->AsSampler() == nullptr &&
+         type->AsSampledImage() == nullptr;
+}
+
+bool PartialRedundancyEliminationPass::OperandsDominate(
+    const Instruction* inst, BasicBlock* block) const {
+  DominatorAnalysis* dom_analysis =
+      context()->GetDominatorAnalysis(block->GetParent());
+  return inst->WhileEachInId([this, block, dom_analysis](const uint32_t* id) {
+    Instruction* def = get_def_use_mgr()->GetDef(*id);
+    BasicBlock* def_block = context()->get_instr_block(def);
+    return def_block == nullptr ||
+           (def_block != block && dom_analysis->Dominates(def_block, block));
+  });
+}
+
+Instruction* PartialRedundancyEliminationPass::FindAvailable(
+    const std::vector<Instruction*>& candidates, BasicBlock* block,
+    BasicBlock* pred) const {
+  DominatorAnalysis* dom_analysis =
+      context()->GetDominatorAnalysis(block->GetParent());
+  for (Instruction* candidate : candidates) {
+    BasicBlock* candidate_block = context()->get_instr_block(candidate);
+    if (candidate_block != block &&
+        dom_analysis->Dominates(candidate_block, pred)) {
+      return candidate;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,87 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_PARTIAL_REDUNDANCY_ELIMINATION_H_
+#define SOURCE_OPT_PARTIAL_REDUNDANCY_ELIMINATION_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "source/opt/ir_context.h"
+#include "source/opt/pass.h"
+#include "source/opt/value_number_table.h"
+
+namespace spvtools {
+namespace opt {
+
+// This pass implements partial redundancy elimination based on global value
+// numbering.  An instruction in a block with several predecessors is
+// partially redundant if the value it computes is already available at the
+// end of some, but not all, of the predecessors.  The pass computes the value
+// at the end of the predecessors where it is missing, and replaces the
+// instruction by an OpPhi of the values coming from every predecessor.  The
+// value is then computed once on every path instead of twice on some.
+//
+// Copies are only added to predecessors whose single successor is the block,
+// so no path computes the value more often than before.  Instructions that
+// are fully redundant, that is dominated by an instruction computing the same
+// value, are left to the redundancy elimination pass.
+class PartialRedundancyEliminationPass : public Pass {
+ public:
+  const char* name() const override { return "partial-redundancy-elimination"; }
+  Status Process() override;
+
+  IRContext::Analysis GetPreservedAnalyses() override {
+    return IRContext::kAnalysisDefUse |
+           IRContext::kAnalysisInstrToBlockMapping |
+           IRContext::kAnalysisDecorations | IRContext::kAnalysisCombinators |
+           IRContext::kAnalysisCFG | IRContext::kAnalysisDominatorAnalysis |
+           IRContext::kAnalysisNameMap | IRContext::kAnalysisConstants |
+           IRContext::kAnalysisTypes;
+  }
+
+ private:
+  // A map from value numbers to the instructions in the current function that
+  // compute that value and can be reused.
+  using ValueToInstructions =
+      std::unordered_map<uint32_t, std::vector<Instruction*>>;
+
+  // Eliminates the partial redundancies in |function|.
+  Status ProcessFunction(Function* function, const ValueNumberTable& vn_table);
+
+  // Eliminates the partially redundant instructions in |block|.
+  // |value_to_insts| is updated with the instructions that are added and
+  // removed.
+  Status ProcessBlock(BasicBlock* block, const ValueNumberTable& vn_table,
+                      ValueToInstructions* value_to_insts);
+
+  // Returns true if |inst| computes a value that may be computed in another
+  // block and merged with an OpPhi.
+  bool IsCandidate(const Instruction* inst) const;
+
+  // Returns true if the definitions of all of the ids used by |inst| strictly
+  // dominate |block|, so they are available at the end of every predecessor of
+  // |block|.
+  bool OperandsDominate(const Instruction* inst, BasicBlock* block) const;
+
+  // Returns an instruction in |candidates| other than those in |block| whose
+  // value is available at the end of |pred|, or nullptr if there is none.
+  Instruction* FindAvailable(const std::vector<Instruction*>& candidates,
+                             BasicBlock* block, BasicBlock* pred) const;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_PARTIAL_REDUNDANCY_ELIMINATION_H_
@@ -14,6 +14,9 @@
 
 #include "source/opt/pass_manager.h"
 
+#include <chrono>
+#include <ctime>
+#include <iomanip>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -25,6 +28,249 @@
 namespace spvtools {
 
 namespace opt {
+namespace {
+
+// The size of the module at one point in the pass pipeline.
+struct ModuleSize {
+  uint32_t instructions = 0;
+  uint32_t blocks = 0;
+  uint32_t functions = 0;
+  uint32_t id_bound = 0;
+};
+
+// The profile of a single run of a pass.
+struct PassProfile {
+  std::string name;
+  Pass::Status status = Pass::Status::SuccessWithoutChange;
+  // Resource utilization.  A negative value means the resource could not be
+  // measured.
+  double wall_time = -1;
+  double cpu_time = -1;
+  long rss_delta = -1;
+  long page_faults = -1;
+  ModuleSize before;
+  ModuleSize after;
+  // The analyses that were valid before the pass ran.
+  IRContext::Analysis valid_before = IRContext::kAnalysisNone;
+  // The analyses that were valid after the pass ran.
+  IRContext::Analysis valid_after = IRContext::kAnalysisNone;
+};
+
+ModuleSize ComputeModuleSize(IRContext* context) {
+  ModuleSize size;
+  const Module* module = context->module();
+  module->ForEachInst([&size](const Instruction*) { ++size.instructions; });
+  for (const auto& fn : *module) {
+    ++size.functions;
+    for (auto bb = fn.cbegin(); bb != fn.cend(); ++bb) {
+      ++size.blocks;
+    }
+  }
+  size.id_bound = module->id_bound();
+  return size;
+}
+
+IRContext::Analysis GetValidAnalyses(IRContext* context) {
+  IRContext::Analysis valid = IRContext::kAnalysisNone;
+  for (IRContext::Analysis a = IRContext::kAnalysisBegin;
+       a < IRContext::kAnalysisEnd; a <<= 1) {
+    if (context->AreAnalysesValid(a)) valid |= a;
+  }
+  return valid;
+}
+
+const char* GetAnalysisName(IRContext::Analysis a) {
+  switch (a) {
+    case IRContext::kAnalysisDefUse:
+      return "def-use";
+    case IRContext::kAnalysisInstrToBlockMapping:
+      return "instr-to-block";
+    case IRContext::kAnalysisDecorations:
+      return "decorations";
+    case IRContext::kAnalysisCombinators:
+      return "combinators";
+    case IRContext::kAnalysisCFG:
+      return "cfg";
+    case IRContext::kAnalysisDominatorAnalysis:
+      return "dominators";
+    case IRContext::kAnalysisLoopAnalysis:
+      return "loops";
+    case IRContext::kAnalysisNameMap:
+      return "name-map";
+    case IRContext::kAnalysisScalarEvolution:
+      return "scalar-evolution";
+    case IRContext::kAnalysisRegisterPressure:
+      return "register-pressure";
+    case IRContext::kAnalysisValueNumberTable:
+      return "value-number-table";
+    case IRContext::kAnalysisStructuredCFG:
+      return "structured-cfg";
+    case IRContext::kAnalysisBuiltinVarId:
+      return "builtin-var-id";
+    case IRContext::kAnalysisIdToFuncMapping:
+      return "id-to-func";
+    case IRContext::kAnalysisConstants:
+      return "constants";
+    case IRContext::kAnalysisTypes:
+      return "types";
+    case IRContext::kAnalysisMemorySSA:
+      return "memory-ssa";
+    case IRContext::kAnalysisAliasAnalysis:
+      return "alias-analysis";
+    default:
+      return "unknown";
+  }
+}
+
+// Writes |str| to |out| as a JSON string literal.
+void WriteJsonString(std::ostream* out, const std::string& str) {
+  *out << '"';
+  for (char c : str) {
+    switch (c) {
+      case '"':
+        *out << "\\\"";
+        break;
+      case '\\':
+        *out << "\\\\";
+        break;
+      case '\n':
+        *out << "\\n";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          *out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+               << static_cast<int>(c) << std::dec << std::setfill(' ');
+        } else {
+          *out << c;
+        }
+    }
+  }
+  *out << '"';
+}
+
+// Writes the analyses that are in |set| as a JSON array of names.
+void WriteJsonAnalyses(std::ostream* out, uint32_t set) {
+  *out << "[";
+  bool first = true;
+  for (IRContext::Analysis a = IRContext::kAnalysisBegin;
+       a < IRContext::kAnalysisEnd; a <<= 1) {
+    if ((set & a) == 0) continue;
+    if (!first) *out << ", ";
+    first = false;
+    WriteJsonString(out, GetAnalysisName(a));
+  }
+  *out << "]";
+}
+
+// Writes a "before"/"after" pair as a JSON object.
+void WriteJsonDelta(std::ostream* out, uint32_t before, uint32_t after) {
+  *out << "{\"before\": " << before << ", \"after\": " << after << "}";
+}
+
+// Writes |value| to |out|, or null if it is negative (i.e., not measured).
+template <typename T>
+void WriteJsonMeasure(std::ostream* out, T value) {
+  if (value < 0) {
+    *out << "null";
+  } else {
+    *out << value;
+  }
+}
+
+// Writes |profiles| as a JSON object to |out|.
+void WriteJsonProfile(std::ostream* out,
+                      const std::vector<PassProfile>& profiles) {
+  *out << "{\n  \"passes\": [";
+  for (size_t i = 0; i < profiles.size(); ++i) {
+    const PassProfile& p = profiles[i];
+    *out << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+    WriteJsonString(out, p.name);
+    *out << ", \"status\": ";
+    switch (p.status) {
+      case Pass::Status::Failure:
+        *out << "\"failure\"";
+        break;
+      case Pass::Status::SuccessWithChange:
+        *out << "\"changed\"";
+        break;
+      case Pass::Status::SuccessWithoutChange:
+        *out << "\"unchanged\"";
+        break;
+    }
+    *out << ",\n     \"wall_time\": ";
+    WriteJsonMeasure(out, p.wall_time);
+    *out << ", \"cpu_time\": ";
+    WriteJsonMeasure(out, p.cpu_time);
+    *out << ", \"rss_delta\": ";
+    WriteJsonMeasure(out, p.rss_delta);
+    *out << ", \"page_faults\": ";
+    WriteJsonMeasure(out, p.page_faults);
+    *out << ",\n     \"instructions\": ";
+    WriteJsonDelta(out, p.before.instructions, p.after.instructions);
+    *out << ", \"blocks\": ";
+    WriteJsonDelta(out, p.before.blocks, p.after.blocks);
+    *out << ", \"functions\": ";
+    WriteJsonDelta(out, p.before.functions, p.after.functions);
+    *out << ", \"id_bound\": ";
+    WriteJsonDelta(out, p.before.id_bound, p.after.id_bound);
+    *out << ",\n     \"analyses_built\": ";
+    WriteJsonAnalyses(out, p.valid_after & ~p.valid_before);
+    *out << ", \"analyses_invalidated\": ";
+    WriteJsonAnalyses(out, p.valid_before & ~p.valid_after);
+    *out << "}";
+  }
+  *out << "\n  ]\n}" << std::endl;
+}
+
+// Runs |pass| on |context| and records its profile in |profile_out|.  The time
+// report is written to |time_report_stream| as usual if it is not null.
+Pass::Status RunPassWithProfile(Pass* pass, IRContext* context,
+                                std::ostream* time_report_stream,
+                                PassProfile* profile_out) {
+  PassProfile& profile = *profile_out;
+  profile.name = pass->name();
+  profile.before = ComputeModuleSize(context);
+  profile.valid_before = GetValidAnalyses(context);
+
+#if defined(SPIRV_TIMER_ENABLED)
+  // The timer only takes measurements when it is given a stream.  Nothing is
+  // written to it since Report() is never called.
+  utils::Timer timer(&std::cerr, /* measure_mem_usage = */ true);
+  timer.Start();
+#else
+  const auto wall_start = std::chrono::steady_clock::now();
+  const std::clock_t cpu_start = std::clock();
+#endif
+
+  {
+    SPIRV_TIMER_SCOPED(time_report_stream, pass->name(), true);
+    profile.status = pass->Run(context);
+  }
+
+#if defined(SPIRV_TIMER_ENABLED)
+  timer.Stop();
+  profile.wall_time = timer.WallTime();
+  profile.cpu_time = timer.CPUTime();
+  profile.rss_delta = timer.RSS();
+  profile.page_faults = timer.PageFault();
+#else
+  const std::clock_t cpu_end = std::clock();
+  const auto wall_end = std::chrono::steady_clock::now();
+  profile.wall_time =
+      std::chrono::duration<double>(wall_end - wall_start).count();
+  if (cpu_start != static_cast<std::clock_t>(-1) &&
+      cpu_end != static_cast<std::clock_t>(-1)) {
+    profile.cpu_time =
+        static_cast<double>(cpu_end - cpu_start) / CLOCKS_PER_SEC;
+  }
+#endif
+
+  profile.after = ComputeModuleSize(context);
+  profile.valid_after = GetValidAnalyses(context);
+  return profile.status;
+}
+
+}  // namespace
 
 Pass::Status PassManager::Run(IRContext* context) {
   auto status = Pass::Status::SuccessWithoutChange;
@@ -43,12 +289,32 @@ Pass::Status PassManager::Run(IRContext* context) {
     }
   };
 
+  // If profile_json_stream_ is not null, the profile of every pass that runs
+  // is collected here and written out once the pipeline stops.
+  std::vector<PassProfile> profiles;
+  auto write_profile = [&profiles, this]() {
+    if (profile_json_stream_) {
+      WriteJsonProfile(profile_json_stream_, profiles);
+    }
+  };
+
   SPIRV_TIMER_DESCRIPTION(time_report_stream_, /* measure_mem_usage = */ true);
   for (auto& pass : passes_) {
     print_disassembly("; IR before pass ", pass.get());
-    SPIRV_TIMER_SCOPED(time_report_stream_, (pass ? pass->name() : ""), true);
-    const auto one_status = pass->Run(context);
-    if (one_status == Pass::Status::Failure) return one_status;
+    Pass::Status one_status;
+    if (profile_json_stream_) {
+      profiles.emplace_back();
+      one_status = RunPassWithProfile(pass.get(), context, time_report_stream_,
+                                      &profiles.back());
+    } else {
+      SPIRV_TIMER_SCOPED(time_report_stream_, (pass ? pass->name() : ""),
+                         true);
+      one_status = pass->Run(context);
+    }
+    if (one_status == Pass::Status::Failure) {
+      write_profile();
+      return one_status;
+    }
     if (one_status == Pass::Status::SuccessWithChange) status = one_status;
 
     if (validate_after_all_) {
@@ -61,6 +327,7 @@ Pass::Status PassManager::Run(IRContext* context) {
         msg += pass->name();
         spv_position_t null_pos{0, 0, 0};
         consumer()(SPV_MSG_INTERNAL_ERROR, "", null_pos, msg.c_str());
+        write_profile();
         return Pass::Status::Failure;
       }
     }
@@ -69,6 +336,7 @@ Pass::Status PassManager::Run(IRContext* context) {
     pass.reset(nullptr);
   }
   print_disassembly("; IR after last pass", nullptr);
+  write_profile();
 
   // Set the Id bound in the header in case a pass forgot to do so.
   //
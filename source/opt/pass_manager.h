@@ -44,6 +44,7 @@ class PassManager {
       : consumer_(nullptr),
         print_all_stream_(nullptr),
         time_report_stream_(nullptr),
+        profile_json_stream_(nullptr),
         target_env_(SPV_ENV_UNIVERSAL_1_2),
         val_options_(nullptr),
         validate_after_all_(false) {}
@@ -92,6 +93,17 @@ class PassManager {
     return *this;
   }
 
+  // Sets the option to write a machine-readable profile of each pass, as a
+  // single JSON object, to |out| after the last pass has run.  For every pass
+  // the profile records the resource utilization (when timers are available),
+  // the instruction, block and function counts and the id bound before and
+  // after the pass, the analyses the pass built or invalidated, and the status
+  // it returned.  No output is generated if |out| is null.
+  PassManager& SetProfileJson(std::ostream* out) {
+    profile_json_stream_ = out;
+    return *this;
+  }
+
   // Sets the target environment for validation.
   PassManager& SetTargetEnv(spv_target_env env) {
     target_env_ = env;
@@ -121,6 +133,9 @@ class PassManager {
   // The output stream to write the resource utilization of each pass. If this
   // is null, no output is generated.
   std::ostream* time_report_stream_;
+  // The output stream to write the JSON profile of the passes to. If this is
+  // null, no profile is collected.
+  std::ostream* profile_json_stream_;
   // The target environment.
   spv_target_env target_env_;
   // The validator options (used when validating each pass).
@@ -14,9 +14,68 @@
 
 #include "source/opt/propagator.h"
 
+#include <algorithm>
+
 namespace spvtools {
 namespace opt {
 
+SSAPropagator::InstState& SSAPropagator::GetOrCreateState(
+    const Instruction* inst) {
+  uint32_t id = inst->unique_id();
+  if (id >= inst_states_.size()) {
+    inst_states_.resize(id + 1);
+  }
+  InstState& state = inst_states_[id];
+  if (state.run != run_) {
+    state = InstState();
+    state.run = run_;
+  }
+  return state;
+}
+
+SSAPropagator::BlockState* SSAPropagator::GetBlockState(
+    const BasicBlock* block) {
+  const SSAPropagator* self = this;
+  return const_cast<BlockState*>(self->GetBlockState(block));
+}
+
+const SSAPropagator::BlockState* SSAPropagator::GetBlockState(
+    const BasicBlock* block) const {
+  if (block == nullptr) {
+    return nullptr;
+  }
+  const InstState* state = GetState(block->GetLabelInst());
+  if (state == nullptr) {
+    return nullptr;
+  }
+  return &block_states_[state->block_index];
+}
+
+bool SSAPropagator::MarkEdgeExecutable(const Edge& edge) {
+  BlockState* dest = GetBlockState(edge.dest);
+  assert(dest != nullptr && "Edge into a block outside of the function.");
+  for (BasicBlock* pred : dest->executable_preds) {
+    if (pred == edge.source) {
+      return false;
+    }
+  }
+  dest->executable_preds.push_back(edge.source);
+  return true;
+}
+
+bool SSAPropagator::IsEdgeExecutable(const Edge& edge) const {
+  const BlockState* dest = GetBlockState(edge.dest);
+  if (dest == nullptr) {
+    return false;
+  }
+  for (BasicBlock* pred : dest->executable_preds) {
+    if (pred == edge.source) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void SSAPropagator::AddControlEdge(const Edge& edge) {
   BasicBlock* dest_bb = edge.dest;
 
@@ -33,7 +92,7 @@ void SSAPropagator::AddControlEdge(const Edge& edge) {
 
   // If the edge had not already been marked executable, add the destination
   // basic block to the work list.
-  blocks_.push(dest_bb);
+  blocks_.push_back(dest_bb);
 }
 
 void SSAPropagator::AddSSAEdges(Instruction* instr) {
@@ -52,7 +111,7 @@ void SSAPropagator::AddSSAEdges(Instruction* instr) {
         }
 
         if (ShouldSimulateAgain(use_instr)) {
-          ssa_edge_uses_.push(use_instr);
+          ssa_edge_uses_.push_back(use_instr);
         }
       });
 }
@@ -79,7 +138,11 @@ bool SSAPropagator::SetStatus(Instruction* inst, PropStatus status) {
          "Invalid lattice transition");
 
   bool status_changed = !has_old_status || (old_status != status);
-  if (status_changed) statuses_[inst] = status;
+  if (status_changed) {
+    InstState& state = GetOrCreateState(inst);
+    state.has_status = true;
+    state.status = status;
+  }
 
   return status_changed;
 }
@@ -108,7 +171,7 @@ bool SSAPropagator::Simulate(Instruction* instr) {
     // block.
     if (instr->IsBlockTerminator()) {
       BasicBlock* block = ctx_->get_instr_block(instr);
-      for (const auto& e : bb_succs_.at(block)) {
+      for (const auto& e : GetBlockState(block)->succs) {
         AddControlEdge(e);
       }
     }
@@ -198,8 +261,9 @@ bool SSAPropagator::Simulate(BasicBlock* block) {
 
     // If this block has exactly one successor, mark the edge to its successor
     // as executable.
-    if (bb_succs_.at(block).size() == 1) {
-      AddControlEdge(bb_succs_.at(block).at(0));
+    const std::vector<Edge>& succs = GetBlockState(block)->succs;
+    if (succs.size() == 1) {
+      AddControlEdge(succs[0]);
     }
   }
 
@@ -207,55 +271,63 @@ bool SSAPropagator::Simulate(BasicBlock* block) {
 }
 
 void SSAPropagator::Initialize(Function* fn) {
-  // Compute predecessor and successor blocks for every block in |fn|'s CFG.
-  // TODO(dnovillo): Move this to CFG and always build them. Alternately,
-  // move it to IRContext and build CFG preds/succs on-demand.
-  bb_succs_[ctx_->cfg()->pseudo_entry_block()].push_back(
-      Edge(ctx_->cfg()->pseudo_entry_block(), fn->entry().get()));
+  ++run_;
+  block_states_.clear();
+  blocks_.clear();
+  next_block_ = 0;
+  ssa_edge_uses_.clear();
+  next_ssa_edge_use_ = 0;
+
+  // Size the state table for every instruction in |fn| up front.
+  uint32_t max_unique_id = 0;
+  size_t num_insts = 0;
+  fn->ForEachInst([&max_unique_id, &num_insts](Instruction* inst) {
+    max_unique_id = std::max(max_unique_id, inst->unique_id());
+    ++num_insts;
+  });
+  if (max_unique_id >= inst_states_.size()) {
+    inst_states_.resize(max_unique_id + 1);
+  }
+  ssa_edge_uses_.reserve(num_insts);
 
+  // Compute the successor edges of every block in |fn|'s CFG.
   for (auto& block : *fn) {
+    GetOrCreateState(block.GetLabelInst()).block_index =
+        static_cast<uint32_t>(block_states_.size());
+    block_states_.emplace_back(&block);
+    BlockState& state = block_states_.back();
+
     const auto& const_block = block;
-    const_block.ForEachSuccessorLabel([this, &block](const uint32_t label_id) {
-      BasicBlock* succ_bb =
-          ctx_->get_instr_block(get_def_use_mgr()->GetDef(label_id));
-      bb_succs_[&block].push_back(Edge(&block, succ_bb));
-      bb_preds_[succ_bb].push_back(Edge(succ_bb, &block));
+    const_block.ForEachSuccessorLabel([this, &block,
+                                       &state](const uint32_t label_id) {
+      BasicBlock* succ_bb = ctx_->get_instr_block(label_id);
+      state.succs.push_back(Edge(&block, succ_bb));
     });
     if (block.IsReturnOrAbort()) {
-      bb_succs_[&block].push_back(
-          Edge(&block, ctx_->cfg()->pseudo_exit_block()));
-      bb_preds_[ctx_->cfg()->pseudo_exit_block()].push_back(
-          Edge(ctx_->cfg()->pseudo_exit_block(), &block));
+      state.succs.push_back(Edge(&block, ctx_->cfg()->pseudo_exit_block()));
     }
   }
+  blocks_.reserve(block_states_.size());
 
-  // Add the edges out of the entry block to seed the propagator.
-  const auto& entry_succs = bb_succs_[ctx_->cfg()->pseudo_entry_block()];
-  for (const auto& e : entry_succs) {
-    AddControlEdge(e);
-  }
+  // Add the edge out of the entry block to seed the propagator.
+  AddControlEdge(Edge(ctx_->cfg()->pseudo_entry_block(), fn->entry().get()));
 }
 
 bool SSAPropagator::Run(Function* fn) {
   Initialize(fn);
 
   bool changed = false;
-  while (!blocks_.empty() || !ssa_edge_uses_.empty()) {
+  while (next_block_ < blocks_.size() ||
+         next_ssa_edge_use_ < ssa_edge_uses_.size()) {
     // Simulate all blocks first. Simulating blocks will add SSA edges to
     // follow after all the blocks have been simulated.
-    if (!blocks_.empty()) {
-      auto block = blocks_.front();
-      changed |= Simulate(block);
-      blocks_.pop();
+    if (next_block_ < blocks_.size()) {
+      changed |= Simulate(blocks_[next_block_++]);
       continue;
     }
 
     // Simulate edges from the SSA queue.
-    if (!ssa_edge_uses_.empty()) {
-      Instruction* instr = ssa_edge_uses_.front();
-      changed |= Simulate(instr);
-      ssa_edge_uses_.pop();
-    }
+    changed |= Simulate(ssa_edge_uses_[next_ssa_edge_use_++]);
   }
 
 #ifndef NDEBUG
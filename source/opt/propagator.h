@@ -16,10 +16,6 @@
 #define SOURCE_OPT_PROPAGATOR_H_
 
 #include <functional>
-#include <queue>
-#include <set>
-#include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -187,10 +183,15 @@ class SSAPropagator {
   using VisitFunction = std::function<PropStatus(Instruction*, BasicBlock**)>;
 
   SSAPropagator(IRContext* context, const VisitFunction& visit_fn)
-      : ctx_(context), visit_fn_(visit_fn) {}
+      : ctx_(context),
+        visit_fn_(visit_fn),
+        next_ssa_edge_use_(0),
+        next_block_(0),
+        run_(0) {}
 
   // Runs the propagator on function |fn|. Returns true if changes were made to
-  // the function. Otherwise, it returns false.
+  // the function. Otherwise, it returns false.  The propagator can be run
+  // again on another function; the statuses of the previous run are dropped.
   bool Run(Function* fn);
 
   // Returns true if the |i|th argument for |phi| comes through a CFG edge that
@@ -200,19 +201,79 @@ class SSAPropagator {
 
   // Returns true if |inst| has a recorded status. This will be true once |inst|
   // has been simulated once.
-  bool HasStatus(Instruction* inst) const { return statuses_.count(inst); }
+  bool HasStatus(Instruction* inst) const {
+    const InstState* state = GetState(inst);
+    return state != nullptr && state->has_status;
+  }
 
   // Returns the current propagation status of |inst|. Assumes
   // |HasStatus(inst)| returns true.
   PropStatus Status(Instruction* inst) const {
-    return statuses_.find(inst)->second;
+    assert(HasStatus(inst));
+    return GetState(inst)->status;
   }
 
   // Records the propagation status |status| for |inst|. Returns true if the
   // status for |inst| has changed or set was set for the first time.
   bool SetStatus(Instruction* inst, PropStatus status);
 
+  // Schedules the instructions that use the result of |inst| to be simulated
+  // again.  The propagator does this by itself when the status of |inst|
+  // changes.  A visit function calls this when its lattice has more than one
+  // interesting value, and the value of |inst| changes while its status stays
+  // kInteresting.
+  void ValueChanged(Instruction* inst) { AddSSAEdges(inst); }
+
  private:
+  // Propagation state of an instruction in the current run.
+  struct InstState {
+    // The run this state belongs to.  States left by earlier runs are stale.
+    uint32_t run = 0;
+
+    // For an OpLabel, the index of its block in |block_states_|.
+    uint32_t block_index = 0;
+
+    bool has_status = false;
+    PropStatus status = kNotInteresting;
+
+    // True if the instruction should not be simulated again because it was
+    // found to be in the kVarying state.
+    bool do_not_simulate = false;
+  };
+
+  // Propagation state of a block in the current run.
+  struct BlockState {
+    explicit BlockState(BasicBlock* b) : block(b), simulated(false) {}
+
+    BasicBlock* block;
+
+    // True if the block has been simulated.
+    bool simulated;
+
+    // The edges out of the block.
+    std::vector<Edge> succs;
+
+    // The sources of the edges into the block marked as executable.
+    std::vector<BasicBlock*> executable_preds;
+  };
+
+  // Returns the state of |inst| in the current run, or nullptr if it has none.
+  const InstState* GetState(const Instruction* inst) const {
+    uint32_t id = inst->unique_id();
+    if (id >= inst_states_.size() || inst_states_[id].run != run_) {
+      return nullptr;
+    }
+    return &inst_states_[id];
+  }
+
+  // Returns the state of |inst| in the current run, creating it if needed.
+  InstState& GetOrCreateState(const Instruction* inst);
+
+  // Returns the state of |block| in the current run, or nullptr if |block| is
+  // not in the function being propagated.
+  BlockState* GetBlockState(const BasicBlock* block);
+  const BlockState* GetBlockState(const BasicBlock* block) const;
+
   // Initialize processing.
   void Initialize(Function* fn);
 
@@ -228,32 +289,32 @@ class SSAPropagator {
 
   // Returns true if |instr| should be simulated again.
   bool ShouldSimulateAgain(Instruction* instr) const {
-    return do_not_simulate_.find(instr) == do_not_simulate_.end();
+    const InstState* state = GetState(instr);
+    return state == nullptr || !state->do_not_simulate;
   }
 
   // Add |instr| to the set of instructions not to simulate again.
-  void DontSimulateAgain(Instruction* instr) { do_not_simulate_.insert(instr); }
+  void DontSimulateAgain(Instruction* instr) {
+    GetOrCreateState(instr).do_not_simulate = true;
+  }
 
   // Returns true if |block| has been simulated already.
   bool BlockHasBeenSimulated(BasicBlock* block) const {
-    return simulated_blocks_.find(block) != simulated_blocks_.end();
+    const BlockState* state = GetBlockState(block);
+    return state != nullptr && state->simulated;
   }
 
   // Marks block |block| as simulated.
   void MarkBlockSimulated(BasicBlock* block) {
-    simulated_blocks_.insert(block);
+    GetBlockState(block)->simulated = true;
   }
 
   // Marks |edge| as executable.  Returns false if the edge was already marked
   // as executable.
-  bool MarkEdgeExecutable(const Edge& edge) {
-    return executable_edges_.insert(edge).second;
-  }
+  bool MarkEdgeExecutable(const Edge& edge);
 
   // Returns true if |edge| has been marked as executable.
-  bool IsEdgeExecutable(const Edge& edge) const {
-    return executable_edges_.find(edge) != executable_edges_.end();
-  }
+  bool IsEdgeExecutable(const Edge& edge) const;
 
   // Returns a pointer to the def-use manager for |ctx_|.
   analysis::DefUseManager* get_def_use_mgr() const {
@@ -278,34 +339,26 @@ class SSAPropagator {
   VisitFunction visit_fn_;
 
   // SSA def-use edges to traverse. Each entry is a destination statement for an
-  // SSA def-use edge as returned by |def_use_manager_|.
-  std::queue<Instruction*> ssa_edge_uses_;
-
-  // Blocks to simulate.
-  std::queue<BasicBlock*> blocks_;
-
-  // Blocks simulated during propagation.
-  std::unordered_set<BasicBlock*> simulated_blocks_;
-
-  // Set of instructions that should not be simulated again because they have
-  // been found to be in the kVarying state.
-  std::unordered_set<Instruction*> do_not_simulate_;
-
-  // Map between a basic block and its predecessor edges.
-  // TODO(dnovillo): Move this to CFG and always build them. Alternately,
-  // move it to IRContext and build CFG preds/succs on-demand.
-  std::unordered_map<BasicBlock*, std::vector<Edge>> bb_preds_;
-
-  // Map between a basic block and its successor edges.
-  // TODO(dnovillo): Move this to CFG and always build them. Alternately,
-  // move it to IRContext and build CFG preds/succs on-demand.
-  std::unordered_map<BasicBlock*, std::vector<Edge>> bb_succs_;
-
-  // Set of executable CFG edges.
-  std::set<Edge> executable_edges_;
-
-  // Tracks instruction propagation status.
-  std::unordered_map<Instruction*, SSAPropagator::PropStatus> statuses_;
+  // SSA def-use edge as returned by |def_use_manager_|.  The entries before
+  // |next_ssa_edge_use_| have been simulated.
+  std::vector<Instruction*> ssa_edge_uses_;
+  size_t next_ssa_edge_use_;
+
+  // Blocks to simulate.  The entries before |next_block_| have been
+  // simulated.
+  std::vector<BasicBlock*> blocks_;
+  size_t next_block_;
+
+  // The number of the current run.  Incremented by every call to |Run|, so
+  // the states of the previous run do not have to be cleared.
+  uint32_t run_;
+
+  // Propagation states of the instructions, indexed by their unique id.
+  std::vector<InstState> inst_states_;
+
+  // Propagation states of the blocks of the function being propagated, in
+  // function order.
+  std::vector<BlockState> block_states_;
 };
 
 std::ostream& operator<<(std::ostream& str,
@@ -0,0 +1,236 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/rematerialization_pass.h"
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "source/opt/reflect.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const uint32_t kLoadMemoryAccessInIdx = 1;
+
+// The longest chain of instructions that is copied to recompute a value.
+const size_t kMaxChainLength = 3;
+
+// Returns true if |opcode| is cheap enough to be computed again rather than
+// kept in a register.
+bool IsCheapOpcode(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpAccessChain:
+    case SpvOpInBoundsAccessChain:
+    case SpvOpCompositeConstruct:
+    case SpvOpCompositeExtract:
+    case SpvOpVectorShuffle:
+    case SpvOpSNegate:
+    case SpvOpFNegate:
+    case SpvOpIAdd:
+    case SpvOpFAdd:
+    case SpvOpISub:
+    case SpvOpFSub:
+    case SpvOpIMul:
+    case SpvOpFMul:
+    case SpvOpShiftRightLogical:
+    case SpvOpShiftRightArithmetic:
+    case SpvOpShiftLeftLogical:
+    case SpvOpBitwiseOr:
+    case SpvOpBitwiseXor:
+    case SpvOpBitwiseAnd:
+    case SpvOpNot:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+Pass::Status RematerializationPass::Process() {
+  bool modified = false;
+  for (auto& func : *get_module()) {
+    const RegisterLiveness* liveness =
+        context()->GetLivenessAnalysis()->Get(&func);
+    std::vector<std::pair<BasicBlock*, const LiveSet*>> crowded;
+    for (auto& block : func) {
+      const RegisterLiveness::RegionRegisterLiveness* block_liveness =
+          liveness->Get(&block);
+      if (block_liveness != nullptr &&
+          block_liveness->used_registers_ > max_registers_) {
+        crowded.emplace_back(&block, &block_liveness->live_in_);
+      }
+    }
+    if (crowded.empty()) continue;
+
+    // Find the values that are live through a crowded block without being
+    // used there.  The ids are kept because rematerializing a value can remove
+    // others.
+    std::vector<uint32_t> candidates;
+    for (auto& block : func) {
+      for (auto& inst : block) {
+        if (!IsCheapOpcode(inst.opcode()) && inst.opcode() != SpvOpLoad) {
+          continue;
+        }
+        std::unordered_set<BasicBlock*> user_blocks;
+        get_def_use_mgr()->ForEachUser(
+            &inst, [this, &user_blocks](Instruction* user) {
+              user_blocks.insert(context()->get_instr_block(user));
+            });
+        bool live_through = std::any_of(
+            crowded.begin(), crowded.end(),
+            [&inst, &user_blocks](
+                const std::pair<BasicBlock*, const LiveSet*>& region) {
+              return region.second->count(&inst) != 0 &&
+                     user_blocks.count(region.first) == 0;
+            });
+        if (live_through) candidates.push_back(inst.result_id());
+      }
+    }
+
+    for (uint32_t id : candidates) {
+      Instruction* inst = get_def_use_mgr()->GetDef(id);
+      std::vector<Instruction*> chain;
+      if (inst == nullptr || !IsRematerializable(inst, &chain)) continue;
+
+      BasicBlock* def_block = context()->get_instr_block(inst);
+      std::unordered_set<BasicBlock*> user_blocks;
+      get_def_use_mgr()->ForEachUser(
+          inst, [this, &user_blocks](Instruction* user) {
+            if (user->opcode() != SpvOpPhi) {
+              user_blocks.insert(context()->get_instr_block(user));
+            }
+          });
+      for (auto& block : func) {
+        if (&block == def_block || user_blocks.count(&block) == 0) continue;
+        if (!Rematerialize(chain, &block)) return Status::Failure;
+        modified = true;
+      }
+      KillDeadChain(chain);
+    }
+  }
+  return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+}
+
+bool RematerializationPass::IsFree(Instruction* inst) {
+  if (IsConstantInst(inst->opcode()) || inst->opcode() == SpvOpUndef) {
+    return true;
+  }
+  return inst->opcode() == SpvOpVariable &&
+         context()->get_instr_block(inst) == nullptr;
+}
+
+bool RematerializationPass::IsRematerializable(
+    Instruction* inst, std::vector<Instruction*>* chain) {
+  if (chain->size() == kMaxChainLength) return false;
+
+  if (inst->opcode() == SpvOpLoad) {
+    // Only loads from memory that cannot change can be moved around.
+    if (!inst->IsReadOnlyLoad() ||
+        (inst->NumInOperands() > kLoadMemoryAccessInIdx &&
+         (inst->GetSingleWordInOperand(kLoadMemoryAccessInIdx) &
+          SpvMemoryAccessVolatileMask) != 0)) {
+      return false;
+    }
+  } else if (!IsCheapOpcode(inst->opcode())) {
+    return false;
+  }
+
+  bool is_rematerializable =
+      inst->WhileEachInId([this, chain](const uint32_t* id) {
+        Instruction* operand = get_def_use_mgr()->GetDef(*id);
+        if (IsFree(operand) ||
+            std::find(chain->begin(), chain->end(), operand) != chain->end()) {
+          return true;
+        }
+        return IsRematerializable(operand, chain);
+      });
+  if (!is_rematerializable) return false;
+
+  chain->push_back(inst);
+  return true;
+}
+
+bool RematerializationPass::Rematerialize(
+    const std::vector<Instruction*>& chain, BasicBlock* block) {
+  Instruction* value = chain.back();
+  std::vector<std::pair<Instruction*, uint32_t>> uses;
+  get_def_use_mgr()->ForEachUse(
+      value, [this, block, &uses](Instruction* user, uint32_t index) {
+        if (user->opcode() != SpvOpPhi &&
+            context()->get_instr_block(user) == block) {
+          uses.emplace_back(user, index);
+        }
+      });
+  if (uses.empty()) return true;
+
+  // The copy goes before the first use, but not between a merge instruction
+  // and its branch.
+  Instruction* insert_point = nullptr;
+  for (auto& inst : *block) {
+    if (std::any_of(uses.begin(), uses.end(),
+                    [&inst](const std::pair<Instruction*, uint32_t>& use) {
+                      return use.first == &inst;
+                    })) {
+      insert_point = &inst;
+      break;
+    }
+  }
+  if (insert_point == block->terminator() &&
+      block->GetMergeInst() != nullptr) {
+    insert_point = block->GetMergeInst();
+  }
+
+  std::unordered_map<uint32_t, uint32_t> new_ids;
+  for (Instruction* inst : chain) {
+    uint32_t new_id = TakeNextId();
+    if (new_id == 0) return false;
+
+    std::unique_ptr<Instruction> copy(inst->Clone(context()));
+    copy->SetResultId(new_id);
+    copy->ForEachInId([&new_ids](uint32_t* id) {
+      auto it = new_ids.find(*id);
+      if (it != new_ids.end()) *id = it->second;
+    });
+    new_ids[inst->result_id()] = new_id;
+
+    Instruction* added = insert_point->InsertBefore(std::move(copy));
+    get_def_use_mgr()->AnalyzeInstDefUse(added);
+    context()->set_instr_block(added, block);
+    get_decoration_mgr()->CloneDecorations(inst->result_id(), new_id);
+  }
+
+  for (auto& use : uses) {
+    use.first->SetOperand(use.second, {new_ids[value->result_id()]});
+    get_def_use_mgr()->AnalyzeInstUse(use.first);
+  }
+  return true;
+}
+
+void RematerializationPass::KillDeadChain(
+    const std::vector<Instruction*>& chain) {
+  for (auto inst = chain.rbegin(); inst != chain.rend(); ++inst) {
+    if (get_def_use_mgr()->NumUses(*inst) == 0) {
+      context()->KillInst(*inst);
+    }
+  }
+}
+
+}  // namespace opt
+}  // namespace spvtools
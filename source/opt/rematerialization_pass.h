@@ -0,0 +1,88 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_REMATERIALIZATION_PASS_H_
+#define SOURCE_OPT_REMATERIALIZATION_PASS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "source/opt/ir_context.h"
+#include "source/opt/pass.h"
+#include "source/opt/register_pressure.h"
+
+namespace spvtools {
+namespace opt {
+
+// This pass recomputes cheap values close to their uses, instead of keeping
+// them live across regions where too many values are live already.
+//
+// A value can be rematerialized if it is computed by a short chain of cheap
+// instructions, such as access chains, loads from read-only memory and simple
+// arithmetic, whose leaves are constants and module scope variables.  Such a
+// value does not lengthen the live range of anything when it is recomputed.
+//
+// If the value is live through a block, without being used there, and the
+// register liveness analysis finds that block needs more registers than the
+// target, the chain is copied into each other block that uses the value,
+// before the first use.  The original chain is removed if it is no longer
+// used.  Uses in phis are left alone.
+class RematerializationPass : public Pass {
+ public:
+  explicit RematerializationPass(uint32_t max_registers)
+      : max_registers_(max_registers) {}
+
+  const char* name() const override { return "rematerialize"; }
+  Status Process() override;
+
+  IRContext::Analysis GetPreservedAnalyses() override {
+    return IRContext::kAnalysisDefUse |
+           IRContext::kAnalysisInstrToBlockMapping |
+           IRContext::kAnalysisDecorations | IRContext::kAnalysisCombinators |
+           IRContext::kAnalysisCFG | IRContext::kAnalysisDominatorAnalysis |
+           IRContext::kAnalysisLoopAnalysis | IRContext::kAnalysisNameMap |
+           IRContext::kAnalysisConstants | IRContext::kAnalysisTypes;
+  }
+
+ private:
+  using LiveSet = RegisterLiveness::RegionRegisterLiveness::LiveSet;
+
+  // Returns true if |inst| is a value that can be recomputed anywhere in its
+  // function.  The instructions of its chain, operands first, are appended to
+  // |chain|.
+  bool IsRematerializable(Instruction* inst,
+                          std::vector<Instruction*>* chain);
+
+  // Returns true if |inst| is available everywhere without a register.
+  bool IsFree(Instruction* inst);
+
+  // Copies |chain| into |block| and replaces the uses of the last instruction
+  // of |chain| in |block|, other than phis, by the copy.  Returns false if ids
+  // ran out.
+  bool Rematerialize(const std::vector<Instruction*>& chain,
+                     BasicBlock* block);
+
+  // Removes the instructions of |chain| that are no longer used, starting
+  // with the last one.
+  void KillDeadChain(const std::vector<Instruction*>& chain);
+
+  // The number of registers above which a block is considered to need fewer
+  // live values.
+  uint32_t max_registers_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_REMATERIALIZATION_PASS_H_
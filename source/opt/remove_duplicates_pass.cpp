@@ -26,6 +26,7 @@
 #include "source/opt/decoration_manager.h"
 #include "source/opt/ir_context.h"
 #include "source/opt/reflect.h"
+#include "source/opt/type_manager.h"
 
 namespace spvtools {
 namespace opt {
@@ -98,8 +99,16 @@ bool RemoveDuplicatesPass::RemoveDuplicateTypes() const {
 
   analysis::TypeManager type_manager(context()->consumer(), context());
 
-  std::vector<Instruction*> visited_types;
-  std::vector<analysis::ForwardPointer> visited_forward_pointers;
+  // Types are bucketed by their structural hash, so each type is only
+  // compared against the types that hash the same.
+  std::unordered_map<const analysis::Type*, SpvId, analysis::HashTypePointer,
+                     analysis::CompareTypePointers>
+      visited_types;
+  // The hash of a forward pointer includes its target id, which equality
+  // ignores once the target pointer is known, so forward pointers are only
+  // bucketed by storage class.
+  std::unordered_map<uint32_t, std::vector<analysis::ForwardPointer>>
+      visited_forward_pointers;
   std::vector<Instruction*> to_delete;
   for (auto* i = &*context()->types_values_begin(); i; i = i->NextNode()) {
     const bool is_i_forward_pointer = i->opcode() == SpvOpTypeForwardPointer;
@@ -111,25 +120,13 @@ bool RemoveDuplicatesPass::RemoveDuplicateTypes() const {
 
     if (!is_i_forward_pointer) {
       // Is the current type equal to one of the types we have already visited?
-      SpvId id_to_keep = 0u;
       analysis::Type* i_type = type_manager.GetType(i->result_id());
       assert(i_type);
-      // TODO(dneto0): Use a trie to avoid quadratic behaviour? Extract the
-      // ResultIdTrie from unify_const_pass.cpp for this.
-      for (auto j : visited_types) {
-        analysis::Type* j_type = type_manager.GetType(j->result_id());
-        assert(j_type);
-        if (*i_type == *j_type) {
-          id_to_keep = j->result_id();
-          break;
-        }
-      }
+      auto res = visited_types.emplace(i_type, i->result_id());
 
-      if (id_to_keep == 0u) {
-        // This is a never seen before type, keep it around.
-        visited_types.emplace_back(i);
-      } else {
+      if (!res.second) {
         // The same type has already been seen before, remove this one.
+        const SpvId id_to_keep = res.first->second;
         context()->KillNamesAndDecorates(i->result_id());
         context()->ReplaceAllUsesWith(i->result_id(), id_to_keep);
         modified = true;
@@ -142,16 +139,14 @@ bool RemoveDuplicatesPass::RemoveDuplicateTypes() const {
       i_type.SetTargetPointer(
           type_manager.GetType(i_type.target_id())->AsPointer());
 
-      // TODO(dneto0): Use a trie to avoid quadratic behaviour? Extract the
-      // ResultIdTrie from unify_const_pass.cpp for this.
+      auto& bucket = visited_forward_pointers[i_type.storage_class()];
       const bool found_a_match =
-          std::find(std::begin(visited_forward_pointers),
-                    std::end(visited_forward_pointers),
-                    i_type) != std::end(visited_forward_pointers);
+          std::find(std::begin(bucket), std::end(bucket), i_type) !=
+          std::end(bucket);
 
       if (!found_a_match) {
         // This is a never seen before type, keep it around.
-        visited_forward_pointers.emplace_back(i_type);
+        bucket.emplace_back(i_type);
       } else {
         // The same type has already been seen before, remove this one.
         modified = true;
@@ -179,25 +174,45 @@ bool RemoveDuplicatesPass::RemoveDuplicateTypes() const {
 bool RemoveDuplicatesPass::RemoveDuplicateDecorations() const {
   bool modified = false;
 
-  std::vector<const Instruction*> visited_decorations;
-
   analysis::DecorationManager decoration_manager(context()->module());
+
+  // Decorations are bucketed by a hash of their opcode and operands, so each
+  // decoration is only compared against the decorations that hash the same.
+  auto hash = [](const Instruction* inst) {
+    std::u32string h;
+    h.push_back(inst->opcode());
+    for (uint32_t i = 0; i < inst->NumInOperands(); ++i) {
+      for (uint32_t word : inst->GetInOperand(i).words) {
+        h.push_back(word);
+      }
+    }
+    return std::hash<std::u32string>()(h);
+  };
+  auto equal = [&decoration_manager](const Instruction* lhs,
+                                     const Instruction* rhs) {
+    return decoration_manager.AreDecorationsTheSame(lhs, rhs, false);
+  };
+  std::unordered_set<const Instruction*, decltype(hash), decltype(equal)>
+      visited_decorations(16, hash, equal);
+
   for (auto* i = &*context()->annotation_begin(); i;) {
-    // Is the current decoration equal to one of the decorations we have
-    // already visited?
-    bool already_visited = false;
-    // TODO(dneto0): Use a trie to avoid quadratic behaviour? Extract the
-    // ResultIdTrie from unify_const_pass.cpp for this.
-    for (const Instruction* j : visited_decorations) {
-      if (decoration_manager.AreDecorationsTheSame(&*i, j, false)) {
-        already_visited = true;
+    // Only these decorations can be the same as another one.  Adding any
+    // other annotation to the set would break its equality relation.
+    switch (i->opcode()) {
+      case SpvOpDecorate:
+      case SpvOpMemberDecorate:
+      case SpvOpDecorateId:
+      case SpvOpDecorateStringGOOGLE:
         break;
-      }
+      default:
+        i = i->NextNode();
+        continue;
     }
 
-    if (!already_visited) {
+    // Is the current decoration equal to one of the decorations we have
+    // already visited?
+    if (visited_decorations.insert(i).second) {
       // This is a never seen before decoration, keep it around.
-      visited_decorations.emplace_back(&*i);
       i = i->NextNode();
     } else {
       // The same decoration has already been seen before, remove this one.
@@ -373,6 +373,51 @@ SENode* ScalarEvolutionAnalysis::GetCachedOrAdd(
   return raw_ptr_to_node;
 }
 
+void ScalarEvolutionAnalysis::InvalidateInstruction(const Instruction* inst) {
+  // Only the values computed by instructions are analyzed.
+  if (!inst->HasResultId()) return;
+  recurrent_node_map_.erase(inst);
+
+  BasicBlock* basic_block = context_->get_instr_block(inst->result_id());
+  if (!basic_block ||
+      !context_->AreAnalysesValid(IRContext::kAnalysisLoopAnalysis)) {
+    // A global value, which any loop may use, or a value whose loop is not
+    // known without building the loop analysis again.
+    recurrent_node_map_.clear();
+    return;
+  }
+
+  LoopDescriptor* loop_descriptor =
+      context_->GetLoopDescriptor(basic_block->GetParent());
+  const Loop* loop = (*loop_descriptor)[basic_block->id()];
+  if (loop) {
+    InvalidateLoop(loop);
+    return;
+  }
+
+  // The value can be used by any loop of the function.
+  for (const Loop& each_loop : *loop_descriptor) {
+    if (!each_loop.GetParent()) InvalidateLoop(&each_loop);
+  }
+}
+
+void ScalarEvolutionAnalysis::InvalidateLoop(const Loop* loop) {
+  // The evolutions of the phis of a loop can refer to the phis of the loops
+  // containing it, so the whole nest is forgotten.
+  while (loop->GetParent()) loop = loop->GetParent();
+
+  std::vector<const Loop*> worklist = {loop};
+  while (!worklist.empty()) {
+    const Loop* current = worklist.back();
+    worklist.pop_back();
+    for (const Instruction& inst : *current->GetHeaderBlock()) {
+      if (inst.opcode() != SpvOp::SpvOpPhi) break;
+      recurrent_node_map_.erase(&inst);
+    }
+    worklist.insert(worklist.end(), current->begin(), current->end());
+  }
+}
+
 bool ScalarEvolutionAnalysis::IsLoopInvariant(const Loop* loop,
                                               const SENode* node) const {
   for (auto itr = node->graph_cbegin(); itr != node->graph_cend(); ++itr) {
@@ -39,6 +39,12 @@ class Loop;
 // two induction variables i=0,i++ and j=0,j++) become the same node. After
 // creating a DAG with AnalyzeInstruction it can the be simplified into a more
 // usable form with SimplifyExpression.
+//
+// The evolution of each phi is cached.  The analysis can be kept while the
+// loops of the function are kept, as long as the phis whose evolution may
+// have changed are forgotten with RemoveInstruction, InvalidateInstruction or
+// InvalidateLoop.  The IRContext does it when instructions are killed or their
+// uses replaced.
 class ScalarEvolutionAnalysis {
  public:
   explicit ScalarEvolutionAnalysis(IRContext* context);
@@ -127,6 +133,22 @@ class ScalarEvolutionAnalysis {
     pretend_equal_[std::get<1>(loop_pair)] = std::get<0>(loop_pair);
   }
 
+  // Forgets the cached evolution of |inst|.  It must be called before |inst|
+  // is deleted.
+  void RemoveInstruction(const Instruction* inst) {
+    recurrent_node_map_.erase(inst);
+  }
+
+  // Forgets the cached evolutions that may depend on |inst|, after its
+  // operands changed: those of the phis in the loop nest containing |inst|, or
+  // in every loop of its function if |inst| is not in a loop.  If the loop
+  // analysis is not valid, everything is forgotten instead of rebuilding it.
+  void InvalidateInstruction(const Instruction* inst);
+
+  // Forgets the cached evolutions of the phis in the loop nest containing
+  // |loop|, after the loop was transformed.
+  void InvalidateLoop(const Loop* loop);
+
  private:
   SENode* AnalyzeConstant(const Instruction* inst);
 
@@ -15,6 +15,7 @@
 #include "source/opt/simplification_pass.h"
 
 #include <set>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -26,9 +27,31 @@ namespace opt {
 Pass::Status SimplificationPass::Process() {
   bool modified = false;
 
+  // If the def-use manager recorded the instructions changed since the last
+  // run, only those are simplified again.
+  std::vector<Instruction*> changed;
+  bool only_changed = get_def_use_mgr()->TakeChangedInstructions(&changed);
+  std::unordered_map<Function*, std::vector<Instruction*>> changed_in_function;
+  for (Instruction* inst : changed) {
+    BasicBlock* block = context()->get_instr_block(inst);
+    if (block != nullptr) {
+      changed_in_function[block->GetParent()].push_back(inst);
+    }
+  }
+
   for (Function& function : *get_module()) {
-    modified |= SimplifyFunction(&function);
+    if (!only_changed) {
+      modified |= SimplifyFunction(&function, nullptr);
+    } else {
+      auto it = changed_in_function.find(&function);
+      if (it != changed_in_function.end()) {
+        modified |= SimplifyFunction(&function, &it->second);
+      }
+    }
   }
+
+  // The instructions changed by this pass are already simplified.
+  get_def_use_mgr()->TakeChangedInstructions(&changed);
   return (modified ? Status::SuccessWithChange : Status::SuccessWithoutChange);
 }
 
@@ -44,7 +67,8 @@ void SimplificationPass::AddNewOperands(
       });
 }
 
-bool SimplificationPass::SimplifyFunction(Function* function) {
+bool SimplificationPass::SimplifyFunction(
+    Function* function, const std::vector<Instruction*>* changed) {
   bool modified = false;
   // Phase 1: Traverse all instructions in dominance order.
   // The second phase will only be on the instructions whose inputs have changed
@@ -59,54 +83,71 @@ bool SimplificationPass::SimplifyFunction(Function* function) {
   std::unordered_set<Instruction*> inst_seen;
   const InstructionFolder& folder = context()->get_instruction_folder();
 
-  cfg()->ForEachBlockInReversePostOrder(
-      function->entry().get(),
-      [&modified, &process_phis, &work_list, &in_work_list, &inst_to_kill,
-       &folder, &inst_seen, this](BasicBlock* bb) {
-        for (Instruction* inst = &*bb->begin(); inst; inst = inst->NextNode()) {
-          inst_seen.insert(inst);
-          if (inst->opcode() == SpvOpPhi) {
-            process_phis.insert(inst);
-          }
-
-          bool is_foldable_copy =
-              inst->opcode() == SpvOpCopyObject &&
-              context()->get_decoration_mgr()->HaveSubsetOfDecorations(
-                  inst->result_id(), inst->GetSingleWordInOperand(0));
-
-          if (is_foldable_copy || folder.FoldInstruction(inst)) {
-            modified = true;
-            context()->AnalyzeUses(inst);
-            get_def_use_mgr()->ForEachUser(inst, [&work_list, &process_phis,
-                                                  &in_work_list](
-                                                     Instruction* use) {
-              if (process_phis.count(use) && in_work_list.insert(use).second) {
-                work_list.push_back(use);
-              }
-            });
-
-            AddNewOperands(inst, &inst_seen, &work_list);
+  if (changed != nullptr) {
+    // Only the changed instructions and their users can be simplified, so
+    // phase 1 is replaced by adding them to the work list.
+    auto add_to_work_list = [&work_list, &in_work_list](Instruction* inst) {
+      if (!inst->IsDecoration() && inst->opcode() != SpvOpName &&
+          in_work_list.insert(inst).second) {
+        work_list.push_back(inst);
+      }
+    };
+    for (Instruction* inst : *changed) {
+      add_to_work_list(inst);
+      get_def_use_mgr()->ForEachUser(inst, add_to_work_list);
+    }
+  } else {
+    cfg()->ForEachBlockInReversePostOrder(
+        function->entry().get(),
+        [&modified, &process_phis, &work_list, &in_work_list, &inst_to_kill,
+         &folder, &inst_seen, this](BasicBlock* bb) {
+          for (Instruction* inst = &*bb->begin(); inst;
+               inst = inst->NextNode()) {
+            inst_seen.insert(inst);
+            if (inst->opcode() == SpvOpPhi) {
+              process_phis.insert(inst);
+            }
 
-            if (inst->opcode() == SpvOpCopyObject) {
-              context()->ReplaceAllUsesWithPredicate(
-                  inst->result_id(), inst->GetSingleWordInOperand(0),
-                  [](Instruction* user, uint32_t) {
-                    const auto opcode = user->opcode();
-                    if (!spvOpcodeIsDebug(opcode) &&
-                        !spvOpcodeIsDecoration(opcode)) {
-                      return true;
+            bool is_foldable_copy =
+                inst->opcode() == SpvOpCopyObject &&
+                context()->get_decoration_mgr()->HaveSubsetOfDecorations(
+                    inst->result_id(), inst->GetSingleWordInOperand(0));
+
+            if (is_foldable_copy || folder.FoldInstruction(inst)) {
+              modified = true;
+              context()->AnalyzeUses(inst);
+              get_def_use_mgr()->ForEachUser(
+                  inst, [&work_list, &process_phis,
+                         &in_work_list](Instruction* use) {
+                    if (process_phis.count(use) &&
+                        in_work_list.insert(use).second) {
+                      work_list.push_back(use);
                     }
-                    return false;
                   });
-              inst_to_kill.insert(inst);
-              in_work_list.insert(inst);
-            } else if (inst->opcode() == SpvOpNop) {
-              inst_to_kill.insert(inst);
-              in_work_list.insert(inst);
+
+              AddNewOperands(inst, &inst_seen, &work_list);
+
+              if (inst->opcode() == SpvOpCopyObject) {
+                context()->ReplaceAllUsesWithPredicate(
+                    inst->result_id(), inst->GetSingleWordInOperand(0),
+                    [](Instruction* user, uint32_t) {
+                      const auto opcode = user->opcode();
+                      if (!spvOpcodeIsDebug(opcode) &&
+                          !spvOpcodeIsDecoration(opcode)) {
+                        return true;
+                      }
+                      return false;
+                    });
+                inst_to_kill.insert(inst);
+                in_work_list.insert(inst);
+              } else if (inst->opcode() == SpvOpNop) {
+                inst_to_kill.insert(inst);
+                in_work_list.insert(inst);
+              }
             }
           }
-        }
-      });
+        });
+  }
 
   // Phase 2: process the instructions in the work list until all of the work is
   //          done.  This time we add all users to the work list because phase 1
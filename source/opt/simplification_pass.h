@@ -40,8 +40,11 @@ class SimplificationPass : public Pass {
  private:
   // Returns true if the module was changed.  The simplifier is called on every
   // instruction in |function| until nothing else in the function can be
-  // simplified.
-  bool SimplifyFunction(Function* function);
+  // simplified.  If |changed| is not nullptr, it starts from the instructions
+  // in |changed| and their users instead of every instruction, because the
+  // other instructions cannot be simplified further.
+  bool SimplifyFunction(Function* function,
+                        const std::vector<Instruction*>* changed);
 
   // FactorAddMul can create |folded_inst| Mul of new Add. If Mul, push any Add
   // operand not in |seen_inst| into |worklist|. This is heavily restricted to
@@ -0,0 +1,403 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/slp_vectorizer_pass.h"
+
+#include <algorithm>
+#include <memory>
+#include <unordered_set>
+
+#include "source/opt/register_pressure.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const uint32_t kExtractCompositeInIdx = 0;
+const uint32_t kExtractFirstIndexInIdx = 1;
+const uint32_t kTypeVectorComponentTypeInIdx = 0;
+const uint32_t kTypeVectorCountInIdx = 1;
+
+// Returns true if |opcode| applies to each component of vectors separately,
+// with the same result on each as on scalars.
+bool IsComponentWise(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpFNegate:
+    case SpvOpSNegate:
+    case SpvOpNot:
+    case SpvOpLogicalNot:
+    case SpvOpFAdd:
+    case SpvOpFSub:
+    case SpvOpFMul:
+    case SpvOpFDiv:
+    case SpvOpFRem:
+    case SpvOpFMod:
+    case SpvOpIAdd:
+    case SpvOpISub:
+    case SpvOpIMul:
+    case SpvOpSDiv:
+    case SpvOpUDiv:
+    case SpvOpSRem:
+    case SpvOpSMod:
+    case SpvOpUMod:
+    case SpvOpBitwiseAnd:
+    case SpvOpBitwiseOr:
+    case SpvOpBitwiseXor:
+    case SpvOpShiftLeftLogical:
+    case SpvOpShiftRightLogical:
+    case SpvOpShiftRightArithmetic:
+    case SpvOpLogicalAnd:
+    case SpvOpLogicalOr:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns the decorations of |id|, without their target, in a form that can
+// be compared.
+std::vector<std::vector<uint32_t>> GetDecorations(IRContext* context,
+                                                  uint32_t id) {
+  std::vector<std::vector<uint32_t>> decorations;
+  for (Instruction* decoration :
+       context->get_decoration_mgr()->GetDecorationsFor(id, false)) {
+    std::vector<uint32_t> words(1, decoration->opcode());
+    for (uint32_t i = 1; i < decoration->NumInOperands(); ++i) {
+      const Operand& operand = decoration->GetInOperand(i);
+      words.insert(words.end(), operand.words.begin(), operand.words.end());
+    }
+    decorations.push_back(std::move(words));
+  }
+  std::sort(decorations.begin(), decorations.end());
+  return decorations;
+}
+
+bool IsScalarConstant(const Instruction* inst) {
+  switch (inst->opcode()) {
+    case SpvOpConstantTrue:
+    case SpvOpConstantFalse:
+    case SpvOpConstant:
+    case SpvOpConstantNull:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+Pass::Status SLPVectorizerPass::Process() {
+  Status status = Status::SuccessWithoutChange;
+  for (auto& func : *get_module()) {
+    for (auto& block : func) {
+      std::vector<Instruction*> constructs;
+      for (auto& inst : block) {
+        if (inst.opcode() != SpvOpCompositeConstruct) continue;
+        Instruction* type = get_def_use_mgr()->GetDef(inst.type_id());
+        if (type->opcode() == SpvOpTypeVector &&
+            inst.NumInOperands() ==
+                type->GetSingleWordInOperand(kTypeVectorCountInIdx)) {
+          constructs.push_back(&inst);
+        }
+      }
+
+      for (Instruction* construct : constructs) {
+        Status construct_status = VectorizeConstruct(construct, &block);
+        if (construct_status == Status::Failure) {
+          return Status::Failure;
+        }
+        if (construct_status == Status::SuccessWithChange) {
+          status = Status::SuccessWithChange;
+        }
+      }
+    }
+  }
+  return status;
+}
+
+Pass::Status SLPVectorizerPass::VectorizeConstruct(Instruction* construct,
+                                                   BasicBlock* block) {
+  std::vector<uint32_t> lane_ids;
+  construct->ForEachInId(
+      [&lane_ids](const uint32_t* id) { lane_ids.push_back(*id); });
+
+  Tree tree;
+  std::vector<Instruction*> lanes;
+  for (uint32_t id : lane_ids) {
+    lanes.push_back(get_def_use_mgr()->GetDef(id));
+  }
+  // A construct of extracts or constants alone is left to the folding rules.
+  if (!AreIsomorphic(lanes, block) ||
+      !BuildNode(lane_ids, construct->type_id(), block, &tree) ||
+      !IsProfitable(tree, construct, block)) {
+    return Status::SuccessWithoutChange;
+  }
+
+  uint32_t vector_id = EmitTree(tree, construct->type_id(), construct, block);
+  if (vector_id == 0) {
+    return Status::Failure;
+  }
+
+  context()->ReplaceAllUsesWith(construct->result_id(), vector_id);
+  context()->KillInst(construct);
+
+  // The scalar operations are only used in the tree, so they are dead now.
+  // The components extracted from vectors may still be used elsewhere.
+  std::unordered_set<Instruction*> killed;
+  for (auto node = tree.rbegin(); node != tree.rend(); ++node) {
+    for (Instruction* lane : node->lanes) {
+      if (killed.count(lane) != 0) continue;
+      if (node->kind == Node::kOperation ||
+          (node->kind == Node::kShuffle &&
+           get_def_use_mgr()->NumUses(lane) == 0)) {
+        killed.insert(lane);
+        context()->KillInst(lane);
+      }
+    }
+  }
+
+  context()->InvalidateAnalyses(IRContext::kAnalysisRegisterPressure);
+  return Status::SuccessWithChange;
+}
+
+bool SLPVectorizerPass::AreIsomorphic(const std::vector<Instruction*>& lanes,
+                                      BasicBlock* block) {
+  const Instruction* first = lanes.front();
+  if (!IsComponentWise(first->opcode())) return false;
+
+  std::vector<std::vector<uint32_t>> decorations =
+      GetDecorations(context(), first->result_id());
+  for (Instruction* lane : lanes) {
+    if (lane->opcode() != first->opcode() ||
+        lane->type_id() != first->type_id() ||
+        context()->get_instr_block(lane) != block ||
+        get_def_use_mgr()->NumUses(lane) != 1 ||
+        GetDecorations(context(), lane->result_id()) != decorations) {
+      return false;
+    }
+    if (!lane->WhileEachInId([this, lane](const uint32_t* id) {
+          return get_def_use_mgr()->GetDef(*id)->type_id() == lane->type_id();
+        })) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SLPVectorizerPass::BuildNode(const std::vector<uint32_t>& lane_ids,
+                                  uint32_t vector_type_id, BasicBlock* block,
+                                  Tree* tree) {
+  Node node;
+  for (uint32_t id : lane_ids) {
+    node.lanes.push_back(get_def_use_mgr()->GetDef(id));
+  }
+
+  if (std::all_of(node.lanes.begin(), node.lanes.end(), IsScalarConstant)) {
+    node.kind = Node::kConstant;
+    if (context()->get_constant_mgr()->GetConstant(
+            context()->get_type_mgr()->GetType(vector_type_id), lane_ids) ==
+        nullptr) {
+      return false;
+    }
+  } else if (std::all_of(node.lanes.begin(), node.lanes.end(),
+                         [](const Instruction* lane) {
+                           return lane->opcode() == SpvOpCompositeExtract &&
+                                  lane->NumInOperands() == 2;
+                         })) {
+    // The components must come from at most two vectors of the same
+    // component type.
+    node.kind = Node::kShuffle;
+    uint32_t component_type_id = node.lanes.front()->type_id();
+    uint32_t first_source_size = 0;
+    for (Instruction* lane : node.lanes) {
+      Instruction* source = get_def_use_mgr()->GetDef(
+          lane->GetSingleWordInOperand(kExtractCompositeInIdx));
+      Instruction* source_type = get_def_use_mgr()->GetDef(source->type_id());
+      if (source_type->opcode() != SpvOpTypeVector ||
+          source_type->GetSingleWordInOperand(
+              kTypeVectorComponentTypeInIdx) != component_type_id) {
+        return false;
+      }
+
+      auto it = std::find(node.sources.begin(), node.sources.end(), source);
+      if (it == node.sources.end()) {
+        if (node.sources.size() == 2) return false;
+        it = node.sources.insert(it, source);
+      }
+      if (node.sources.size() == 1) {
+        first_source_size =
+            source_type->GetSingleWordInOperand(kTypeVectorCountInIdx);
+      }
+      uint32_t component =
+          lane->GetSingleWordInOperand(kExtractFirstIndexInIdx);
+      if (it != node.sources.begin()) component += first_source_size;
+      node.components.push_back(component);
+    }
+  } else if (AreIsomorphic(node.lanes, block)) {
+    node.kind = Node::kOperation;
+    for (uint32_t i = 0; i < node.lanes.front()->NumInOperands(); ++i) {
+      std::vector<uint32_t> operand_ids;
+      for (Instruction* lane : node.lanes) {
+        operand_ids.push_back(lane->GetSingleWordInOperand(i));
+      }
+      if (!BuildNode(operand_ids, vector_type_id, block, tree)) {
+        return false;
+      }
+      node.operands.push_back(tree->size() - 1);
+    }
+  } else {
+    return false;
+  }
+
+  tree->push_back(std::move(node));
+  return true;
+}
+
+bool SLPVectorizerPass::IsLiveAfter(Instruction* value, Instruction* inst,
+                                    BasicBlock* block) {
+  const RegisterLiveness::RegionRegisterLiveness* liveness =
+      context()->GetLivenessAnalysis()->Get(block->GetParent())->Get(block);
+  if (liveness == nullptr || liveness->live_out_.count(value) != 0) {
+    return true;
+  }
+  for (Instruction* next = inst->NextNode(); next != nullptr;
+       next = next->NextNode()) {
+    if (!next->WhileEachInId([value](const uint32_t* id) {
+          return *id != value->result_id();
+        })) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool SLPVectorizerPass::IsProfitable(const Tree& tree, Instruction* construct,
+                                     BasicBlock* block) {
+  // The construct itself is removed.
+  uint32_t removed = 1;
+  uint32_t added = 0;
+  std::unordered_set<Instruction*> sources;
+  std::unordered_set<Instruction*> extracts;
+  for (const Node& node : tree) {
+    switch (node.kind) {
+      case Node::kOperation:
+        removed += static_cast<uint32_t>(node.lanes.size());
+        ++added;
+        break;
+      case Node::kShuffle: {
+        bool is_identity =
+            node.sources.size() == 1 &&
+            node.sources.front()->type_id() == construct->type_id();
+        for (uint32_t i = 0; i < node.components.size(); ++i) {
+          is_identity = is_identity && node.components[i] == i;
+        }
+        if (!is_identity) ++added;
+        sources.insert(node.sources.begin(), node.sources.end());
+        extracts.insert(node.lanes.begin(), node.lanes.end());
+        break;
+      }
+      case Node::kConstant:
+        break;
+    }
+  }
+
+  // Each lane is used once by its parent in the tree, so the extracts with no
+  // other uses are removed.
+  for (Instruction* extract : extracts) {
+    uint32_t uses_in_tree = 0;
+    for (const Node& node : tree) {
+      if (node.kind != Node::kShuffle) continue;
+      uses_in_tree += static_cast<uint32_t>(
+          std::count(node.lanes.begin(), node.lanes.end(), extract));
+    }
+    if (get_def_use_mgr()->NumUses(extract) == uses_in_tree) ++removed;
+  }
+
+  // Each source vector that was dead by the time of the construct is now
+  // needed until then.
+  for (Instruction* source : sources) {
+    if (!IsLiveAfter(source, construct, block)) ++added;
+  }
+  return removed > added;
+}
+
+uint32_t SLPVectorizerPass::EmitTree(const Tree& tree, uint32_t vector_type_id,
+                                     Instruction* construct,
+                                     BasicBlock* block) {
+  analysis::ConstantManager* const_mgr = context()->get_constant_mgr();
+  std::vector<uint32_t> ids;
+  for (const Node& node : tree) {
+    std::unique_ptr<Instruction> inst;
+    switch (node.kind) {
+      case Node::kConstant: {
+        std::vector<uint32_t> component_ids;
+        for (Instruction* lane : node.lanes) {
+          component_ids.push_back(lane->result_id());
+        }
+        const analysis::Constant* constant = const_mgr->GetConstant(
+            context()->get_type_mgr()->GetType(vector_type_id),
+            component_ids);
+        Instruction* constant_inst =
+            const_mgr->GetDefiningInstruction(constant, vector_type_id);
+        if (constant_inst == nullptr) return 0;
+        ids.push_back(constant_inst->result_id());
+        continue;
+      }
+      case Node::kShuffle: {
+        bool is_identity = node.sources.size() == 1 &&
+                           node.sources.front()->type_id() == vector_type_id;
+        for (uint32_t i = 0; i < node.components.size(); ++i) {
+          is_identity = is_identity && node.components[i] == i;
+        }
+        if (is_identity) {
+          ids.push_back(node.sources.front()->result_id());
+          continue;
+        }
+        uint32_t id = TakeNextId();
+        if (id == 0) return 0;
+        Instruction::OperandList operands = {
+            {SPV_OPERAND_TYPE_ID, {node.sources.front()->result_id()}},
+            {SPV_OPERAND_TYPE_ID, {node.sources.back()->result_id()}}};
+        for (uint32_t component : node.components) {
+          operands.push_back(
+              {SPV_OPERAND_TYPE_LITERAL_INTEGER, {component}});
+        }
+        inst.reset(new Instruction(context(), SpvOpVectorShuffle,
+                                   vector_type_id, id, operands));
+        break;
+      }
+      case Node::kOperation: {
+        uint32_t id = TakeNextId();
+        if (id == 0) return 0;
+        Instruction::OperandList operands;
+        for (size_t operand : node.operands) {
+          operands.push_back({SPV_OPERAND_TYPE_ID, {ids[operand]}});
+        }
+        inst.reset(new Instruction(context(), node.lanes.front()->opcode(),
+                                   vector_type_id, id, operands));
+        get_decoration_mgr()->CloneDecorations(
+            node.lanes.front()->result_id(), id);
+        break;
+      }
+    }
+    ids.push_back(inst->result_id());
+    Instruction* new_inst = construct->InsertBefore(std::move(inst));
+    get_def_use_mgr()->AnalyzeInstDefUse(new_inst);
+    context()->set_instr_block(new_inst, block);
+  }
+  return ids.back();
+}
+
+}  // namespace opt
+}  // namespace spvtools
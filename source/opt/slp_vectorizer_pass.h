@@ -0,0 +1,113 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_SLP_VECTORIZER_PASS_H_
+#define SOURCE_OPT_SLP_VECTORIZER_PASS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "source/opt/ir_context.h"
+#include "source/opt/pass.h"
+
+namespace spvtools {
+namespace opt {
+
+// This pass packs isomorphic scalar operations into vector operations, in the
+// manner of superword level parallelism.
+//
+// The search starts from each OpCompositeConstruct of a vector from scalars.
+// If the scalars are computed by the same operation, which has no other use,
+// the operands of that operation in each component are looked at in the same
+// way, and so on.  The leaves of the tree found this way must be either
+// constants, which become a constant vector, or components extracted from at
+// most two vectors, which become an OpVectorShuffle or the vector itself.  The
+// tree is then computed with one vector instruction per level.
+//
+// The tree is vectorized only if it removes more instructions than it adds.
+// Vectors whose components were extracted early may now be needed until the
+// OpCompositeConstruct; each vector that the register liveness analysis does
+// not find to be live there already counts as one more instruction.
+class SLPVectorizerPass : public Pass {
+ public:
+  const char* name() const override { return "slp-vectorize"; }
+  Status Process() override;
+
+  IRContext::Analysis GetPreservedAnalyses() override {
+    return IRContext::kAnalysisDefUse |
+           IRContext::kAnalysisInstrToBlockMapping |
+           IRContext::kAnalysisDecorations | IRContext::kAnalysisCombinators |
+           IRContext::kAnalysisCFG | IRContext::kAnalysisDominatorAnalysis |
+           IRContext::kAnalysisLoopAnalysis | IRContext::kAnalysisNameMap |
+           IRContext::kAnalysisConstants | IRContext::kAnalysisTypes;
+  }
+
+ private:
+  // A set of scalars, one per component of a vector, that can be computed as
+  // a vector.
+  struct Node {
+    enum Kind { kOperation, kShuffle, kConstant };
+
+    Kind kind;
+
+    // The instruction computing each component.
+    std::vector<Instruction*> lanes;
+
+    // For kOperation, the indices in the tree of the nodes for each operand.
+    std::vector<size_t> operands;
+
+    // For kShuffle, the one or two vectors the components are extracted from,
+    // and the component of their concatenation for each lane.
+    std::vector<Instruction*> sources;
+    std::vector<uint32_t> components;
+  };
+
+  // The nodes of a tree.  The operands of a node come before it, so the root
+  // is last.
+  using Tree = std::vector<Node>;
+
+  // Vectorizes the tree of scalars computing the components of |construct|,
+  // an OpCompositeConstruct in |block|, if that is profitable.  Returns
+  // Failure if ids ran out.
+  Status VectorizeConstruct(Instruction* construct, BasicBlock* block);
+
+  // Adds the node for |lane_ids|, components of vectors of type
+  // |vector_type_id| computed in |block|, and its operands to |tree|.
+  // Returns false if they cannot be computed as a vector.
+  bool BuildNode(const std::vector<uint32_t>& lane_ids,
+                 uint32_t vector_type_id, BasicBlock* block, Tree* tree);
+
+  // Returns true if |lanes| all compute the same operation, on operands of
+  // their own type, and are only used once.
+  bool AreIsomorphic(const std::vector<Instruction*>& lanes,
+                     BasicBlock* block);
+
+  // Returns true if vectorizing |tree|, built for |construct| in |block|,
+  // removes more than it adds.
+  bool IsProfitable(const Tree& tree, Instruction* construct,
+                    BasicBlock* block);
+
+  // Returns true if |value| is still needed after |inst| in |block|.
+  bool IsLiveAfter(Instruction* value, Instruction* inst, BasicBlock* block);
+
+  // Computes |tree| with vector instructions inserted before |construct| in
+  // |block|, and returns the id of the result, or 0 if ids ran out.
+  uint32_t EmitTree(const Tree& tree, uint32_t vector_type_id,
+                    Instruction* construct, BasicBlock* block);
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_SLP_VECTORIZER_PASS_H_
@@ -88,21 +88,72 @@ std::string SSARewriter::PhiCandidate::PrettyPrint(const CFG* cfg) const {
   return str.str();
 }
 
-SSARewriter::PhiCandidate& SSARewriter::CreatePhiCandidate(uint32_t var_id,
-                                                           BasicBlock* bb) {
-  // TODO(1841): Handle id overflow.
+void SSARewriter::InitializeBlocks(Function* fp) {
+  for (auto& block : *fp) {
+    block_indices_[block.id()] = static_cast<uint32_t>(blocks_.size());
+    blocks_.push_back(&block);
+  }
+
+  block_preds_.resize(blocks_.size());
+  for (uint32_t i = 0; i < blocks_.size(); ++i) {
+    for (uint32_t pred : pass_->cfg()->preds(blocks_[i]->id())) {
+      block_preds_[i].push_back(block_indices_.at(pred));
+    }
+  }
+
+  sealed_blocks_.assign(blocks_.size(), false);
+  def_pages_.resize(blocks_.size());
+}
+
+uint32_t SSARewriter::GetVarIndex(uint32_t var_id) {
+  auto result =
+      var_indices_.emplace(var_id, static_cast<uint32_t>(var_ids_.size()));
+  if (result.second) {
+    var_ids_.push_back(var_id);
+  }
+  return result.first->second;
+}
+
+void SSARewriter::WriteVariable(uint32_t var_index, uint32_t block_index,
+                                uint32_t val_id) {
+  std::vector<uint32_t>& pages = def_pages_[block_index];
+  uint32_t page = var_index / kDefsPageSize;
+  if (page >= pages.size()) {
+    pages.resize(page + 1, 0);
+  }
+  if (pages[page] == 0) {
+    pages[page] = static_cast<uint32_t>(defs_.size()) + 1;
+    defs_.resize(defs_.size() + kDefsPageSize, 0);
+  }
+  defs_[pages[page] - 1 + var_index % kDefsPageSize] = val_id;
+
+  if (auto* pc = GetPhiCandidate(val_id)) {
+    pc->AddUser(blocks_[block_index]->id());
+  }
+}
+
+SSARewriter::PhiCandidate* SSARewriter::CreatePhiCandidate(
+    uint32_t var_index, uint32_t block_index) {
   uint32_t phi_result_id = pass_->context()->TakeNextId();
-  auto result = phi_candidates_.emplace(
-      phi_result_id, PhiCandidate(var_id, phi_result_id, bb));
-  PhiCandidate& phi_candidate = result.first->second;
-  return phi_candidate;
+  if (phi_result_id == 0) {
+    id_overflow_ = true;
+    return nullptr;
+  }
+  uint32_t slot = phi_result_id - first_phi_id_;
+  if (slot >= phi_candidates_.size()) {
+    phi_candidates_.resize(slot + 1);
+  }
+  phi_candidates_[slot] =
+      MakeUnique<PhiCandidate>(var_ids_[var_index], var_index, phi_result_id,
+                               blocks_[block_index], block_index);
+  return phi_candidates_[slot].get();
 }
 
 void SSARewriter::ReplacePhiUsersWith(const PhiCandidate& phi_to_remove,
                                       uint32_t repl_id) {
   for (uint32_t user_id : phi_to_remove.users()) {
     PhiCandidate* user_phi = GetPhiCandidate(user_id);
-    BasicBlock* bb = pass_->context()->get_instr_block(user_id);
+    auto block_it = block_indices_.find(user_id);
     if (user_phi) {
       // If the user is a Phi candidate, replace all arguments that refer to
       // |phi_to_remove.result_id()| with |repl_id|.
@@ -111,16 +162,21 @@ void SSARewriter::ReplacePhiUsersWith(const PhiCandidate& phi_to_remove,
           arg = repl_id;
         }
       }
-    } else if (bb->id() == user_id) {
-      // The phi candidate is the definition of the variable at basic block
-      // |bb|.  We must change this to the replacement.
-      WriteVariable(phi_to_remove.var_id(), bb, repl_id);
+    } else if (block_it != block_indices_.end()) {
+      // The phi candidate is the definition of the variable at the block
+      // labeled |user_id|.  We must change this to the replacement.
+      WriteVariable(phi_to_remove.var_index(), block_it->second, repl_id);
     } else {
-      // For regular loads, traverse the |load_replacement_| table looking for
-      // instances of |phi_to_remove|.
-      for (auto& it : load_replacement_) {
-        if (it.second == phi_to_remove.result_id()) {
-          it.second = repl_id;
+      // For regular loads, update the entry of the load in
+      // |load_replacement_|.  If the replacement is itself a Phi candidate,
+      // the load becomes one of its users, so it is updated again if that
+      // candidate is removed as well.
+      auto it = load_replacement_.find(user_id);
+      if (it != load_replacement_.end() &&
+          it->second == phi_to_remove.result_id()) {
+        it->second = repl_id;
+        if (PhiCandidate* repl_phi = GetPhiCandidate(repl_id)) {
+          repl_phi->AddUser(user_id);
         }
       }
     }
@@ -168,8 +224,7 @@ uint32_t SSARewriter::AddPhiOperands(PhiCandidate* phi_candidate) {
          "Phi candidate already has arguments");
 
   bool found_0_arg = false;
-  for (uint32_t pred : pass_->cfg()->preds(phi_candidate->bb()->id())) {
-    BasicBlock* pred_bb = pass_->cfg()->block(pred);
+  for (uint32_t pred : block_preds_[phi_candidate->block_index()]) {
 
     // If |pred_bb| is not sealed, use %0 to indicate that
     // |phi_candidate| needs to be completed after the whole CFG has
@@ -204,8 +259,8 @@ uint32_t SSARewriter::AddPhiOperands(PhiCandidate* phi_candidate) {
     // By making the argument %0, we make |phi_candidate| incomplete,
     // which will cause it to be completed after the whole CFG has
     // been scanned.
-    uint32_t arg_id = IsBlockSealed(pred_bb)
-                          ? GetReachingDef(phi_candidate->var_id(), pred_bb)
+    uint32_t arg_id = IsBlockSealed(pred)
+                          ? GetReachingDef(phi_candidate->var_index(), pred)
                           : 0;
     phi_candidate->phi_args().push_back(arg_id);
 
@@ -241,57 +296,56 @@ uint32_t SSARewriter::AddPhiOperands(PhiCandidate* phi_candidate) {
   return repl_id;
 }
 
-uint32_t SSARewriter::GetReachingDef(uint32_t var_id, BasicBlock* bb) {
-  // If |var_id| has a definition in |bb|, return it.
-  const auto& bb_it = defs_at_block_.find(bb);
-  if (bb_it != defs_at_block_.end()) {
-    const auto& current_defs = bb_it->second;
-    const auto& var_it = current_defs.find(var_id);
-    if (var_it != current_defs.end()) {
-      return var_it->second;
-    }
+uint32_t SSARewriter::GetReachingDef(uint32_t var_index,
+                                     uint32_t block_index) {
+  // If the variable has a definition in the block, return it.
+  uint32_t val_id = GetDef(var_index, block_index);
+  if (val_id != 0) {
+    return val_id;
   }
 
-  // Otherwise, look up the value for |var_id| in |bb|'s predecessors.
-  uint32_t val_id = 0;
-  auto& predecessors = pass_->cfg()->preds(bb->id());
+  // Otherwise, look up the value for the variable in the block's
+  // predecessors.
+  const std::vector<uint32_t>& predecessors = block_preds_[block_index];
   if (predecessors.size() == 1) {
-    // If |bb| has exactly one predecessor, we look for |var_id|'s definition
-    // there.
-    val_id = GetReachingDef(var_id, pass_->cfg()->block(predecessors[0]));
+    // If the block has exactly one predecessor, we look for the variable's
+    // definition there.
+    val_id = GetReachingDef(var_index, predecessors[0]);
   } else if (predecessors.size() > 1) {
     // If there is more than one predecessor, this is a join block which may
-    // require a Phi instruction.  This will act as |var_id|'s current
+    // require a Phi instruction.  This will act as the variable's current
     // definition to break potential cycles.
-    PhiCandidate& phi_candidate = CreatePhiCandidate(var_id, bb);
+    PhiCandidate* phi_candidate = CreatePhiCandidate(var_index, block_index);
+    if (phi_candidate == nullptr) {
+      return 0;
+    }
 
-    // Set the value for |bb| to avoid an infinite recursion.
-    WriteVariable(var_id, bb, phi_candidate.result_id());
-    val_id = AddPhiOperands(&phi_candidate);
+    // Set the value for the block to avoid an infinite recursion.
+    WriteVariable(var_index, block_index, phi_candidate->result_id());
+    val_id = AddPhiOperands(phi_candidate);
   }
 
   // If we could not find a store for this variable in the path from the root
   // of the CFG, the variable is not defined, so we use undef.
   if (val_id == 0) {
-    val_id = pass_->GetUndefVal(var_id);
+    val_id = pass_->GetUndefVal(var_ids_[var_index]);
     if (val_id == 0) {
       return 0;
     }
   }
 
-  WriteVariable(var_id, bb, val_id);
+  WriteVariable(var_index, block_index, val_id);
 
   return val_id;
 }
 
-void SSARewriter::SealBlock(BasicBlock* bb) {
-  auto result = sealed_blocks_.insert(bb);
-  (void)result;
-  assert(result.second == true &&
+void SSARewriter::SealBlock(uint32_t block_index) {
+  assert(!sealed_blocks_[block_index] &&
          "Tried to seal the same basic block more than once.");
+  sealed_blocks_[block_index] = true;
 }
 
-void SSARewriter::ProcessStore(Instruction* inst, BasicBlock* bb) {
+void SSARewriter::ProcessStore(Instruction* inst, uint32_t block_index) {
   auto opcode = inst->opcode();
   assert((opcode == SpvOpStore || opcode == SpvOpVariable) &&
          "Expecting a store or a variable definition instruction.");
@@ -306,7 +360,7 @@ void SSARewriter::ProcessStore(Instruction* inst, BasicBlock* bb) {
     val_id = inst->GetSingleWordInOperand(kVariableInitIdInIdx);
   }
   if (pass_->IsTargetVar(var_id)) {
-    WriteVariable(var_id, bb, val_id);
+    WriteVariable(GetVarIndex(var_id), block_index, val_id);
 
 #if SSA_REWRITE_DEBUGGING_LEVEL > 1
     std::cerr << "\tFound store '%" << var_id << " = %" << val_id << "': "
@@ -316,12 +370,12 @@ void SSARewriter::ProcessStore(Instruction* inst, BasicBlock* bb) {
   }
 }
 
-bool SSARewriter::ProcessLoad(Instruction* inst, BasicBlock* bb) {
+bool SSARewriter::ProcessLoad(Instruction* inst, uint32_t block_index) {
   uint32_t var_id = 0;
   (void)pass_->GetPtr(inst, &var_id);
   if (pass_->IsTargetVar(var_id)) {
     // Get the immediate reaching definition for |var_id|.
-    uint32_t val_id = GetReachingDef(var_id, bb);
+    uint32_t val_id = GetReachingDef(GetVarIndex(var_id), block_index);
     if (val_id == 0) {
       return false;
     }
@@ -348,9 +402,12 @@ bool SSARewriter::ProcessLoad(Instruction* inst, BasicBlock* bb) {
 
 void SSARewriter::PrintPhiCandidates() const {
   std::cerr << "\nPhi candidates:\n";
-  for (const auto& phi_it : phi_candidates_) {
-    std::cerr << "\tBB %" << phi_it.second.bb()->id() << ": "
-              << phi_it.second.PrettyPrint(pass_->cfg()) << "\n";
+  for (const auto& phi_candidate : phi_candidates_) {
+    if (phi_candidate == nullptr) {
+      continue;
+    }
+    std::cerr << "\tBB %" << phi_candidate->bb()->id() << ": "
+              << phi_candidate->PrettyPrint(pass_->cfg()) << "\n";
   }
   std::cerr << "\n";
 }
@@ -370,12 +427,13 @@ bool SSARewriter::GenerateSSAReplacements(BasicBlock* bb) {
             << "\n";
 #endif
 
+  uint32_t block_index = block_indices_.at(bb->id());
   for (auto& inst : *bb) {
     auto opcode = inst.opcode();
     if (opcode == SpvOpStore || opcode == SpvOpVariable) {
-      ProcessStore(&inst, bb);
+      ProcessStore(&inst, block_index);
     } else if (inst.opcode() == SpvOpLoad) {
-      if (!ProcessLoad(&inst, bb)) {
+      if (!ProcessLoad(&inst, block_index)) {
         return false;
       }
     }
@@ -383,7 +441,7 @@ bool SSARewriter::GenerateSSAReplacements(BasicBlock* bb) {
 
   // Seal |bb|. This means that all the stores in it have been scanned and it's
   // ready to feed them into its successors.
-  SealBlock(bb);
+  SealBlock(block_index);
 
 #if SSA_REWRITE_DEBUGGING_LEVEL > 1
   PrintPhiCandidates();
@@ -531,14 +589,13 @@ void SSARewriter::FinalizePhiCandidate(PhiCandidate* phi_candidate) {
          "Phi candidate should have arguments");
 
   uint32_t ix = 0;
-  for (uint32_t pred : pass_->cfg()->preds(phi_candidate->bb()->id())) {
-    BasicBlock* pred_bb = pass_->cfg()->block(pred);
+  for (uint32_t pred : block_preds_[phi_candidate->block_index()]) {
     uint32_t& arg_id = phi_candidate->phi_args()[ix++];
     if (arg_id == 0) {
-      // If |pred_bb| is still not sealed, it means it's unreachable. In this
+      // If |pred| is still not sealed, it means it's unreachable. In this
       // case, we just use Undef as an argument.
-      arg_id = IsBlockSealed(pred_bb)
-                   ? GetReachingDef(phi_candidate->var_id(), pred_bb)
+      arg_id = IsBlockSealed(pred)
+                   ? GetReachingDef(phi_candidate->var_index(), pred)
                    : pass_->GetUndefVal(phi_candidate->var_id());
     }
   }
@@ -578,6 +635,7 @@ Pass::Status SSARewriter::RewriteFunctionIntoSSA(Function* fp) {
 
   // Collect variables that can be converted into SSA IDs.
   pass_->CollectTargetVars(fp);
+  InitializeBlocks(fp);
 
   // Generate all the SSA replacements and Phi candidates. This will
   // generate incomplete and trivial Phis.
@@ -589,12 +647,15 @@ Pass::Status SSARewriter::RewriteFunctionIntoSSA(Function* fp) {
         return true;
       });
 
-  if (!succeeded) {
+  if (!succeeded || id_overflow_) {
     return Pass::Status::Failure;
   }
 
   // Remove trivial Phis and add arguments to incomplete Phis.
   FinalizePhiCandidates();
+  if (id_overflow_) {
+    return Pass::Status::Failure;
+  }
 
   // Finally, apply all the replacements in the IR.
   bool modified = ApplyReplacements();
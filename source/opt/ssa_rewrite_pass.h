@@ -15,10 +15,10 @@
 #ifndef SOURCE_OPT_SSA_REWRITE_PASS_H_
 #define SOURCE_OPT_SSA_REWRITE_PASS_H_
 
+#include <memory>
 #include <queue>
 #include <string>
 #include <unordered_map>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -53,18 +53,23 @@ class SSARewriter {
  private:
   class PhiCandidate {
    public:
-    explicit PhiCandidate(uint32_t var, uint32_t result, BasicBlock* block)
+    explicit PhiCandidate(uint32_t var, uint32_t var_index, uint32_t result,
+                          BasicBlock* block, uint32_t block_index)
         : var_id_(var),
+          var_index_(var_index),
           result_id_(result),
           bb_(block),
+          block_index_(block_index),
           phi_args_(),
           copy_of_(0),
           is_complete_(false),
           users_() {}
 
     uint32_t var_id() const { return var_id_; }
+    uint32_t var_index() const { return var_index_; }
     uint32_t result_id() const { return result_id_; }
     BasicBlock* bb() const { return bb_; }
+    uint32_t block_index() const { return block_index_; }
     std::vector<uint32_t>& phi_args() { return phi_args_; }
     const std::vector<uint32_t>& phi_args() const { return phi_args_; }
     uint32_t copy_of() const { return copy_of_; }
@@ -95,6 +100,9 @@ class SSARewriter {
     // Variable ID that this Phi is merging.
     uint32_t var_id_;
 
+    // Index of |var_id_| in the rewriter's variable table.
+    uint32_t var_index_;
+
     // SSA ID generated by this Phi (i.e., this is the result ID of the eventual
     // Phi instruction).
     uint32_t result_id_;
@@ -102,6 +110,9 @@ class SSARewriter {
     // Basic block to hold this Phi.
     BasicBlock* bb_;
 
+    // Index of |bb_| in the rewriter's block table.
+    uint32_t block_index_;
+
     // Vector of operands for every predecessor block of |bb|.  This vector is
     // organized so that the Ith slot contains the argument coming from the Ith
     // predecessor of |bb|.
@@ -121,28 +132,50 @@ class SSARewriter {
     std::vector<uint32_t> users_;
   };
 
-  // Type used to keep track of store operations in each basic block.
-  typedef std::unordered_map<BasicBlock*,
-                             std::unordered_map<uint32_t, uint32_t>>
-      BlockDefsMap;
+  // Variables are tracked in pages of this many entries in the table of
+  // definitions at each block.
+  static const uint32_t kDefsPageSize = 16;
+
+  // Numbers the blocks of |fp| and records the predecessors of each of them,
+  // so the rewriter can refer to blocks by index.
+  void InitializeBlocks(Function* fp);
+
+  // Returns the index of variable |var_id| in |var_ids_|, adding it if it is
+  // not there yet.
+  uint32_t GetVarIndex(uint32_t var_id);
+
+  // Returns the definition of the variable with index |var_index| recorded in
+  // the block with index |block_index|, or 0 if there is none.
+  uint32_t GetDef(uint32_t var_index, uint32_t block_index) const {
+    const std::vector<uint32_t>& pages = def_pages_[block_index];
+    uint32_t page = var_index / kDefsPageSize;
+    if (page >= pages.size() || pages[page] == 0) {
+      return 0;
+    }
+    return defs_[pages[page] - 1 + var_index % kDefsPageSize];
+  }
 
   // Generates all the SSA rewriting decisions for basic block |bb|.  This
   // populates the Phi candidate table (|phi_candidate_|) and the load
   // replacement table (|load_replacement_).  Returns true if successful.
   bool GenerateSSAReplacements(BasicBlock* bb);
 
-  // Seals block |bb|.  Sealing a basic block means |bb| and all its
-  // predecessors of |bb| have been scanned for loads/stores.
-  void SealBlock(BasicBlock* bb);
+  // Seals the block with index |block_index|.  Sealing a basic block means
+  // the block and all its predecessors have been scanned for loads/stores.
+  void SealBlock(uint32_t block_index);
 
-  // Returns true if |bb| has been sealed.
-  bool IsBlockSealed(BasicBlock* bb) { return sealed_blocks_.count(bb) != 0; }
+  // Returns true if the block with index |block_index| has been sealed.
+  bool IsBlockSealed(uint32_t block_index) const {
+    return sealed_blocks_[block_index];
+  }
 
   // Returns the Phi candidate with result ID |id| if it exists in the table
   // |phi_candidates_|. If no such Phi candidate exists, it returns nullptr.
   PhiCandidate* GetPhiCandidate(uint32_t id) {
-    auto it = phi_candidates_.find(id);
-    return (it != phi_candidates_.end()) ? &it->second : nullptr;
+    if (id < first_phi_id_ || id - first_phi_id_ >= phi_candidates_.size()) {
+      return nullptr;
+    }
+    return phi_candidates_[id - first_phi_id_].get();
   }
 
   // Replaces all the users of Phi candidate |phi_cand| to be users of
@@ -184,34 +217,32 @@ class SSARewriter {
   // instructions for them.
   bool ApplyReplacements();
 
-  // Registers a definition for variable |var_id| in basic block |bb| with
-  // value |val_id|.
-  void WriteVariable(uint32_t var_id, BasicBlock* bb, uint32_t val_id) {
-    defs_at_block_[bb][var_id] = val_id;
-    if (auto* pc = GetPhiCandidate(val_id)) {
-      pc->AddUser(bb->id());
-    }
-  }
-
-  // Processes the store operation |inst| in basic block |bb|. This extracts
-  // the variable ID being stored into, determines whether the variable is an
-  // SSA-target variable, and, if it is, it stores its value in the
-  // |defs_at_block_| map.
-  void ProcessStore(Instruction* inst, BasicBlock* bb);
-
-  // Processes the load operation |inst| in basic block |bb|. This extracts
-  // the variable ID being stored into, determines whether the variable is an
-  // SSA-target variable, and, if it is, it reads its reaching definition by
-  // calling |GetReachingDef|.  Returns true if successful.
-  bool ProcessLoad(Instruction* inst, BasicBlock* bb);
-
-  // Reads the current definition for variable |var_id| in basic block |bb|.
-  // If |var_id| is not defined in block |bb| it walks up the predecessors of
-  // |bb|, creating new Phi candidates along the way, if needed.
+  // Registers a definition for the variable with index |var_index| in the
+  // block with index |block_index| with value |val_id|.
+  void WriteVariable(uint32_t var_index, uint32_t block_index,
+                     uint32_t val_id);
+
+  // Processes the store operation |inst| in the block with index
+  // |block_index|. This extracts the variable ID being stored into,
+  // determines whether the variable is an SSA-target variable, and, if it is,
+  // it stores its value in the |defs_| table.
+  void ProcessStore(Instruction* inst, uint32_t block_index);
+
+  // Processes the load operation |inst| in the block with index
+  // |block_index|. This extracts the variable ID being stored into,
+  // determines whether the variable is an SSA-target variable, and, if it is,
+  // it reads its reaching definition by calling |GetReachingDef|.  Returns
+  // true if successful.
+  bool ProcessLoad(Instruction* inst, uint32_t block_index);
+
+  // Reads the current definition for the variable with index |var_index| in
+  // the block with index |block_index|.  If the variable is not defined in
+  // the block it walks up the predecessors of the block, creating new Phi
+  // candidates along the way, if needed.
   //
-  // It returns the value for |var_id| from the RHS of the current reaching
-  // definition for |var_id|.
-  uint32_t GetReachingDef(uint32_t var_id, BasicBlock* bb);
+  // It returns the value for the variable from the RHS of the current
+  // reaching definition for it.
+  uint32_t GetReachingDef(uint32_t var_index, uint32_t block_index);
 
   // Adds arguments to |phi_candidate| by getting the reaching definition of
   // |phi_candidate|'s variable on each of the predecessors of its basic
@@ -220,16 +251,17 @@ class SSARewriter {
   // this Phi copies.
   uint32_t AddPhiOperands(PhiCandidate* phi_candidate);
 
-  // Creates a Phi candidate instruction for variable |var_id| in basic block
-  // |bb|.
+  // Creates a Phi candidate instruction for the variable with index
+  // |var_index| in the block with index |block_index|.
   //
   // Since the rewriting algorithm may remove Phi candidates when it finds
   // them to be trivial, we avoid the expense of creating actual Phi
   // instructions by keeping a pool of Phi candidates (|phi_candidates_|)
   // during rewriting.
   //
-  // Once the candidate Phi is created, it returns its ID.
-  PhiCandidate& CreatePhiCandidate(uint32_t var_id, BasicBlock* bb);
+  // Once the candidate Phi is created, it returns its ID.  Returns nullptr if
+  // no ID is left for the Phi.
+  PhiCandidate* CreatePhiCandidate(uint32_t var_index, uint32_t block_index);
 
   // Attempts to remove a trivial Phi candidate |phi_cand|. Trivial Phis are
   // those that only reference themselves and one other value |val| any number
@@ -256,16 +288,41 @@ class SSARewriter {
   // Prints the load replacement table to std::cerr.
   void PrintReplacementTable() const;
 
-  // Map holding the value of every SSA-target variable at every basic block
-  // where the variable is stored. defs_at_block_[block][var_id] = val_id
-  // means that there is a store or Phi instruction for variable |var_id| at
-  // basic block |block| with value |val_id|.
-  BlockDefsMap defs_at_block_;
+  // The blocks of the function being rewritten, in function order.  Blocks
+  // are referred to by their index in this table.
+  std::vector<BasicBlock*> blocks_;
+
+  // Maps the label of each block in |blocks_| to its index.
+  std::unordered_map<uint32_t, uint32_t> block_indices_;
+
+  // The indices of the predecessors of each block, in the order of
+  // CFG::preds.
+  std::vector<std::vector<uint32_t>> block_preds_;
+
+  // The SSA-target variables seen so far.  Variables are referred to by their
+  // index in this table.
+  std::vector<uint32_t> var_ids_;
 
-  // Map, indexed by Phi ID, holding all the Phi candidates created during SSA
-  // rewriting.  |phi_candidates_[id]| returns the Phi candidate whose result
-  // is |id|.
-  std::unordered_map<uint32_t, PhiCandidate> phi_candidates_;
+  // Maps each variable in |var_ids_| to its index.
+  std::unordered_map<uint32_t, uint32_t> var_indices_;
+
+  // Table holding the value of every SSA-target variable at every basic block
+  // where the variable is stored.  The definitions of the variables of a
+  // block are kept in pages of kDefsPageSize consecutive variables, which are
+  // allocated in |defs_| the first time one of their variables is defined in
+  // the block.  |def_pages_[block_index][page]| is 1 plus the offset of the
+  // page in |defs_|, or 0 if the page has not been allocated.
+  //
+  // A value |val_id| for a variable means that there is a store or Phi
+  // instruction for the variable at the block with value |val_id|.  0 means
+  // that there is none.
+  std::vector<std::vector<uint32_t>> def_pages_;
+  std::vector<uint32_t> defs_;
+
+  // Table, indexed by Phi ID minus |first_phi_id_|, holding all the Phi
+  // candidates created during SSA rewriting.  Ids taken by other
+  // instructions while rewriting have no candidate.
+  std::vector<std::unique_ptr<PhiCandidate>> phi_candidates_;
 
   // Queue of incomplete Phi candidates. These are Phi candidates created at
   // unsealed blocks. They need to be completed before they are instantiated
@@ -282,8 +339,8 @@ class SSARewriter {
   // is done to replace all uses of the original load ID with the value ID.
   std::unordered_map<uint32_t, uint32_t> load_replacement_;
 
-  // Set of blocks that have been sealed already.
-  std::unordered_set<BasicBlock*> sealed_blocks_;
+  // For each block, true if it has been sealed already.
+  std::vector<bool> sealed_blocks_;
 
   // Memory pass requesting the SSA rewriter.
   MemPass* pass_;
@@ -291,6 +348,9 @@ class SSARewriter {
   // ID of the first Phi created by the SSA rewriter.  During rewriting, any
   // ID bigger than this corresponds to a Phi candidate.
   uint32_t first_phi_id_;
+
+  // True if a Phi candidate could not be created because the IDs ran out.
+  bool id_overflow_ = false;
 };
 
 class SSARewritePass : public MemPass {
@@ -39,6 +39,16 @@ TypeManager::TypeManager(const MessageConsumer& consumer, IRContext* c)
   AnalyzeTypes(*c->module());
 }
 
+void TypeManager::Clear() {
+  // The maps refer to the types owned by the pool, so empty them first.
+  id_to_type_.clear();
+  type_to_id_.clear();
+  id_to_incomplete_type_.clear();
+  incomplete_types_.clear();
+  id_to_constant_inst_.clear();
+  type_pool_.clear();
+}
+
 Type* TypeManager::GetType(uint32_t id) const {
   auto iter = id_to_type_.find(id);
   if (iter != id_to_type_.end()) return (*iter).second;
@@ -83,6 +83,15 @@ class TypeManager {
   TypeManager& operator=(const TypeManager&) = delete;
   TypeManager& operator=(TypeManager&&) = delete;
 
+  // Discards all types, so that the manager can be reused for another module.
+  void Clear();
+
+  // Discards all types and analyzes the types in |module| again.
+  void Reanalyze(const Module& module) {
+    Clear();
+    AnalyzeTypes(module);
+  }
+
   // Returns the type for the given type |id|. Returns nullptr if the given |id|
   // does not define a type.
   Type* GetType(uint32_t id) const;
@@ -111,40 +111,64 @@ uint32_t ValueNumberTable::AssignValueNumber(Instruction* inst) {
     }
   }
 
+  // TODO: Implement a normal form for opcodes that commute like integer
+  // addition.  This will let us know that a+b is the same value as b+a.
+
+  // Otherwise, we check if this value has been computed before.
+  ValueSignature signature = AddSignature(inst);
+  auto value_iterator = signature_to_value_.find(signature);
+  if (value_iterator != signature_to_value_.end()) {
+    // The words of |signature| are not needed anymore.
+    signature_words_.resize(signature.begin);
+    value = value_iterator->second;
+    id_to_value_[inst->result_id()] = value;
+    return value;
+  }
+
+  // If not, assign it a new value number.
+  value = TakeNextValueNumber();
+  id_to_value_[inst->result_id()] = value;
+  signature_to_value_[signature] = value;
+  return value;
+}
+
+ValueNumberTable::ValueSignature ValueNumberTable::AddSignature(
+    const Instruction* inst) {
+  ValueSignature signature;
+  signature.begin = static_cast<uint32_t>(signature_words_.size());
+  signature.result_id = inst->result_id();
+
+  signature_words_.push_back(inst->opcode());
+  signature_words_.push_back(inst->type_id());
+
   // Replace all of the operands by their value number.  The sign bit will be
   // set to distinguish between an id and a value number.
-  Instruction value_ins(context(), inst->opcode(), inst->type_id(),
-                        inst->result_id(), {});
   for (uint32_t o = 0; o < inst->NumInOperands(); ++o) {
     const Operand& op = inst->GetInOperand(o);
+    signature_words_.push_back(op.type);
+    signature_words_.push_back(static_cast<uint32_t>(op.words.size()));
     if (spvIsIdType(op.type)) {
       uint32_t id_value = op.words[0];
       auto use_id_to_val = id_to_value_.find(id_value);
       if (use_id_to_val != id_to_value_.end()) {
         id_value = (1 << 31) | use_id_to_val->second;
       }
-      value_ins.AddOperand(Operand(op.type, {id_value}));
+      signature_words_.push_back(id_value);
     } else {
-      value_ins.AddOperand(Operand(op.type, op.words));
+      signature_words_.insert(signature_words_.end(), op.words.begin(),
+                              op.words.end());
     }
   }
 
-  // TODO: Implement a normal form for opcodes that commute like integer
-  // addition.  This will let us know that a+b is the same value as b+a.
+  signature.size =
+      static_cast<uint32_t>(signature_words_.size()) - signature.begin;
 
-  // Otherwise, we check if this value has been computed before.
-  auto value_iterator = instruction_to_value_.find(value_ins);
-  if (value_iterator != instruction_to_value_.end()) {
-    value = id_to_value_[value_iterator->first.result_id()];
-    id_to_value_[inst->result_id()] = value;
-    return value;
+  size_t hash = 0;
+  for (uint32_t i = signature.begin; i < signature_words_.size(); ++i) {
+    hash = hash * 31 + signature_words_[i];
   }
-
-  // If not, assign it a new value number.
-  value = TakeNextValueNumber();
-  id_to_value_[inst->result_id()] = value;
-  instruction_to_value_[value_ins] = value;
-  return value;
+  signature.hash = hash;
+  return signature;
 }
 
 void ValueNumberTable::BuildDominatorTreeValueNumberTable() {
@@ -186,48 +210,21 @@ void ValueNumberTable::BuildDominatorTreeValueNumberTable() {
   }
 }
 
-bool ComputeSameValue::operator()(const Instruction& lhs,
-                                  const Instruction& rhs) const {
-  if (lhs.result_id() == 0 || rhs.result_id() == 0) {
+bool ValueNumberTable::SignatureEqual::operator()(
+    const ValueSignature& lhs, const ValueSignature& rhs) const {
+  if (lhs.hash != rhs.hash || lhs.size != rhs.size) {
     return false;
   }
 
-  if (lhs.opcode() != rhs.opcode()) {
+  const auto& words = table_->signature_words_;
+  if (!std::equal(words.begin() + lhs.begin,
+                  words.begin() + lhs.begin + lhs.size,
+                  words.begin() + rhs.begin)) {
     return false;
   }
 
-  if (lhs.type_id() != rhs.type_id()) {
-    return false;
-  }
-
-  if (lhs.NumInOperands() != rhs.NumInOperands()) {
-    return false;
-  }
-
-  for (uint32_t i = 0; i < lhs.NumInOperands(); ++i) {
-    if (lhs.GetInOperand(i) != rhs.GetInOperand(i)) {
-      return false;
-    }
-  }
-
-  return lhs.context()->get_decoration_mgr()->HaveTheSameDecorations(
-      lhs.result_id(), rhs.result_id());
-}
-
-std::size_t ValueTableHash::operator()(const Instruction& inst) const {
-  // We hash the opcode and in-operands, not the result, because we want
-  // instructions that are the same except for the result to hash to the
-  // same value.
-  std::u32string h;
-  h.push_back(inst.opcode());
-  h.push_back(inst.type_id());
-  for (uint32_t i = 0; i < inst.NumInOperands(); ++i) {
-    const auto& opnd = inst.GetInOperand(i);
-    for (uint32_t word : opnd.words) {
-      h.push_back(word);
-    }
-  }
-  return std::hash<std::u32string>()(h);
+  return table_->context()->get_decoration_mgr()->HaveTheSameDecorations(
+      lhs.result_id, rhs.result_id);
 }
 }  // namespace opt
 }  // namespace spvtools
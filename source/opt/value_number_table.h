@@ -17,6 +17,7 @@
 
 #include <cstdint>
 #include <unordered_map>
+#include <vector>
 
 #include "source/opt/instruction.h"
 
@@ -25,19 +26,6 @@ namespace opt {
 
 class IRContext;
 
-// Returns true if the two instructions compute the same value.  Used by the
-// value number table to compare two instructions.
-class ComputeSameValue {
- public:
-  bool operator()(const Instruction& lhs, const Instruction& rhs) const;
-};
-
-// The hash function used in the value number table.
-class ValueTableHash {
- public:
-  std::size_t operator()(const Instruction& inst) const;
-};
-
 // This class implements the value number analysis.  It is using a hash-based
 // approach to value numbering.  It is essentially doing dominator-tree value
 // numbering described in
@@ -51,10 +39,16 @@ class ValueTableHash {
 // the scope.
 class ValueNumberTable {
  public:
-  ValueNumberTable(IRContext* ctx) : context_(ctx), next_value_number_(1) {
+  ValueNumberTable(IRContext* ctx)
+      : signature_to_value_(0, SignatureHash(), SignatureEqual(this)),
+        context_(ctx),
+        next_value_number_(1) {
     BuildDominatorTreeValueNumberTable();
   }
 
+  ValueNumberTable(const ValueNumberTable&) = delete;
+  ValueNumberTable& operator=(const ValueNumberTable&) = delete;
+
   // Returns the value number of the value computed by |inst|.  |inst| must have
   // a result id that will hold the computed value.  If no value number has been
   // assigned to the result id, then the return value is 0.
@@ -67,6 +61,41 @@ class ValueNumberTable {
   IRContext* context() const { return context_; }
 
  private:
+  // The value computed by an instruction: its opcode, type and in-operands,
+  // with the ids replaced by their value numbers.  The words describing the
+  // value are kept in |signature_words_|, so a signature itself is small and
+  // no copy of the instruction is needed.
+  struct ValueSignature {
+    // The range of |signature_words_| describing the value.
+    uint32_t begin;
+    uint32_t size;
+    // The result id of the instruction, used to compare decorations.
+    uint32_t result_id;
+    size_t hash;
+  };
+
+  class SignatureHash {
+   public:
+    size_t operator()(const ValueSignature& signature) const {
+      return signature.hash;
+    }
+  };
+
+  // Returns true if the two signatures describe the same value.
+  class SignatureEqual {
+   public:
+    explicit SignatureEqual(const ValueNumberTable* table) : table_(table) {}
+    bool operator()(const ValueSignature& lhs,
+                    const ValueSignature& rhs) const;
+
+   private:
+    const ValueNumberTable* table_;
+  };
+
+  // Appends the words describing the value computed by |inst| to
+  // |signature_words_| and returns its signature.
+  ValueSignature AddSignature(const Instruction* inst);
+
   // Assigns a value number to every result id in the module.
   void BuildDominatorTreeValueNumberTable();
 
@@ -78,8 +107,9 @@ class ValueNumberTable {
   // id.
   uint32_t AssignValueNumber(Instruction* inst);
 
-  std::unordered_map<Instruction, uint32_t, ValueTableHash, ComputeSameValue>
-      instruction_to_value_;
+  std::vector<uint32_t> signature_words_;
+  std::unordered_map<ValueSignature, uint32_t, SignatureHash, SignatureEqual>
+      signature_to_value_;
   std::unordered_map<uint32_t, uint32_t> id_to_value_;
   IRContext* context_;
   uint32_t next_value_number_;
@@ -0,0 +1,781 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/value_range_analysis.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+#include "source/opt/ir_context.h"
+#include "spirv/unified1/GLSL.std.450.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const uint32_t kExtInstSetIdInIdx = 0;
+const uint32_t kExtInstInstructionInIdx = 1;
+const uint32_t kExtInstFirstOperandInIdx = 2;
+const uint32_t kBranchCondConditionInIdx = 0;
+const uint32_t kBranchCondTrueLabelInIdx = 1;
+const uint32_t kBranchCondFalseLabelInIdx = 2;
+const uint32_t kTypeIntWidthInIdx = 0;
+const uint32_t kTypeIntSignednessInIdx = 1;
+
+// The number of times the range of a phi can grow before it is widened.
+const uint32_t kMaxPhiUpdates = 8;
+
+// Returns the comparison that is true when |opcode| is true with its operands
+// swapped.
+SpvOp MirrorComparison(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpSLessThan:
+      return SpvOpSGreaterThan;
+    case SpvOpSLessThanEqual:
+      return SpvOpSGreaterThanEqual;
+    case SpvOpSGreaterThan:
+      return SpvOpSLessThan;
+    case SpvOpSGreaterThanEqual:
+      return SpvOpSLessThanEqual;
+    case SpvOpULessThan:
+      return SpvOpUGreaterThan;
+    case SpvOpULessThanEqual:
+      return SpvOpUGreaterThanEqual;
+    case SpvOpUGreaterThan:
+      return SpvOpULessThan;
+    case SpvOpUGreaterThanEqual:
+      return SpvOpULessThanEqual;
+    default:
+      return opcode;
+  }
+}
+
+// Returns the comparison that is true when |opcode| is false.
+SpvOp NegateComparison(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpSLessThan:
+      return SpvOpSGreaterThanEqual;
+    case SpvOpSLessThanEqual:
+      return SpvOpSGreaterThan;
+    case SpvOpSGreaterThan:
+      return SpvOpSLessThanEqual;
+    case SpvOpSGreaterThanEqual:
+      return SpvOpSLessThan;
+    case SpvOpULessThan:
+      return SpvOpUGreaterThanEqual;
+    case SpvOpULessThanEqual:
+      return SpvOpUGreaterThan;
+    case SpvOpUGreaterThan:
+      return SpvOpULessThanEqual;
+    case SpvOpUGreaterThanEqual:
+      return SpvOpULessThan;
+    case SpvOpIEqual:
+      return SpvOpINotEqual;
+    case SpvOpINotEqual:
+      return SpvOpIEqual;
+    default:
+      return opcode;
+  }
+}
+
+bool IsIntegerComparison(SpvOp opcode) {
+  switch (opcode) {
+    case SpvOpSLessThan:
+    case SpvOpSLessThanEqual:
+    case SpvOpSGreaterThan:
+    case SpvOpSGreaterThanEqual:
+    case SpvOpULessThan:
+    case SpvOpULessThanEqual:
+    case SpvOpUGreaterThan:
+    case SpvOpUGreaterThanEqual:
+    case SpvOpIEqual:
+    case SpvOpINotEqual:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool IsUnsignedComparison(SpvOp opcode) {
+  return opcode == SpvOpULessThan || opcode == SpvOpULessThanEqual ||
+         opcode == SpvOpUGreaterThan || opcode == SpvOpUGreaterThanEqual;
+}
+
+// Returns the range of the result of the integer comparison |opcode| on
+// values in |a| and |b|.
+ValueRange CompareRanges(SpvOp opcode, const ValueRange& a,
+                         const ValueRange& b) {
+  const ValueRange always_true(1, 1);
+  const ValueRange always_false(0, 0);
+  const ValueRange unknown(0, 1);
+
+  // Unsigned comparisons agree with signed ones on non-negative values.
+  if (IsUnsignedComparison(opcode) &&
+      (!a.IsNonNegative() || !b.IsNonNegative())) {
+    return unknown;
+  }
+
+  switch (opcode) {
+    case SpvOpSLessThan:
+    case SpvOpULessThan:
+      if (a.max < b.min) return always_true;
+      if (a.min >= b.max) return always_false;
+      break;
+    case SpvOpSLessThanEqual:
+    case SpvOpULessThanEqual:
+      if (a.max <= b.min) return always_true;
+      if (a.min > b.max) return always_false;
+      break;
+    case SpvOpSGreaterThan:
+    case SpvOpUGreaterThan:
+      if (a.min > b.max) return always_true;
+      if (a.max <= b.min) return always_false;
+      break;
+    case SpvOpSGreaterThanEqual:
+    case SpvOpUGreaterThanEqual:
+      if (a.min >= b.max) return always_true;
+      if (a.max < b.min) return always_false;
+      break;
+    case SpvOpIEqual:
+      if (a.IsSingleValue() && b.IsSingleValue() && a.min == b.min)
+        return always_true;
+      if (a.Intersect(b).IsEmpty()) return always_false;
+      break;
+    case SpvOpINotEqual:
+      if (a.IsSingleValue() && b.IsSingleValue() && a.min == b.min)
+        return always_false;
+      if (a.Intersect(b).IsEmpty()) return always_true;
+      break;
+    default:
+      break;
+  }
+  return unknown;
+}
+
+}  // namespace
+
+void ValueRangeAnalysis::Run(Function* func) {
+  function_ = func;
+  ranges_.clear();
+  phi_updates_.clear();
+  reachable_blocks_.clear();
+
+  const auto visit_fn = [this](Instruction* inst, BasicBlock** dest_bb) {
+    return VisitInstruction(inst, dest_bb);
+  };
+  propagator_ =
+      std::unique_ptr<SSAPropagator>(new SSAPropagator(context_, visit_fn));
+  propagator_->Run(func);
+}
+
+bool ValueRangeAnalysis::GetTypeRange(uint32_t type_id, ValueRange* range) {
+  Instruction* type = context_->get_def_use_mgr()->GetDef(type_id);
+  if (type->opcode() == SpvOpTypeBool) {
+    *range = ValueRange(0, 1);
+    return true;
+  }
+  if (type->opcode() == SpvOpTypeInt) {
+    uint32_t width = type->GetSingleWordInOperand(kTypeIntWidthInIdx);
+    if (width > 32) return false;
+    int64_t half = int64_t(1) << (width - 1);
+    *range = ValueRange(-half, half - 1);
+    return true;
+  }
+  return false;
+}
+
+bool ValueRangeAnalysis::IsTracked(uint32_t id) {
+  Instruction* inst = context_->get_def_use_mgr()->GetDef(id);
+  ValueRange type_range;
+  return inst->type_id() != 0 && GetTypeRange(inst->type_id(), &type_range);
+}
+
+bool ValueRangeAnalysis::GetRange(uint32_t id, ValueRange* range) {
+  auto it = ranges_.find(id);
+  if (it != ranges_.end()) {
+    *range = it->second;
+    return true;
+  }
+
+  Instruction* inst = context_->get_def_use_mgr()->GetDef(id);
+  ValueRange type_range;
+  if (inst->type_id() == 0 || !GetTypeRange(inst->type_id(), &type_range)) {
+    return false;
+  }
+
+  switch (inst->opcode()) {
+    case SpvOpConstantTrue:
+      *range = ValueRange(1, 1);
+      return true;
+    case SpvOpConstantFalse:
+    case SpvOpConstantNull:
+      *range = ValueRange(0, 0);
+      return true;
+    case SpvOpConstant: {
+      // Sign-extend the value from the width of its type.
+      int64_t value = inst->GetSingleWordInOperand(0) &
+                      static_cast<uint32_t>(2 * type_range.max + 1);
+      if (value > type_range.max) value -= 2 * (type_range.max + 1);
+      *range = ValueRange(value, value);
+      return true;
+    }
+    default:
+      break;
+  }
+
+  // Values that are not computed in a block, such as function parameters and
+  // specialization constants, can be anything.
+  if (context_->get_instr_block(inst) == nullptr) {
+    *range = type_range;
+    return true;
+  }
+  return false;
+}
+
+bool ValueRangeAnalysis::GetRangeAt(uint32_t id, BasicBlock* block,
+                                    ValueRange* range) {
+  if (!GetRange(id, range)) return false;
+
+  // Each block on the dominator tree path to |block| that has a single
+  // predecessor ending in a conditional branch is only reached when the
+  // condition has the value for that edge.
+  DominatorAnalysis* dom_analysis = context_->GetDominatorAnalysis(function_);
+  BasicBlock* child = block;
+  for (BasicBlock* parent = dom_analysis->ImmediateDominator(child);
+       parent != nullptr && parent != context_->cfg()->pseudo_entry_block();
+       child = parent, parent = dom_analysis->ImmediateDominator(child)) {
+    Instruction* branch = parent->terminator();
+    if (branch->opcode() != SpvOpBranchConditional) continue;
+    uint32_t true_label =
+        branch->GetSingleWordInOperand(kBranchCondTrueLabelInIdx);
+    uint32_t false_label =
+        branch->GetSingleWordInOperand(kBranchCondFalseLabelInIdx);
+    if (true_label == false_label ||
+        context_->cfg()->preds(child->id()).size() != 1) {
+      continue;
+    }
+    NarrowByCondition(
+        id, branch->GetSingleWordInOperand(kBranchCondConditionInIdx),
+        child->id() == true_label, range);
+  }
+  return true;
+}
+
+void ValueRangeAnalysis::NarrowByCondition(uint32_t id, uint32_t condition_id,
+                                           bool value, ValueRange* range) {
+  Instruction* condition =
+      context_->get_def_use_mgr()->GetDef(condition_id);
+  if (condition->opcode() == SpvOpLogicalNot) {
+    NarrowByCondition(id, condition->GetSingleWordInOperand(0), !value,
+                      range);
+    return;
+  }
+  if (!IsIntegerComparison(condition->opcode())) return;
+
+  // Put the comparison in the form |id| <op> constant.  Only constants are
+  // used, since the ranges of other values can still grow.
+  SpvOp opcode = condition->opcode();
+  uint32_t other_id = 0;
+  if (condition->GetSingleWordInOperand(0) == id) {
+    other_id = condition->GetSingleWordInOperand(1);
+  } else if (condition->GetSingleWordInOperand(1) == id) {
+    other_id = condition->GetSingleWordInOperand(0);
+    opcode = MirrorComparison(opcode);
+  } else {
+    return;
+  }
+  SpvOp other_opcode =
+      context_->get_def_use_mgr()->GetDef(other_id)->opcode();
+  ValueRange other;
+  if ((other_opcode != SpvOpConstant && other_opcode != SpvOpConstantNull) ||
+      !GetRange(other_id, &other)) {
+    return;
+  }
+  if (!value) opcode = NegateComparison(opcode);
+
+  const int64_t c = other.min;
+  const int64_t lowest = std::numeric_limits<int64_t>::min();
+  const int64_t highest = std::numeric_limits<int64_t>::max();
+  switch (opcode) {
+    case SpvOpSLessThan:
+      *range = range->Intersect(ValueRange(lowest, c - 1));
+      break;
+    case SpvOpSLessThanEqual:
+      *range = range->Intersect(ValueRange(lowest, c));
+      break;
+    case SpvOpSGreaterThan:
+      *range = range->Intersect(ValueRange(c + 1, highest));
+      break;
+    case SpvOpSGreaterThanEqual:
+      *range = range->Intersect(ValueRange(c, highest));
+      break;
+    case SpvOpIEqual:
+      *range = range->Intersect(ValueRange(c, c));
+      break;
+    case SpvOpINotEqual:
+      if (range->min == c) ++range->min;
+      if (range->max == c) --range->max;
+      break;
+    // An unsigned value below a non-negative constant is non-negative.
+    case SpvOpULessThan:
+      if (c >= 0) *range = range->Intersect(ValueRange(0, c - 1));
+      break;
+    case SpvOpULessThanEqual:
+      if (c >= 0) *range = range->Intersect(ValueRange(0, c));
+      break;
+    // An unsigned value above a constant can be negative, unless it was known
+    // not to be.
+    case SpvOpUGreaterThan:
+      if (c >= 0 && range->IsNonNegative())
+        *range = range->Intersect(ValueRange(c + 1, highest));
+      break;
+    case SpvOpUGreaterThanEqual:
+      if (c >= 0 && range->IsNonNegative())
+        *range = range->Intersect(ValueRange(c, highest));
+      break;
+    default:
+      break;
+  }
+}
+
+SSAPropagator::PropStatus ValueRangeAnalysis::VisitInstruction(
+    Instruction* inst, BasicBlock** dest_bb) {
+  *dest_bb = nullptr;
+  reachable_blocks_.insert(context_->get_instr_block(inst));
+  if (inst->opcode() == SpvOpPhi) {
+    return VisitPhi(inst);
+  } else if (inst->IsBranch()) {
+    return VisitBranch(inst, dest_bb);
+  } else if (inst->result_id()) {
+    return VisitAssignment(inst);
+  }
+  return SSAPropagator::kVarying;
+}
+
+SSAPropagator::PropStatus ValueRangeAnalysis::SetRange(
+    Instruction* inst, const ValueRange& range) {
+  ValueRange type_range;
+  GetTypeRange(inst->type_id(), &type_range);
+
+  auto it = ranges_.find(inst->result_id());
+  bool had_range = it != ranges_.end();
+  bool changed = !had_range || it->second != range;
+  ranges_[inst->result_id()] = range;
+
+  if (range.Contains(type_range)) {
+    return SSAPropagator::kVarying;
+  }
+  // The status stays kInteresting, so the propagator does not notice that
+  // the uses need to be visited again.
+  if (had_range && changed) {
+    propagator_->ValueChanged(inst);
+  }
+  return SSAPropagator::kInteresting;
+}
+
+SSAPropagator::PropStatus ValueRangeAnalysis::VisitPhi(Instruction* phi) {
+  ValueRange type_range;
+  if (!GetTypeRange(phi->type_id(), &type_range)) {
+    return SSAPropagator::kVarying;
+  }
+
+  BasicBlock* phi_block = context_->get_instr_block(phi);
+  ValueRange range;
+  for (uint32_t i = 2; i < phi->NumOperands(); i += 2) {
+    if (!propagator_->IsPhiArgExecutable(phi, i)) continue;
+    uint32_t arg_id = phi->GetSingleWordOperand(i);
+    BasicBlock* pred =
+        context_->cfg()->block(phi->GetSingleWordOperand(i + 1));
+    ValueRange arg;
+    // Arguments that are not known yet are ignored until they are.
+    if (!GetRangeAt(arg_id, pred, &arg)) continue;
+
+    // The edge itself may be taken only when a condition holds.
+    Instruction* branch = pred->terminator();
+    if (branch->opcode() == SpvOpBranchConditional &&
+        branch->GetSingleWordInOperand(kBranchCondTrueLabelInIdx) !=
+            branch->GetSingleWordInOperand(kBranchCondFalseLabelInIdx)) {
+      NarrowByCondition(
+          arg_id, branch->GetSingleWordInOperand(kBranchCondConditionInIdx),
+          branch->GetSingleWordInOperand(kBranchCondTrueLabelInIdx) ==
+              phi_block->id(),
+          &arg);
+    }
+    range = range.Union(arg);
+  }
+
+  auto it = ranges_.find(phi->result_id());
+  if (it == ranges_.end()) {
+    if (range.IsEmpty()) return SSAPropagator::kNotInteresting;
+    return SetRange(phi, range);
+  }
+
+  // Ranges only grow, and a range that keeps growing is widened so that the
+  // propagation terminates.
+  const ValueRange old_range = it->second;
+  range = range.Union(old_range);
+  if (range != old_range && ++phi_updates_[phi->result_id()] > kMaxPhiUpdates) {
+    ValueRange widened = range;
+    if (range.min < old_range.min) widened.min = type_range.min;
+    if (range.max > old_range.max) widened.max = type_range.max;
+    ValueRange induction_range;
+    if (GetInductionRange(phi, type_range, &induction_range) &&
+        induction_range.Contains(range)) {
+      widened = widened.Intersect(induction_range);
+    }
+    range = widened;
+  }
+  return SetRange(phi, range);
+}
+
+SSAPropagator::PropStatus ValueRangeAnalysis::VisitBranch(
+    Instruction* branch, BasicBlock** dest_bb) {
+  BasicBlock* block = context_->get_instr_block(branch);
+  uint32_t dest_label = 0;
+  if (branch->opcode() == SpvOpBranch) {
+    dest_label = branch->GetSingleWordInOperand(0);
+  } else if (branch->opcode() == SpvOpBranchConditional) {
+    ValueRange condition;
+    if (!GetRangeAt(
+            branch->GetSingleWordInOperand(kBranchCondConditionInIdx), block,
+            &condition) ||
+        condition.IsEmpty()) {
+      return SSAPropagator::kNotInteresting;
+    }
+    if (!condition.IsSingleValue()) {
+      return SSAPropagator::kVarying;
+    }
+    dest_label = branch->GetSingleWordInOperand(
+        condition.min ? kBranchCondTrueLabelInIdx : kBranchCondFalseLabelInIdx);
+  } else {
+    assert(branch->opcode() == SpvOpSwitch);
+    uint32_t selector_id = branch->GetSingleWordInOperand(0);
+    if (!IsTracked(selector_id)) {
+      return SSAPropagator::kVarying;
+    }
+    ValueRange selector;
+    if (!GetRangeAt(selector_id, block, &selector) || selector.IsEmpty()) {
+      return SSAPropagator::kNotInteresting;
+    }
+    if (!selector.IsSingleValue()) {
+      return SSAPropagator::kVarying;
+    }
+    // The literals are at most 32 bits wide here.  Those of an unsigned
+    // selector narrower than 32 bits are zero-extended, but the range holds
+    // the sign-extended value.
+    uint32_t value = static_cast<uint32_t>(selector.min);
+    Instruction* selector_type = context_->get_def_use_mgr()->GetDef(
+        context_->get_def_use_mgr()->GetDef(selector_id)->type_id());
+    uint32_t width = selector_type->GetSingleWordInOperand(kTypeIntWidthInIdx);
+    if (width < 32 &&
+        selector_type->GetSingleWordInOperand(kTypeIntSignednessInIdx) == 0) {
+      value &= (uint32_t(1) << width) - 1;
+    }
+    dest_label = branch->GetSingleWordInOperand(1);
+    for (uint32_t i = 2; i < branch->NumInOperands(); i += 2) {
+      if (branch->GetSingleWordInOperand(i) == value) {
+        dest_label = branch->GetSingleWordInOperand(i + 1);
+        break;
+      }
+    }
+  }
+
+  *dest_bb = context_->cfg()->block(dest_label);
+  return SSAPropagator::kInteresting;
+}
+
+SSAPropagator::PropStatus ValueRangeAnalysis::VisitAssignment(
+    Instruction* inst) {
+  ValueRange type_range;
+  if (!GetTypeRange(inst->type_id(), &type_range)) {
+    return SSAPropagator::kVarying;
+  }
+
+  ValueRange range;
+  auto it = ranges_.find(inst->result_id());
+  if (!ComputeRange(inst, context_->get_instr_block(inst), type_range,
+                    &range)) {
+    if (it == ranges_.end()) return SSAPropagator::kNotInteresting;
+    range = it->second;
+  }
+  // Results that do not fit in the type wrap around.
+  if (!type_range.Contains(range)) range = type_range;
+  if (it != ranges_.end()) range = range.Union(it->second);
+  return SetRange(inst, range);
+}
+
+bool ValueRangeAnalysis::ComputeRange(Instruction* inst, BasicBlock* block,
+                                      const ValueRange& type_range,
+                                      ValueRange* range) {
+  *range = type_range;
+  if (inst->opcode() == SpvOpExtInst) {
+    return ComputeExtInstRange(inst, block, type_range, range);
+  }
+
+  // Nothing is known about operations on values that are not tracked.
+  if (!inst->WhileEachInId(
+          [this](const uint32_t* id) { return IsTracked(*id); })) {
+    return true;
+  }
+
+  ValueRange a;
+  ValueRange b;
+  auto get_operand = [this, inst, block](uint32_t in_idx, ValueRange* r) {
+    return GetRangeAt(inst->GetSingleWordInOperand(in_idx), block, r) &&
+           !r->IsEmpty();
+  };
+  auto get_operands = [&get_operand, &a, &b]() {
+    return get_operand(0, &a) && get_operand(1, &b);
+  };
+
+  switch (inst->opcode()) {
+    case SpvOpCopyObject:
+      return get_operand(0, range);
+    case SpvOpIAdd:
+      if (!get_operands()) return false;
+      *range = ValueRange(a.min + b.min, a.max + b.max);
+      break;
+    case SpvOpISub:
+      if (!get_operands()) return false;
+      *range = ValueRange(a.min - b.max, a.max - b.min);
+      break;
+    case SpvOpIMul: {
+      if (!get_operands()) return false;
+      int64_t products[] = {a.min * b.min, a.min * b.max, a.max * b.min,
+                            a.max * b.max};
+      *range = ValueRange(*std::min_element(products, products + 4),
+                          *std::max_element(products, products + 4));
+      break;
+    }
+    case SpvOpSNegate:
+      if (!get_operand(0, &a)) return false;
+      *range = ValueRange(-a.max, -a.min);
+      break;
+    case SpvOpBitwiseAnd:
+      if (!get_operands()) return false;
+      if (a.IsNonNegative() && b.IsNonNegative()) {
+        *range = ValueRange(0, std::min(a.max, b.max));
+      } else if (a.IsNonNegative()) {
+        *range = ValueRange(0, a.max);
+      } else if (b.IsNonNegative()) {
+        *range = ValueRange(0, b.max);
+      }
+      break;
+    case SpvOpUMod:
+      if (!get_operands()) return false;
+      if (b.min >= 1) {
+        if (a.IsNonNegative() && a.max < b.min) {
+          *range = a;
+        } else if (a.IsNonNegative()) {
+          *range = ValueRange(0, std::min(a.max, b.max - 1));
+        } else {
+          *range = ValueRange(0, b.max - 1);
+        }
+      }
+      break;
+    case SpvOpShiftRightLogical:
+    case SpvOpShiftRightArithmetic: {
+      if (!get_operands()) return false;
+      int64_t width = 0;
+      while ((int64_t(1) << width) <= type_range.max) ++width;
+      if (b.min < 0 || b.max > width) break;
+      if (a.IsNonNegative() || inst->opcode() == SpvOpShiftRightArithmetic) {
+        *range = ValueRange(std::min(a.min >> b.min, a.min >> b.max),
+                            std::max(a.max >> b.min, a.max >> b.max));
+      } else if (b.min >= 1) {
+        // A negative value is a large unsigned value.
+        *range = ValueRange(0, (2 * type_range.max + 1) >> b.min);
+      }
+      break;
+    }
+    case SpvOpSelect: {
+      ValueRange condition;
+      if (!get_operand(0, &condition)) return false;
+      if (condition.min == 1) return get_operand(1, range);
+      if (condition.max == 0) return get_operand(2, range);
+      if (!get_operand(1, &a) || !get_operand(2, &b)) return false;
+      *range = a.Union(b);
+      break;
+    }
+    case SpvOpSConvert:
+      if (!get_operand(0, &a)) return false;
+      if (type_range.Contains(a)) *range = a;
+      break;
+    case SpvOpUConvert:
+    case SpvOpBitcast: {
+      if (!get_operand(0, &a)) return false;
+      ValueRange operand_type_range;
+      GetTypeRange(context_->get_def_use_mgr()
+                       ->GetDef(inst->GetSingleWordInOperand(0))
+                       ->type_id(),
+                   &operand_type_range);
+      if (a.IsNonNegative() || operand_type_range == type_range) {
+        // The value is the same, whatever the signedness of the types.
+        *range = a;
+      } else if (inst->opcode() == SpvOpUConvert) {
+        // Zero extension makes negative values positive.
+        const int64_t modulus = 2 * (operand_type_range.max + 1);
+        if (a.max < 0) {
+          *range = ValueRange(a.min + modulus, a.max + modulus);
+        } else {
+          *range = ValueRange(0, modulus - 1);
+        }
+      }
+      break;
+    }
+    case SpvOpSLessThan:
+    case SpvOpSLessThanEqual:
+    case SpvOpSGreaterThan:
+    case SpvOpSGreaterThanEqual:
+    case SpvOpULessThan:
+    case SpvOpULessThanEqual:
+    case SpvOpUGreaterThan:
+    case SpvOpUGreaterThanEqual:
+    case SpvOpIEqual:
+    case SpvOpINotEqual:
+      if (!get_operands()) return false;
+      *range = CompareRanges(inst->opcode(), a, b);
+      break;
+    case SpvOpLogicalNot:
+      if (!get_operand(0, &a)) return false;
+      *range = ValueRange(1 - a.max, 1 - a.min);
+      break;
+    case SpvOpLogicalAnd:
+      if (!get_operands()) return false;
+      *range = ValueRange(a.min & b.min, a.max & b.max);
+      break;
+    case SpvOpLogicalOr:
+      if (!get_operands()) return false;
+      *range = ValueRange(a.min | b.min, a.max | b.max);
+      break;
+    default:
+      break;
+  }
+  return true;
+}
+
+bool ValueRangeAnalysis::ComputeExtInstRange(Instruction* inst,
+                                             BasicBlock* block,
+                                             const ValueRange& type_range,
+                                             ValueRange* range) {
+  *range = type_range;
+  if (inst->GetSingleWordInOperand(kExtInstSetIdInIdx) !=
+      context_->get_feature_mgr()->GetExtInstImportId_GLSLstd450()) {
+    return true;
+  }
+  for (uint32_t i = kExtInstFirstOperandInIdx; i < inst->NumInOperands();
+       ++i) {
+    if (!IsTracked(inst->GetSingleWordInOperand(i))) return true;
+  }
+
+  ValueRange x;
+  ValueRange y;
+  ValueRange z;
+  auto get_operand = [this, inst, block](uint32_t i, ValueRange* r) {
+    return GetRangeAt(
+               inst->GetSingleWordInOperand(kExtInstFirstOperandInIdx + i),
+               block, r) &&
+           !r->IsEmpty();
+  };
+
+  uint32_t ext_opcode = inst->GetSingleWordInOperand(kExtInstInstructionInIdx);
+  switch (ext_opcode) {
+    case GLSLstd450SAbs:
+      if (!get_operand(0, &x)) return false;
+      // The absolute value of the minimum is itself.
+      if (x.min > type_range.min) {
+        int64_t low = x.min >= 0 ? x.min : (x.max <= 0 ? -x.max : 0);
+        *range = ValueRange(low, std::max(std::abs(x.min), std::abs(x.max)));
+      }
+      break;
+    case GLSLstd450SMin:
+    case GLSLstd450UMin:
+      if (!get_operand(0, &x) || !get_operand(1, &y)) return false;
+      if (ext_opcode == GLSLstd450SMin ||
+          (x.IsNonNegative() && y.IsNonNegative())) {
+        *range =
+            ValueRange(std::min(x.min, y.min), std::min(x.max, y.max));
+      } else if (x.IsNonNegative()) {
+        *range = ValueRange(0, x.max);
+      } else if (y.IsNonNegative()) {
+        *range = ValueRange(0, y.max);
+      }
+      break;
+    case GLSLstd450SMax:
+    case GLSLstd450UMax:
+      if (!get_operand(0, &x) || !get_operand(1, &y)) return false;
+      if (ext_opcode == GLSLstd450SMax ||
+          (x.IsNonNegative() && y.IsNonNegative())) {
+        *range =
+            ValueRange(std::max(x.min, y.min), std::max(x.max, y.max));
+      }
+      break;
+    case GLSLstd450SClamp:
+    case GLSLstd450UClamp:
+      if (!get_operand(0, &x) || !get_operand(1, &y) || !get_operand(2, &z))
+        return false;
+      if (ext_opcode == GLSLstd450SClamp ||
+          (x.IsNonNegative() && y.IsNonNegative() && z.IsNonNegative())) {
+        *range = ValueRange(std::min(std::max(x.min, y.min), z.min),
+                            std::min(std::max(x.max, y.max), z.max));
+      } else if (z.IsNonNegative()) {
+        *range = ValueRange(0, z.max);
+      }
+      break;
+    default:
+      break;
+  }
+  return true;
+}
+
+bool ValueRangeAnalysis::GetInductionRange(Instruction* phi,
+                                           const ValueRange& type_range,
+                                           ValueRange* range) {
+  ScalarEvolutionAnalysis* scev = context_->GetScalarEvolutionAnalysis();
+  SERecurrentNode* recurrence =
+      scev->AnalyzeInstruction(phi)->AsSERecurrentNode();
+  if (recurrence == nullptr) return false;
+  SEConstantNode* offset = recurrence->GetOffset()->AsSEConstantNode();
+  SEConstantNode* coefficient =
+      recurrence->GetCoefficient()->AsSEConstantNode();
+  if (offset == nullptr || coefficient == nullptr) return false;
+  int64_t init = offset->FoldToSingleValue();
+  int64_t step = coefficient->FoldToSingleValue();
+  if (step == 0 || !type_range.Contains(ValueRange(init, init))) return false;
+
+  // The variable takes values from |init| up to the value that ends the loop,
+  // which is reached after |iterations| steps.  Without the trip count the
+  // variable could wrap around.
+  const Loop* loop = recurrence->GetLoop();
+  BasicBlock* condition_block = loop->FindConditionBlock();
+  size_t iterations = 0;
+  if (condition_block == nullptr ||
+      loop->FindConditionVariable(condition_block) != phi ||
+      !loop->FindNumberOfIterations(phi, &*condition_block->ctail(),
+                                    &iterations)) {
+    return false;
+  }
+  if (iterations >
+      static_cast<size_t>((type_range.max - type_range.min) / std::abs(step))) {
+    return false;
+  }
+  int64_t last = init + step * static_cast<int64_t>(iterations);
+  if (!type_range.Contains(ValueRange(last, last))) return false;
+  *range = ValueRange(std::min(init, last), std::max(init, last));
+  return true;
+}
+
+}  // namespace opt
+}  // namespace spvtools
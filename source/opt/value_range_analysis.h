@@ -0,0 +1,182 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_VALUE_RANGE_ANALYSIS_H_
+#define SOURCE_OPT_VALUE_RANGE_ANALYSIS_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "source/opt/basic_block.h"
+#include "source/opt/function.h"
+#include "source/opt/instruction.h"
+#include "source/opt/propagator.h"
+
+namespace spvtools {
+namespace opt {
+
+class IRContext;
+
+// An inclusive range of integer values.  Values are sign-extended from the
+// width of their type, whatever its signedness, so an unsigned value above
+// the signed maximum of its width is negative here.  Booleans are 0 or 1.
+struct ValueRange {
+  ValueRange() : min(0), max(-1) {}
+  ValueRange(int64_t min_value, int64_t max_value)
+      : min(min_value), max(max_value) {}
+
+  // Returns true if the range contains no value.
+  bool IsEmpty() const { return min > max; }
+
+  // Returns true if the range contains exactly one value.
+  bool IsSingleValue() const { return min == max; }
+
+  // Returns true if every value in the range is at least 0.  Signed and
+  // unsigned operations agree on such values.
+  bool IsNonNegative() const { return min >= 0; }
+
+  // Returns true if every value in |other| is in this range.
+  bool Contains(const ValueRange& other) const {
+    return other.IsEmpty() || (min <= other.min && other.max <= max);
+  }
+
+  // Returns the smallest range containing this range and |other|.
+  ValueRange Union(const ValueRange& other) const {
+    if (IsEmpty()) return other;
+    if (other.IsEmpty()) return *this;
+    return ValueRange(std::min(min, other.min), std::max(max, other.max));
+  }
+
+  // Returns the values in both this range and |other|.
+  ValueRange Intersect(const ValueRange& other) const {
+    return ValueRange(std::max(min, other.min), std::min(max, other.max));
+  }
+
+  bool operator==(const ValueRange& other) const {
+    return (IsEmpty() && other.IsEmpty()) ||
+           (min == other.min && max == other.max);
+  }
+  bool operator!=(const ValueRange& other) const { return !(*this == other); }
+
+  int64_t min;
+  int64_t max;
+};
+
+// Computes the range of values each integer and boolean result in a function
+// can take.  Only types of at most 32 bits are tracked.
+//
+// The analysis is a sparse conditional propagation over the lattice of
+// ranges.  Blocks that can only be reached through branches that are never
+// taken are not analyzed.  Where a value is used, its range is narrowed by
+// the comparisons against constants that must hold for the use to be reached,
+// such as i < 16 inside the body of a loop on i.  The ranges of loop header
+// phis that keep growing are widened, using the trip count found by the
+// scalar evolution analysis for induction variables.
+class ValueRangeAnalysis {
+ public:
+  explicit ValueRangeAnalysis(IRContext* context) : context_(context) {}
+
+  // Computes the ranges of the values in |func|.  Forgets the results for any
+  // function analyzed before.
+  void Run(Function* func);
+
+  // Returns true if the range of |id| is known, and stores it in |range|.
+  // It is not known for values that are not tracked, and for values in
+  // blocks that were found to be unreachable.
+  bool GetRange(uint32_t id, ValueRange* range);
+
+  // Returns true if the range of |id| where it is used in |block| is known,
+  // and stores it in |range|.  This is narrowed by the branch conditions that
+  // must hold for |block| to execute.  The result is empty if |block| cannot
+  // execute.
+  bool GetRangeAt(uint32_t id, BasicBlock* block, ValueRange* range);
+
+  // Returns true if |block| was found to be reachable.
+  bool IsReachable(BasicBlock* block) const {
+    return reachable_blocks_.count(block) != 0;
+  }
+
+ private:
+  // The visit function for the SSA propagator.
+  SSAPropagator::PropStatus VisitInstruction(Instruction* inst,
+                                             BasicBlock** dest_bb);
+
+  // Visits a phi, and widens its range if it keeps growing.
+  SSAPropagator::PropStatus VisitPhi(Instruction* phi);
+
+  // Visits a branch.  Sets |dest_bb| if only one of the targets can be taken.
+  SSAPropagator::PropStatus VisitBranch(Instruction* branch,
+                                        BasicBlock** dest_bb);
+
+  // Visits any other instruction with a result.
+  SSAPropagator::PropStatus VisitAssignment(Instruction* inst);
+
+  // Records |range| as the range of |inst|, and returns the status to give
+  // the propagator.  |range| must contain the range previously recorded.
+  SSAPropagator::PropStatus SetRange(Instruction* inst,
+                                     const ValueRange& range);
+
+  // Computes the range of the result of |inst|, which is not a phi, from the
+  // ranges of its operands in |block|.  Returns false if the range of an
+  // operand is not known yet.
+  bool ComputeRange(Instruction* inst, BasicBlock* block,
+                    const ValueRange& type_range, ValueRange* range);
+
+  // Computes the range of an OpExtInst from GLSL.std.450, like ComputeRange.
+  bool ComputeExtInstRange(Instruction* inst, BasicBlock* block,
+                           const ValueRange& type_range, ValueRange* range);
+
+  // Returns true if values of type |type_id| are tracked, and stores the
+  // range of all of its values in |range|.
+  bool GetTypeRange(uint32_t type_id, ValueRange* range);
+
+  // Returns true if the value |id| has a tracked type.
+  bool IsTracked(uint32_t id);
+
+  // Narrows |range|, the range of |id|, according to the condition
+  // |condition_id| being |value|.
+  void NarrowByCondition(uint32_t id, uint32_t condition_id, bool value,
+                         ValueRange* range);
+
+  // Returns the range of values for |phi| over all the iterations of the
+  // loop it is the induction variable of.  Returns false if |phi| is not an
+  // induction variable with a constant start and step.
+  bool GetInductionRange(Instruction* phi, const ValueRange& type_range,
+                         ValueRange* range);
+
+  IRContext* context_;
+
+  // The function being analyzed.
+  Function* function_ = nullptr;
+
+  // The propagator for |function_|.
+  std::unique_ptr<SSAPropagator> propagator_;
+
+  // Maps the result id of each analyzed instruction to its range.
+  std::unordered_map<uint32_t, ValueRange> ranges_;
+
+  // The number of times the range of each phi grew.
+  std::unordered_map<uint32_t, uint32_t> phi_updates_;
+
+  // The blocks the propagator found to be reachable.
+  std::unordered_set<BasicBlock*> reachable_blocks_;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_VALUE_RANGE_ANALYSIS_H_
@@ -0,0 +1,152 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/value_range_propagation_pass.h"
+
+#include <vector>
+
+#include "spirv/unified1/GLSL.std.450.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const uint32_t kExtInstSetIdInIdx = 0;
+const uint32_t kExtInstInstructionInIdx = 1;
+const uint32_t kExtInstFirstOperandInIdx = 2;
+
+}  // namespace
+
+Pass::Status ValueRangePropagationPass::Process() {
+  ValueRangeAnalysis analysis(context());
+  analysis_ = &analysis;
+
+  ProcessFunction pfn = [this](Function* fp) { return PropagateRanges(fp); };
+  bool modified = context()->ProcessReachableCallTree(pfn);
+  return modified ? Status::SuccessWithChange : Status::SuccessWithoutChange;
+}
+
+bool ValueRangePropagationPass::PropagateRanges(Function* func) {
+  analysis_->Run(func);
+
+  // The replacements are made once the whole function has been looked at,
+  // since the analysis refers to the instructions being replaced.
+  std::unordered_map<uint32_t, uint32_t> replacements;
+  std::vector<uint32_t> replaced_ids;
+  for (auto& block : *func) {
+    if (!analysis_->IsReachable(&block)) continue;
+    for (auto& inst : block) {
+      if (inst.result_id() == 0 || inst.type_id() == 0) continue;
+
+      uint32_t new_id = 0;
+      ValueRange range;
+      if (analysis_->GetRange(inst.result_id(), &range) &&
+          range.IsSingleValue()) {
+        new_id = GetConstantId(inst.type_id(), range.min);
+      } else if (inst.opcode() == SpvOpExtInst) {
+        new_id = GetUnchangedOperand(&inst, &block);
+        auto it = replacements.find(new_id);
+        if (it != replacements.end()) new_id = it->second;
+      }
+      if (new_id == 0) continue;
+      replacements[inst.result_id()] = new_id;
+      replaced_ids.push_back(inst.result_id());
+    }
+  }
+
+  bool modified = false;
+  for (uint32_t id : replaced_ids) {
+    context()->KillNamesAndDecorates(id);
+    modified |= context()->ReplaceAllUsesWith(id, replacements[id]);
+  }
+  return modified;
+}
+
+uint32_t ValueRangePropagationPass::GetConstantId(uint32_t type_id,
+                                                  int64_t value) {
+  const analysis::Type* type = context()->get_type_mgr()->GetType(type_id);
+  uint32_t word = static_cast<uint32_t>(value);
+  if (const analysis::Integer* int_type = type->AsInteger()) {
+    // The high bits of the words of unsigned constants are 0, and those of
+    // signed constants are the sign bit.
+    if (!int_type->IsSigned() && int_type->width() < 32) {
+      word &= (1u << int_type->width()) - 1;
+    }
+  }
+
+  analysis::ConstantManager* const_mgr = context()->get_constant_mgr();
+  const analysis::Constant* constant = const_mgr->GetConstant(type, {word});
+  Instruction* constant_inst =
+      const_mgr->GetDefiningInstruction(constant, type_id);
+  return constant_inst ? constant_inst->result_id() : 0;
+}
+
+uint32_t ValueRangePropagationPass::GetUnchangedOperand(Instruction* inst,
+                                                        BasicBlock* block) {
+  if (inst->GetSingleWordInOperand(kExtInstSetIdInIdx) !=
+      context()->get_feature_mgr()->GetExtInstImportId_GLSLstd450()) {
+    return 0;
+  }
+
+  std::vector<uint32_t> operand_ids;
+  std::vector<ValueRange> ranges;
+  for (uint32_t i = kExtInstFirstOperandInIdx; i < inst->NumInOperands();
+       ++i) {
+    operand_ids.push_back(inst->GetSingleWordInOperand(i));
+    ranges.emplace_back();
+    if (!analysis_->GetRangeAt(operand_ids.back(), block, &ranges.back()) ||
+        ranges.back().IsEmpty()) {
+      return 0;
+    }
+  }
+
+  uint32_t ext_opcode = inst->GetSingleWordInOperand(kExtInstInstructionInIdx);
+  switch (ext_opcode) {
+    case GLSLstd450UMin:
+    case GLSLstd450UMax:
+    case GLSLstd450UClamp:
+      // The unsigned forms agree with the signed ones on values that are
+      // non-negative.
+      for (const ValueRange& range : ranges) {
+        if (!range.IsNonNegative()) return 0;
+      }
+      break;
+    default:
+      break;
+  }
+
+  switch (ext_opcode) {
+    case GLSLstd450SMin:
+    case GLSLstd450UMin:
+      if (ranges[0].max <= ranges[1].min) return operand_ids[0];
+      if (ranges[1].max <= ranges[0].min) return operand_ids[1];
+      break;
+    case GLSLstd450SMax:
+    case GLSLstd450UMax:
+      if (ranges[0].min >= ranges[1].max) return operand_ids[0];
+      if (ranges[1].min >= ranges[0].max) return operand_ids[1];
+      break;
+    case GLSLstd450SClamp:
+    case GLSLstd450UClamp:
+      if (ranges[1].max <= ranges[0].min && ranges[0].max <= ranges[2].min)
+        return operand_ids[0];
+      break;
+    default:
+      break;
+  }
+  return 0;
+}
+
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,69 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SOURCE_OPT_VALUE_RANGE_PROPAGATION_PASS_H_
+#define SOURCE_OPT_VALUE_RANGE_PROPAGATION_PASS_H_
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "source/opt/ir_context.h"
+#include "source/opt/pass.h"
+#include "source/opt/value_range_analysis.h"
+
+namespace spvtools {
+namespace opt {
+
+// This pass uses the value range analysis to simplify integer code.  Results
+// whose range holds a single value are replaced by a constant.  This folds
+// comparisons that always have the same result, including the conditions of
+// branches that can only go one way; the branches themselves are left for
+// dead branch elimination to remove.  Calls to the GLSL.std.450 min, max and
+// clamp instructions that cannot change their operand, such as the clamps
+// added by robust buffer access on indices that are already in bounds, are
+// replaced by that operand.
+class ValueRangePropagationPass : public Pass {
+ public:
+  const char* name() const override { return "value-range-propagation"; }
+  Status Process() override;
+
+  IRContext::Analysis GetPreservedAnalyses() override {
+    return IRContext::kAnalysisDefUse |
+           IRContext::kAnalysisInstrToBlockMapping |
+           IRContext::kAnalysisDecorations | IRContext::kAnalysisCombinators |
+           IRContext::kAnalysisCFG | IRContext::kAnalysisDominatorAnalysis |
+           IRContext::kAnalysisNameMap | IRContext::kAnalysisConstants |
+           IRContext::kAnalysisTypes;
+  }
+
+ private:
+  // Simplifies the instructions in |func|.  Returns true if it was changed.
+  bool PropagateRanges(Function* func);
+
+  // Returns the id of a constant of type |type_id| with the value |value|,
+  // or 0 if it could not be created.
+  uint32_t GetConstantId(uint32_t type_id, int64_t value);
+
+  // Returns the id of the operand that |inst|, an OpExtInst in |block|,
+  // always returns, or 0 if there is none.
+  uint32_t GetUnchangedOperand(Instruction* inst, BasicBlock* block);
+
+  // The analysis of the function being processed.
+  ValueRangeAnalysis* analysis_ = nullptr;
+};
+
+}  // namespace opt
+}  // namespace spvtools
+
+#endif  // SOURCE_OPT_VALUE_RANGE_PROPAGATION_PASS_H_
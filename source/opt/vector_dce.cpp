@@ -28,12 +28,51 @@ const uint32_t kInsertCompositeIdInIdx = 1;
 
 Pass::Status VectorDCE::Process() {
   bool modified = false;
-  for (Function& function : *get_module()) {
-    modified |= VectorDCEFunction(&function);
+  if (context()->num_threads() > 1) {
+    modified = VectorDCEFunctionsInParallel();
+  } else {
+    for (Function& function : *get_module()) {
+      modified |= VectorDCEFunction(&function);
+    }
   }
   return (modified ? Status::SuccessWithChange : Status::SuccessWithoutChange);
 }
 
+bool VectorDCE::VectorDCEFunctionsInParallel() {
+  // Finding the live components only reads the module, so the analyses it
+  // uses are built here and the functions are then analyzed concurrently.
+  // The feature manager is built lazily by the Instruction queries that
+  // check the capabilities of the module.
+  get_def_use_mgr();
+  context()->get_type_mgr();
+  context()->get_feature_mgr();
+  if (!context()->AreAnalysesValid(IRContext::kAnalysisCombinators)) {
+    context()->BuildInvalidAnalyses(IRContext::kAnalysisCombinators);
+  }
+
+  size_t num_functions = 0;
+  for (auto& function : *get_module()) {
+    (void)function;
+    ++num_functions;
+  }
+
+  std::vector<LiveComponentMap> live_components(num_functions);
+  context()->ForEachFunctionInParallel(
+      [this, &live_components](Function* function, size_t index) {
+        FindLiveComponents(function, &live_components[index]);
+      });
+
+  // Rewriting a function only changes that function and adds global
+  // OpUndefs, so doing it in module order gives the same result as the
+  // sequential pass.
+  bool modified = false;
+  size_t index = 0;
+  for (Function& function : *get_module()) {
+    modified |= RewriteInstructions(&function, live_components[index++]);
+  }
+  return modified;
+}
+
 bool VectorDCE::VectorDCEFunction(Function* function) {
   LiveComponentMap live_components;
   FindLiveComponents(function, &live_components);
@@ -62,6 +62,11 @@ class VectorDCE : public MemPass {
   // modified.
   bool VectorDCEFunction(Function* function);
 
+  // Runs the vector dce pass on every function in the module, finding the
+  // live components of all functions concurrently before rewriting them one
+  // at a time.  Returns true if the module was modified.
+  bool VectorDCEFunctionsInParallel();
+
   // Identifies the live components of the vectors that are results of
   // instructions in |function|.  The results are stored in |live_components|.
   void FindLiveComponents(Function* function,
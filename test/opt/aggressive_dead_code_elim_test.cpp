@@ -13,6 +13,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -6761,6 +6762,131 @@ OpFunctionEnd
       predefs1 + names_after + predefs2_after + func_after, true, true);
 }
 
+TEST_F(AggressiveDCETest, RerunOnlyProcessesChangedFunctions) {
+  // A function in which a run found nothing to remove is skipped by the next
+  // runs until it changes.
+  const std::string text = R"(OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %1 "main" %9
+OpExecutionMode %1 OriginUpperLeft
+%2 = OpTypeVoid
+%3 = OpTypeFunction %2
+%4 = OpTypeInt 32 0
+%5 = OpConstant %4 1
+%8 = OpTypePointer Output %4
+%9 = OpVariable %8 Output
+%1 = OpFunction %2 None %3
+%6 = OpLabel
+%7 = OpIAdd %4 %5 %5
+OpStore %9 %5
+OpReturn
+OpFunctionEnd
+)";
+
+  auto context = BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, text);
+  ASSERT_NE(context, nullptr);
+
+  EXPECT_EQ(AggressiveDCEPass().Run(context.get()),
+            Pass::Status::SuccessWithChange);
+  EXPECT_EQ(context->dead_code_fingerprints()->count(1), 0u);
+  EXPECT_EQ(AggressiveDCEPass().Run(context.get()),
+            Pass::Status::SuccessWithoutChange);
+  EXPECT_EQ(context->dead_code_fingerprints()->count(1), 1u);
+  EXPECT_EQ(AggressiveDCEPass().Run(context.get()),
+            Pass::Status::SuccessWithoutChange);
+
+  // Add a dead instruction to the function.  The next run must see that the
+  // function changed and remove it.
+  BasicBlock* block = &*context->GetFunction(1)->begin();
+  Instruction* store = &*block->begin();
+  ASSERT_EQ(store->opcode(), SpvOpStore);
+  uint32_t dead_id = context->TakeNextId();
+  std::unique_ptr<Instruction> dead(new Instruction(
+      context.get(), SpvOpIAdd, 4, dead_id,
+      {{SPV_OPERAND_TYPE_ID, {5}}, {SPV_OPERAND_TYPE_ID, {5}}}));
+  Instruction* dead_inst = store->InsertBefore(std::move(dead));
+  context->AnalyzeDefUse(dead_inst);
+  context->set_instr_block(dead_inst, block);
+
+  EXPECT_EQ(AggressiveDCEPass().Run(context.get()),
+            Pass::Status::SuccessWithChange);
+  EXPECT_EQ(context->get_def_use_mgr()->GetDef(dead_id), nullptr);
+}
+
+TEST_F(AggressiveDCETest, RerunKeepsGlobalsOfSkippedFunctions) {
+  // %10 does not change, so the second run skips it while it processes %1.
+  // The globals and decorations used only by %10 must be kept.
+  const std::string text = R"(OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %1 "main" %9 %17
+OpExecutionMode %1 OriginUpperLeft
+OpDecorateId %13 UniformId %14
+%2 = OpTypeVoid
+%3 = OpTypeFunction %2
+%4 = OpTypeInt 32 0
+%5 = OpConstant %4 1
+%14 = OpConstant %4 2
+%15 = OpConstant %4 7
+%8 = OpTypePointer Output %4
+%9 = OpVariable %8 Output
+%16 = OpTypePointer Private %4
+%17 = OpVariable %16 Private
+%1 = OpFunction %2 None %3
+%6 = OpLabel
+%7 = OpFunctionCall %2 %10
+OpStore %9 %5
+OpReturn
+OpFunctionEnd
+%10 = OpFunction %2 None %3
+%11 = OpLabel
+OpStore %17 %15
+%13 = OpLoad %4 %17
+OpStore %9 %13
+OpReturn
+OpFunctionEnd
+)";
+
+  auto context = BuildModule(SPV_ENV_UNIVERSAL_1_4, nullptr, text);
+  ASSERT_NE(context, nullptr);
+
+  EXPECT_EQ(AggressiveDCEPass().Run(context.get()),
+            Pass::Status::SuccessWithoutChange);
+  EXPECT_EQ(context->dead_code_fingerprints()->count(1), 1u);
+  EXPECT_EQ(context->dead_code_fingerprints()->count(10), 1u);
+
+  // Add a dead instruction to %1.
+  BasicBlock* block = &*context->GetFunction(1)->begin();
+  Instruction* call = &*block->begin();
+  ASSERT_EQ(call->opcode(), SpvOpFunctionCall);
+  uint32_t dead_id = context->TakeNextId();
+  std::unique_ptr<Instruction> dead(new Instruction(
+      context.get(), SpvOpIAdd, 4, dead_id,
+      {{SPV_OPERAND_TYPE_ID, {5}}, {SPV_OPERAND_TYPE_ID, {5}}}));
+  Instruction* dead_inst = call->InsertBefore(std::move(dead));
+  context->AnalyzeDefUse(dead_inst);
+  context->set_instr_block(dead_inst, block);
+
+  EXPECT_EQ(AggressiveDCEPass().Run(context.get()),
+            Pass::Status::SuccessWithChange);
+  EXPECT_EQ(context->get_def_use_mgr()->GetDef(dead_id), nullptr);
+  EXPECT_EQ(context->dead_code_fingerprints()->count(10), 1u);
+  EXPECT_NE(context->get_def_use_mgr()->GetDef(14), nullptr);
+  EXPECT_NE(context->get_def_use_mgr()->GetDef(15), nullptr);
+  EXPECT_NE(context->get_def_use_mgr()->GetDef(17), nullptr);
+  bool has_decoration = false;
+  for (auto& anno : context->module()->annotations()) {
+    if (anno.opcode() == SpvOpDecorateId) has_decoration = true;
+  }
+  EXPECT_TRUE(has_decoration);
+
+  // Once %10 is no longer called, it is removed, and so is its fingerprint.
+  context->KillInst(call);
+  EXPECT_EQ(AggressiveDCEPass().Run(context.get()),
+            Pass::Status::SuccessWithChange);
+  EXPECT_EQ(context->GetFunction(10), nullptr);
+  EXPECT_EQ(context->dead_code_fingerprints()->count(10), 0u);
+}
+
 // TODO(greg-lunarg): Add tests to verify handling of these cases:
 //
 //    Check that logical addressing required
@@ -0,0 +1,278 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/alias_analysis.h"
+
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "source/opt/build_module.h"
+#include "source/opt/ir_context.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+const std::string kShader = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint GLCompute %main "main"
+               OpExecutionMode %main LocalSize 1 1 1
+               OpName %priv "priv"
+               OpName %ssbo1 "ssbo1"
+               OpName %ssbo2 "ssbo2"
+               OpName %ssbo3 "ssbo3"
+               OpName %ubo "ubo"
+               OpName %arr "arr"
+               OpName %local "local"
+               OpName %a0 "a0"
+               OpName %a1 "a1"
+               OpName %a0_again "a0_again"
+               OpName %ai "ai"
+               OpName %aj "aj"
+               OpName %ai1 "ai1"
+               OpName %ai_x "ai_x"
+               OpName %ai_y "ai_y"
+               OpName %aj_y "aj_y"
+               OpName %s1 "s1"
+               OpName %s2 "s2"
+               OpName %s3 "s3"
+               OpName %p "p"
+               OpName %q "q"
+               OpName %callee_local "callee_local"
+               OpDecorate %struct Block
+               OpMemberDecorate %struct 0 Offset 0
+               OpMemberDecorate %struct 1 Offset 4
+               OpDecorate %ssbo3 Restrict
+       %void = OpTypeVoid
+         %fn = OpTypeFunction %void
+        %int = OpTypeInt 32 1
+      %int_0 = OpConstant %int 0
+      %int_1 = OpConstant %int 1
+      %int_4 = OpConstant %int 4
+     %struct = OpTypeStruct %int %int
+      %array = OpTypeArray %struct %int_4
+%ptr_func_array = OpTypePointer Function %array
+%ptr_func_struct = OpTypePointer Function %struct
+%ptr_func_int = OpTypePointer Function %int
+%ptr_priv_int = OpTypePointer Private %int
+%ptr_ssbo_struct = OpTypePointer StorageBuffer %struct
+%ptr_ssbo_int = OpTypePointer StorageBuffer %int
+%ptr_uniform_struct = OpTypePointer Uniform %struct
+   %fn_param = OpTypeFunction %void %ptr_func_int %ptr_priv_int
+       %priv = OpVariable %ptr_priv_int Private
+      %ssbo1 = OpVariable %ptr_ssbo_struct StorageBuffer
+      %ssbo2 = OpVariable %ptr_ssbo_struct StorageBuffer
+      %ssbo3 = OpVariable %ptr_ssbo_struct StorageBuffer
+        %ubo = OpVariable %ptr_uniform_struct Uniform
+       %main = OpFunction %void None %fn
+      %entry = OpLabel
+        %arr = OpVariable %ptr_func_array Function
+      %local = OpVariable %ptr_func_int Function
+          %i = OpLoad %int %local
+          %j = OpLoad %int %priv
+         %i1 = OpIAdd %int %i %int_1
+         %a0 = OpAccessChain %ptr_func_struct %arr %int_0
+         %a1 = OpAccessChain %ptr_func_struct %arr %int_1
+   %a0_again = OpAccessChain %ptr_func_struct %arr %int_0
+         %ai = OpAccessChain %ptr_func_struct %arr %i
+         %aj = OpAccessChain %ptr_func_struct %arr %j
+        %ai1 = OpAccessChain %ptr_func_struct %arr %i1
+       %ai_x = OpAccessChain %ptr_func_int %arr %i %int_0
+       %ai_y = OpAccessChain %ptr_func_int %ai %int_1
+       %aj_y = OpAccessChain %ptr_func_int %arr %j %int_1
+         %s1 = OpAccessChain %ptr_ssbo_int %ssbo1 %int_0
+         %s2 = OpAccessChain %ptr_ssbo_int %ssbo2 %int_0
+         %s3 = OpAccessChain %ptr_ssbo_int %ssbo3 %int_0
+       %call = OpFunctionCall %void %callee %local %priv
+               OpReturn
+               OpFunctionEnd
+     %callee = OpFunction %void None %fn_param
+          %p = OpFunctionParameter %ptr_func_int
+          %q = OpFunctionParameter %ptr_priv_int
+%callee_entry = OpLabel
+%callee_local = OpVariable %ptr_func_int Function
+               OpReturn
+               OpFunctionEnd
+)";
+
+class AliasAnalysisTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    context_ = BuildModule(SPV_ENV_UNIVERSAL_1_3, nullptr, kShader);
+    ASSERT_NE(context_, nullptr);
+  }
+
+  // Returns the id given the name |name| by an OpName.
+  uint32_t Id(const std::string& name) {
+    for (Instruction& inst : context_->debugs2()) {
+      if (inst.GetOperand(1).AsString() == name) {
+        return inst.GetSingleWordInOperand(0);
+      }
+    }
+    ADD_FAILURE() << "No id named " << name;
+    return 0;
+  }
+
+  AliasAnalysis::Result Alias(const std::string& ptr1,
+                              const std::string& ptr2) {
+    AliasAnalysis* alias_analysis = context_->GetAliasAnalysis();
+    AliasAnalysis::Result result = alias_analysis->Alias(Id(ptr1), Id(ptr2));
+    EXPECT_EQ(result, alias_analysis->Alias(Id(ptr2), Id(ptr1)));
+    return result;
+  }
+
+  std::unique_ptr<IRContext> context_;
+};
+
+TEST_F(AliasAnalysisTest, DifferentStorageClasses) {
+  EXPECT_EQ(Alias("local", "priv"), AliasAnalysis::kNoAlias);
+  EXPECT_EQ(Alias("a0", "s1"), AliasAnalysis::kNoAlias);
+}
+
+TEST_F(AliasAnalysisTest, DifferentVariables) {
+  EXPECT_EQ(Alias("local", "local"), AliasAnalysis::kMustAlias);
+  EXPECT_EQ(Alias("arr", "local"), AliasAnalysis::kNoAlias);
+  EXPECT_EQ(Alias("ai", "local"), AliasAnalysis::kNoAlias);
+}
+
+TEST_F(AliasAnalysisTest, ConstantIndices) {
+  EXPECT_EQ(Alias("a0", "a1"), AliasAnalysis::kNoAlias);
+  EXPECT_EQ(Alias("a0", "a0_again"), AliasAnalysis::kMustAlias);
+  EXPECT_EQ(Alias("a0", "arr"), AliasAnalysis::kMayAlias);
+}
+
+TEST_F(AliasAnalysisTest, DynamicIndices) {
+  EXPECT_EQ(Alias("ai", "aj"), AliasAnalysis::kMayAlias);
+  EXPECT_EQ(Alias("ai", "a0"), AliasAnalysis::kMayAlias);
+  EXPECT_EQ(Alias("ai", "ai_x"), AliasAnalysis::kMayAlias);
+  // The element is unknown, but the members are different.
+  EXPECT_EQ(Alias("ai_x", "aj_y"), AliasAnalysis::kNoAlias);
+  EXPECT_EQ(Alias("ai_x", "ai_y"), AliasAnalysis::kNoAlias);
+}
+
+TEST_F(AliasAnalysisTest, ScalarEvolutionIndices) {
+  EXPECT_EQ(Alias("ai", "ai1"), AliasAnalysis::kNoAlias);
+  EXPECT_EQ(Alias("ai_y", "aj_y"), AliasAnalysis::kMayAlias);
+}
+
+TEST_F(AliasAnalysisTest, BufferVariables) {
+  // Different descriptors may be bound to the same buffer.
+  EXPECT_EQ(Alias("s1", "s2"), AliasAnalysis::kMayAlias);
+  EXPECT_EQ(Alias("ssbo1", "ssbo2"), AliasAnalysis::kMayAlias);
+  // Unless one of them is restricted.
+  EXPECT_EQ(Alias("s1", "s3"), AliasAnalysis::kNoAlias);
+  // Buffers in different storage classes may also share memory.
+  EXPECT_EQ(Alias("ubo", "ssbo1"), AliasAnalysis::kMayAlias);
+  EXPECT_EQ(Alias("ubo", "s1"), AliasAnalysis::kMayAlias);
+  EXPECT_EQ(Alias("ubo", "priv"), AliasAnalysis::kNoAlias);
+}
+
+TEST_F(AliasAnalysisTest, FunctionParameters) {
+  EXPECT_EQ(Alias("p", "callee_local"), AliasAnalysis::kNoAlias);
+  EXPECT_EQ(Alias("p", "local"), AliasAnalysis::kMayAlias);
+  EXPECT_EQ(Alias("q", "priv"), AliasAnalysis::kMayAlias);
+  EXPECT_EQ(Alias("p", "q"), AliasAnalysis::kNoAlias);
+}
+
+TEST_F(AliasAnalysisTest, RootsAndLoadsAndStores) {
+  AliasAnalysis* alias_analysis = context_->GetAliasAnalysis();
+  analysis::DefUseManager* def_use_mgr = context_->get_def_use_mgr();
+  EXPECT_EQ(alias_analysis->GetRoot(def_use_mgr->GetDef(Id("ai_y"))),
+            def_use_mgr->GetDef(Id("arr")));
+  EXPECT_EQ(alias_analysis->GetRoot(def_use_mgr->GetDef(Id("p"))),
+            def_use_mgr->GetDef(Id("p")));
+
+  Instruction* load_local = nullptr;
+  Instruction* load_priv = nullptr;
+  def_use_mgr->ForEachUser(Id("local"), [&load_local](Instruction* user) {
+    if (user->opcode() == SpvOpLoad) load_local = user;
+  });
+  def_use_mgr->ForEachUser(Id("priv"), [&load_priv](Instruction* user) {
+    if (user->opcode() == SpvOpLoad) load_priv = user;
+  });
+  ASSERT_NE(load_local, nullptr);
+  ASSERT_NE(load_priv, nullptr);
+  EXPECT_EQ(alias_analysis->AliasMemoryAccesses(load_local, load_priv),
+            AliasAnalysis::kNoAlias);
+  EXPECT_EQ(alias_analysis->AliasMemoryAccesses(load_local, load_local),
+            AliasAnalysis::kMustAlias);
+}
+
+TEST_F(AliasAnalysisTest, LoopVariantIndices) {
+  const std::string loop_shader = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint GLCompute %main "main"
+               OpExecutionMode %main LocalSize 1 1 1
+               OpName %a0 "a0"
+               OpName %a0_again "a0_again"
+               OpName %ai "ai"
+               OpName %ax "ax"
+               OpName %ax1 "ax1"
+       %void = OpTypeVoid
+         %fn = OpTypeFunction %void
+       %bool = OpTypeBool
+        %int = OpTypeInt 32 1
+      %int_0 = OpConstant %int 0
+      %int_1 = OpConstant %int 1
+      %int_4 = OpConstant %int 4
+      %array = OpTypeArray %int %int_4
+%ptr_func_array = OpTypePointer Function %array
+%ptr_func_int = OpTypePointer Function %int
+       %main = OpFunction %void None %fn
+      %entry = OpLabel
+        %arr = OpVariable %ptr_func_array Function
+      %local = OpVariable %ptr_func_int Function
+               OpBranch %header
+     %header = OpLabel
+          %i = OpPhi %int %int_0 %entry %i_next %header
+          %x = OpLoad %int %local
+         %x1 = OpIAdd %int %x %int_1
+         %a0 = OpAccessChain %ptr_func_int %arr %int_0
+   %a0_again = OpAccessChain %ptr_func_int %arr %int_0
+         %ai = OpAccessChain %ptr_func_int %arr %i
+         %ax = OpAccessChain %ptr_func_int %arr %x
+        %ax1 = OpAccessChain %ptr_func_int %arr %x1
+     %i_next = OpIAdd %int %i %int_1
+       %cond = OpSLessThan %bool %i_next %int_4
+               OpLoopMerge %merge %header None
+               OpBranchConditional %cond %header %merge
+      %merge = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+  context_ = BuildModule(SPV_ENV_UNIVERSAL_1_3, nullptr, loop_shader);
+  ASSERT_NE(context_, nullptr);
+  analysis::DefUseManager* def_use_mgr = context_->get_def_use_mgr();
+  auto same_iteration = [this, def_use_mgr](const std::string& ptr1,
+                                            const std::string& ptr2) {
+    return context_->GetAliasAnalysis()->AliasInSameIteration(
+        def_use_mgr->GetDef(Id(ptr1)), def_use_mgr->GetDef(Id(ptr2)));
+  };
+
+  // Constant indices are the same in every iteration.
+  EXPECT_EQ(Alias("a0", "a0_again"), AliasAnalysis::kMustAlias);
+  EXPECT_EQ(Alias("a0", "a0"), AliasAnalysis::kMustAlias);
+  // The other indices may be different in another iteration.
+  EXPECT_EQ(Alias("ai", "ai"), AliasAnalysis::kMayAlias);
+  EXPECT_EQ(Alias("ax", "ax1"), AliasAnalysis::kMayAlias);
+  EXPECT_EQ(same_iteration("ai", "ai"), AliasAnalysis::kMustAlias);
+  EXPECT_EQ(same_iteration("ax", "ax1"), AliasAnalysis::kNoAlias);
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
@@ -925,6 +925,177 @@ TEST_F(CCPTest, FoldWithDecoration) {
   SinglePassRunAndMatch<CCPPass>(text, true);
 }
 
+// The start of a module with a function %f that multiplies its parameter %x
+// by 3, called from %main.
+const std::string kInterproceduralHeader = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %out
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %f "f"
+OpName %x "x"
+OpName %out "out"
+%void = OpTypeVoid
+%bool = OpTypeBool
+%false = OpConstantFalse %bool
+%int = OpTypeInt 32 1
+%int_2 = OpConstant %int 2
+%int_3 = OpConstant %int 3
+%void_fn = OpTypeFunction %void
+%int_fn = OpTypeFunction %int %int
+%_ptr_Output_int = OpTypePointer Output %int
+%out = OpVariable %_ptr_Output_int Output
+%f = OpFunction %int None %int_fn
+%x = OpFunctionParameter %int
+%f_entry = OpLabel
+%mul = OpIMul %int %x %int_3
+OpReturnValue %mul
+OpFunctionEnd
+)";
+
+TEST_F(CCPTest, InterproceduralConstantArgument) {
+  const std::string text = kInterproceduralHeader + R"(
+; CHECK: %f = OpFunction
+; CHECK: OpReturnValue %int_6
+; CHECK: %main = OpFunction
+; CHECK: OpStore %out %int_6
+; CHECK: OpStore %out %int_6
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+%call1 = OpFunctionCall %int %f %int_2
+OpStore %out %call1
+%call2 = OpFunctionCall %int %f %int_2
+OpStore %out %call2
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<CCPPass>(text, true, /* interprocedural = */ true);
+}
+
+TEST_F(CCPTest, InterproceduralDifferentArguments) {
+  const std::string text = kInterproceduralHeader + R"(
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+%call1 = OpFunctionCall %int %f %int_2
+OpStore %out %call1
+%call2 = OpFunctionCall %int %f %int_3
+OpStore %out %call2
+OpReturn
+OpFunctionEnd
+)";
+
+  auto result = SinglePassRunAndDisassemble<CCPPass>(
+      text, /* skip_nop = */ true, /* do_validation = */ true,
+      /* interprocedural = */ true);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+TEST_F(CCPTest, InterproceduralIgnoresCallsThatDoNotExecute) {
+  const std::string text = kInterproceduralHeader + R"(
+; CHECK: OpReturnValue %int_6
+; CHECK: %main = OpFunction
+; CHECK: OpFunctionCall %int %f %int_3
+; CHECK: OpStore %out %int_6
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+OpSelectionMerge %merge None
+OpBranchConditional %false %then %else
+%then = OpLabel
+%call1 = OpFunctionCall %int %f %int_3
+OpStore %out %call1
+OpBranch %merge
+%else = OpLabel
+%call2 = OpFunctionCall %int %f %int_2
+OpStore %out %call2
+OpBranch %merge
+%merge = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<CCPPass>(text, true, /* interprocedural = */ true);
+}
+
+TEST_F(CCPTest, InterproceduralReturnValueAsArgument) {
+  // %main is propagated before %g, so the first rounds do not know the value
+  // of %call_g yet.  That must not make %x varying.
+  const std::string text = R"(
+; CHECK: %f = OpFunction
+; CHECK: OpReturnValue %int_6
+; CHECK: %main = OpFunction
+; CHECK: OpStore %out %int_6
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %out
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %f "f"
+OpName %out "out"
+%void = OpTypeVoid
+%int = OpTypeInt 32 1
+%int_2 = OpConstant %int 2
+%int_3 = OpConstant %int 3
+%void_fn = OpTypeFunction %void
+%int_fn = OpTypeFunction %int %int
+%int_void_fn = OpTypeFunction %int
+%_ptr_Output_int = OpTypePointer Output %int
+%out = OpVariable %_ptr_Output_int Output
+%f = OpFunction %int None %int_fn
+%x = OpFunctionParameter %int
+%f_entry = OpLabel
+%mul = OpIMul %int %x %int_3
+OpReturnValue %mul
+OpFunctionEnd
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+%call_g = OpFunctionCall %int %g
+%call_f = OpFunctionCall %int %f %call_g
+OpStore %out %call_f
+OpReturn
+OpFunctionEnd
+%g = OpFunction %int None %int_void_fn
+%g_entry = OpLabel
+OpReturnValue %int_2
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<CCPPass>(text, true, /* interprocedural = */ true);
+}
+
+TEST_F(CCPTest, InterproceduralExportedFunction) {
+  // %f can be called from outside the module, so %x can have any value.
+  const std::string text = R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+OpDecorate %f LinkageAttributes "f" Export
+OpDecorate %g LinkageAttributes "g" Export
+%int = OpTypeInt 32 1
+%int_2 = OpConstant %int 2
+%int_3 = OpConstant %int 3
+%int_fn = OpTypeFunction %int %int
+%int_void_fn = OpTypeFunction %int
+%f = OpFunction %int None %int_fn
+%x = OpFunctionParameter %int
+%f_entry = OpLabel
+%mul = OpIMul %int %x %int_3
+OpReturnValue %mul
+OpFunctionEnd
+%g = OpFunction %int None %int_void_fn
+%g_entry = OpLabel
+%call = OpFunctionCall %int %f %int_2
+OpReturnValue %call
+OpFunctionEnd
+)";
+
+  auto result = SinglePassRunAndDisassemble<CCPPass>(
+      text, /* skip_nop = */ true, /* do_validation = */ true,
+      /* interprocedural = */ true);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
@@ -0,0 +1,341 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "test/opt/pass_fixture.h"
+#include "test/opt/pass_utils.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using DeadStoreElimTest = PassTest<::testing::Test>;
+
+// The start of a fragment shader, up to where the names of the ids used by
+// each test are added.
+const std::string kPreamble = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %in %out
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %in "in"
+OpName %out "out"
+OpName %priv "priv"
+OpName %entry "entry"
+OpName %x "x"
+OpName %s "s"
+OpName %arr "arr"
+OpName %a "a"
+OpName %cond "cond"
+)";
+
+// The types and variables, and the start of the entry block of %main.
+const std::string kHeader = R"(
+%void = OpTypeVoid
+%bool = OpTypeBool
+%int = OpTypeInt 32 1
+%int_0 = OpConstant %int 0
+%int_1 = OpConstant %int 1
+%int_2 = OpConstant %int 2
+%struct = OpTypeStruct %int %int
+%array = OpTypeArray %int %int_2
+%void_fn = OpTypeFunction %void
+%_ptr_Input_int = OpTypePointer Input %int
+%_ptr_Output_int = OpTypePointer Output %int
+%_ptr_Function_int = OpTypePointer Function %int
+%_ptr_Function_struct = OpTypePointer Function %struct
+%_ptr_Function_array = OpTypePointer Function %array
+%_ptr_Private_int = OpTypePointer Private %int
+%ptr_fn = OpTypeFunction %void %_ptr_Function_int
+%in = OpVariable %_ptr_Input_int Input
+%out = OpVariable %_ptr_Output_int Output
+%priv = OpVariable %_ptr_Private_int Private
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+%x = OpVariable %_ptr_Function_int Function
+%s = OpVariable %_ptr_Function_struct Function
+%arr = OpVariable %_ptr_Function_array Function
+%a = OpLoad %int %in
+%cond = OpSLessThan %bool %a %int_0
+)";
+
+TEST_F(DeadStoreElimTest, OverwrittenOnAllPaths) {
+  const std::string text = kPreamble + kHeader + R"(
+; CHECK: %cond = OpSLessThan
+; CHECK-NOT: OpStore %x
+; CHECK: OpSelectionMerge
+; CHECK: OpStore %x %int_1
+; CHECK: OpStore %x %int_2
+OpStore %x %int_0
+OpSelectionMerge %merge None
+OpBranchConditional %cond %then %else
+%then = OpLabel
+OpStore %x %int_1
+OpBranch %merge
+%else = OpLabel
+OpStore %x %int_2
+OpBranch %merge
+%merge = OpLabel
+%v = OpLoad %int %x
+OpStore %out %v
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<DeadStoreElimPass>(text, true);
+}
+
+TEST_F(DeadStoreElimTest, OverwrittenOnSomePaths) {
+  const std::string text = kPreamble + kHeader + R"(
+OpStore %x %int_0
+OpSelectionMerge %merge None
+OpBranchConditional %cond %then %merge
+%then = OpLabel
+OpStore %x %int_1
+OpBranch %merge
+%merge = OpLabel
+%v = OpLoad %int %x
+OpStore %out %v
+OpReturn
+OpFunctionEnd
+)";
+
+  auto result = SinglePassRunAndDisassemble<DeadStoreElimPass>(
+      text, /* skip_nop = */ true, /* do_validation = */ false);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+TEST_F(DeadStoreElimTest, NeverLoaded) {
+  const std::string text = kPreamble + kHeader + R"(
+; CHECK-NOT: OpStore %x
+; CHECK: OpReturn
+OpStore %x %int_0
+OpSelectionMerge %merge None
+OpBranchConditional %cond %then %merge
+%then = OpLabel
+OpStore %x %int_1
+OpBranch %merge
+%merge = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<DeadStoreElimPass>(text, true);
+}
+
+TEST_F(DeadStoreElimTest, StoreReadInNextIteration) {
+  const std::string text = kPreamble + kHeader + R"(
+OpStore %x %int_0
+OpBranch %header
+%header = OpLabel
+%v = OpLoad %int %x
+OpStore %out %v
+OpLoopMerge %merge %cont None
+OpBranchConditional %cond %cont %merge
+%cont = OpLabel
+OpStore %x %int_1
+OpBranch %header
+%merge = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  auto result = SinglePassRunAndDisassemble<DeadStoreElimPass>(
+      text, /* skip_nop = */ true, /* do_validation = */ false);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+TEST_F(DeadStoreElimTest, MemberStores) {
+  // The store to member 0 is overwritten by the store to the whole struct.
+  // The store to the whole struct is only partly overwritten, and member 1 is
+  // loaded, so it is kept.
+  const std::string text = kPreamble + R"(
+OpName %m0 "m0"
+OpName %whole "whole"
+)" + kHeader + R"(
+; CHECK-NOT: OpStore %m0
+; CHECK: OpStore %s %whole
+; CHECK: OpStore %m0 %int_2
+%m0 = OpAccessChain %_ptr_Function_int %s %int_0
+%m1 = OpAccessChain %_ptr_Function_int %s %int_1
+OpStore %m0 %int_1
+%whole = OpCompositeConstruct %struct %a %a
+OpStore %s %whole
+OpStore %m0 %int_2
+%v0 = OpLoad %int %m0
+%v1 = OpLoad %int %m1
+%sum = OpIAdd %int %v0 %v1
+OpStore %out %sum
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<DeadStoreElimPass>(text, true);
+}
+
+TEST_F(DeadStoreElimTest, DynamicStore) {
+  // A store with a dynamic index does not overwrite any element in
+  // particular, so the first store to %e1 is only dead because of the second.
+  const std::string text = kPreamble + R"(
+OpName %e1 "e1"
+OpName %ea "ea"
+)" + kHeader + R"(
+; CHECK-NOT: OpStore %e1 %int_0
+; CHECK-NOT: OpStore %ea
+; CHECK: OpStore %e1 %int_2
+; CHECK-NEXT: OpLoad %int %e1
+%e1 = OpAccessChain %_ptr_Function_int %arr %int_1
+%ea = OpAccessChain %_ptr_Function_int %arr %a
+OpStore %e1 %int_0
+OpStore %ea %int_1
+OpStore %e1 %int_2
+%v = OpLoad %int %e1
+OpStore %out %v
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<DeadStoreElimPass>(text, true);
+}
+
+TEST_F(DeadStoreElimTest, DynamicLoad) {
+  // A load with a dynamic index may read any element.
+  const std::string text = kPreamble + kHeader + R"(
+%e0 = OpAccessChain %_ptr_Function_int %arr %int_0
+%e1 = OpAccessChain %_ptr_Function_int %arr %int_1
+%ea = OpAccessChain %_ptr_Function_int %arr %a
+OpStore %e0 %int_0
+OpStore %e1 %int_1
+%v = OpLoad %int %ea
+OpStore %out %v
+OpReturn
+OpFunctionEnd
+)";
+
+  auto result = SinglePassRunAndDisassemble<DeadStoreElimPass>(
+      text, /* skip_nop = */ true, /* do_validation = */ false);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+TEST_F(DeadStoreElimTest, PrivateVariables) {
+  // The store in %main is dead because the invocation ends when %main
+  // returns, but %foo's caller can read the store in %foo.
+  const std::string text = kPreamble + R"(
+OpName %foo "foo"
+)" + kHeader + R"(
+; CHECK: %main = OpFunction
+; CHECK: OpFunctionCall %void %foo %x
+; CHECK-NOT: OpStore %priv
+; CHECK: OpReturn
+; CHECK: %foo = OpFunction
+; CHECK: OpStore %priv %int_1
+OpStore %x %int_0
+%call = OpFunctionCall %void %foo %x
+%v = OpLoad %int %priv
+OpStore %out %v
+OpStore %priv %int_2
+OpReturn
+OpFunctionEnd
+%foo = OpFunction %void None %ptr_fn
+%param = OpFunctionParameter %_ptr_Function_int
+%foo_entry = OpLabel
+%p = OpLoad %int %param
+OpStore %priv %int_1
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<DeadStoreElimPass>(text, true);
+}
+
+TEST_F(DeadStoreElimTest, CallReadsArguments) {
+  const std::string text = kPreamble + R"(
+OpName %foo "foo"
+)" + kHeader + R"(
+; CHECK: OpStore %x %int_0
+; CHECK-NEXT: OpFunctionCall %void %foo %x
+; CHECK-NOT: OpStore %x
+; CHECK: OpReturn
+OpStore %x %int_0
+%call = OpFunctionCall %void %foo %x
+OpStore %x %int_1
+OpReturn
+OpFunctionEnd
+%foo = OpFunction %void None %ptr_fn
+%param = OpFunctionParameter %_ptr_Function_int
+%foo_entry = OpLabel
+%p = OpLoad %int %param
+OpStore %out %p
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<DeadStoreElimPass>(text, true);
+}
+
+TEST_F(DeadStoreElimTest, OverwrittenThroughSameDynamicIndex) {
+  // The alias analysis knows that %ea and %ea_again point to the same element
+  // and that %ea1 points to another one.
+  const std::string text = kPreamble + R"(
+OpName %ea "ea"
+OpName %ea_again "ea_again"
+OpName %ea1 "ea1"
+)" + kHeader + R"(
+; CHECK-NOT: OpStore %ea %int_0
+; CHECK: OpLoad %int %ea1
+; CHECK-NEXT: OpStore %ea_again %int_1
+%a1 = OpIAdd %int %a %int_1
+%ea = OpAccessChain %_ptr_Function_int %arr %a
+%ea1 = OpAccessChain %_ptr_Function_int %arr %a1
+%ea_again = OpAccessChain %_ptr_Function_int %arr %a
+OpStore %ea %int_0
+%v1 = OpLoad %int %ea1
+OpStore %ea_again %int_1
+%v2 = OpLoad %int %ea
+%v = OpIAdd %int %v1 %v2
+OpStore %out %v
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<DeadStoreElimPass>(text, true);
+}
+
+TEST_F(DeadStoreElimTest, DynamicIndexReadBeforeOverwritten) {
+  // %eb may point to the element written by the first store.
+  const std::string text = kPreamble + kHeader + R"(
+%b = OpLoad %int %in
+%ea = OpAccessChain %_ptr_Function_int %arr %a
+%eb = OpAccessChain %_ptr_Function_int %arr %b
+OpStore %ea %int_0
+%v1 = OpLoad %int %eb
+OpStore %ea %int_1
+%v2 = OpLoad %int %ea
+%v = OpIAdd %int %v1 %v2
+OpStore %out %v
+OpReturn
+OpFunctionEnd
+)";
+
+  auto result = SinglePassRunAndDisassemble<DeadStoreElimPass>(
+      text, /* skip_nop = */ true, /* do_validation = */ false);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
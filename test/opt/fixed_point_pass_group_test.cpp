@@ -0,0 +1,133 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "source/opt/fixed_point_pass_group.h"
+#include "source/util/make_unique.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+// A pass that appends an OpNop instruction to the debug1 section until the
+// section holds |limit| instructions.
+class AppendOpNopUpToPass : public Pass {
+ public:
+  explicit AppendOpNopUpToPass(uint32_t limit) : limit_(limit) {}
+
+  const char* name() const override { return "append-nop-up-to"; }
+  Status Process() override {
+    uint32_t count = 0;
+    for (auto& inst : context()->debugs1()) {
+      (void)inst;
+      ++count;
+    }
+    if (count >= limit_) return Status::SuccessWithoutChange;
+    context()->AddDebug1Inst(MakeUnique<Instruction>(context()));
+    return Status::SuccessWithChange;
+  }
+
+ private:
+  uint32_t limit_;
+};
+
+// A pass that never changes the module, but counts how many times it ran.
+class CountingPass : public Pass {
+ public:
+  explicit CountingPass(uint32_t* count) : count_(count) {}
+
+  const char* name() const override { return "counting"; }
+  Status Process() override {
+    ++*count_;
+    return Status::SuccessWithoutChange;
+  }
+
+ private:
+  uint32_t* count_;
+};
+
+uint32_t CountDebug1Insts(IRContext* context) {
+  uint32_t count = 0;
+  for (auto& inst : context->debugs1()) {
+    (void)inst;
+    ++count;
+  }
+  return count;
+}
+
+TEST(FixedPointPassGroup, IteratesUntilNoChange) {
+  IRContext context(SPV_ENV_UNIVERSAL_1_2, MakeUnique<Module>(), nullptr);
+  uint32_t count = 0;
+  FixedPointPassGroup group(
+      {[]() { return MakeUnique<AppendOpNopUpToPass>(3); },
+       [&count]() { return MakeUnique<CountingPass>(&count); }},
+      10);
+
+  EXPECT_EQ(Pass::Status::SuccessWithChange, group.Run(&context));
+  EXPECT_EQ(3u, CountDebug1Insts(&context));
+  // The fourth iteration finds nothing to do.
+  EXPECT_EQ(4u, group.iterations());
+  // The counting pass is not run after the last change was seen by it.
+  EXPECT_EQ(3u, count);
+  EXPECT_EQ(7u, group.runs());
+  EXPECT_EQ(1u, group.skipped_runs());
+}
+
+TEST(FixedPointPassGroup, StopsAtMaxIterations) {
+  IRContext context(SPV_ENV_UNIVERSAL_1_2, MakeUnique<Module>(), nullptr);
+  FixedPointPassGroup group(
+      {[]() { return MakeUnique<AppendOpNopUpToPass>(100); }}, 2);
+
+  EXPECT_EQ(Pass::Status::SuccessWithChange, group.Run(&context));
+  EXPECT_EQ(2u, CountDebug1Insts(&context));
+  EXPECT_EQ(2u, group.iterations());
+}
+
+TEST(FixedPointPassGroup, NoChange) {
+  IRContext context(SPV_ENV_UNIVERSAL_1_2, MakeUnique<Module>(), nullptr);
+  uint32_t count = 0;
+  FixedPointPassGroup group(
+      {[&count]() { return MakeUnique<CountingPass>(&count); },
+       [&count]() { return MakeUnique<CountingPass>(&count); }});
+
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, group.Run(&context));
+  EXPECT_EQ(1u, group.iterations());
+  EXPECT_EQ(2u, count);
+  EXPECT_EQ(0u, group.skipped_runs());
+}
+
+TEST(FixedPointPassGroup, SkipsPassesThatCannotChangeAnything) {
+  IRContext context(SPV_ENV_UNIVERSAL_1_2, MakeUnique<Module>(), nullptr);
+  uint32_t count = 0;
+  // Both counting passes run in the first iteration.  The first runs again in
+  // the second iteration to see the change, but the last is skipped since it
+  // already ran after the change.
+  FixedPointPassGroup group(
+      {[&count]() { return MakeUnique<CountingPass>(&count); },
+       []() { return MakeUnique<AppendOpNopUpToPass>(1); },
+       [&count]() { return MakeUnique<CountingPass>(&count); }});
+
+  EXPECT_EQ(Pass::Status::SuccessWithChange, group.Run(&context));
+  EXPECT_EQ(1u, CountDebug1Insts(&context));
+  EXPECT_EQ(2u, group.iterations());
+  EXPECT_EQ(3u, count);
+  EXPECT_EQ(1u, group.skipped_runs());
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
@@ -0,0 +1,305 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "test/opt/pass_fixture.h"
+#include "test/opt/pass_utils.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using FunctionSpecializationTest = PassTest<::testing::Test>;
+
+// A fragment shader with a function %f that adds its two parameters, up to
+// the start of the entry block of %main, which loads %a and %b.
+const std::string kHeader = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %in %out
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %f "f"
+OpName %in "in"
+OpName %out "out"
+OpName %a "a"
+OpName %b "b"
+%void = OpTypeVoid
+%int = OpTypeInt 32 1
+%int_2 = OpConstant %int 2
+%int_3 = OpConstant %int 3
+%void_fn = OpTypeFunction %void
+%int_fn = OpTypeFunction %int %int %int
+%_ptr_Input_int = OpTypePointer Input %int
+%_ptr_Output_int = OpTypePointer Output %int
+%in = OpVariable %_ptr_Input_int Input
+%out = OpVariable %_ptr_Output_int Output
+%f = OpFunction %int None %int_fn
+%x = OpFunctionParameter %int
+%y = OpFunctionParameter %int
+%f_entry = OpLabel
+%sum = OpIAdd %int %x %y
+OpReturnValue %sum
+OpFunctionEnd
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+%a = OpLoad %int %in
+%b = OpLoad %int %in
+)";
+
+TEST_F(FunctionSpecializationTest, AllCallsAgree) {
+  // Both calls pass 2 for %x, so %f is replaced by a clone without %x.
+  const std::string text = kHeader + R"(
+; CHECK-NOT: %f = OpFunction
+; CHECK: %main = OpFunction
+; CHECK: OpFunctionCall %int [[clone:%\w+]] %a
+; CHECK: OpFunctionCall %int [[clone]] %b
+; CHECK: [[clone]] = OpFunction %int
+; CHECK-NEXT: [[y:%\w+]] = OpFunctionParameter %int
+; CHECK-NEXT: OpLabel
+; CHECK-NEXT: OpIAdd %int %int_2 [[y]]
+%call1 = OpFunctionCall %int %f %int_2 %a
+OpStore %out %call1
+%call2 = OpFunctionCall %int %f %int_2 %b
+OpStore %out %call2
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<FunctionSpecializationPass>(text, true, 100u);
+}
+
+TEST_F(FunctionSpecializationTest, DifferentConstants) {
+  const std::string text = kHeader + R"(
+; CHECK-NOT: %f = OpFunction
+; CHECK: %main = OpFunction
+; CHECK: OpFunctionCall %int [[clone1:%\w+]] %a
+; CHECK: OpFunctionCall %int [[clone2:%\w+]] %a
+; CHECK: [[clone1]] = OpFunction %int
+; CHECK: OpIAdd %int %int_2
+; CHECK: [[clone2]] = OpFunction %int
+; CHECK: OpIAdd %int %int_3
+%call1 = OpFunctionCall %int %f %int_2 %a
+OpStore %out %call1
+%call2 = OpFunctionCall %int %f %int_3 %a
+OpStore %out %call2
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<FunctionSpecializationPass>(text, true, 100u);
+}
+
+TEST_F(FunctionSpecializationTest, GrowthLimit) {
+  // Specializing %f for either call would keep %f for the other one.
+  const std::string text = kHeader + R"(
+%call1 = OpFunctionCall %int %f %int_2 %a
+OpStore %out %call1
+%call2 = OpFunctionCall %int %f %int_3 %a
+OpStore %out %call2
+OpReturn
+OpFunctionEnd
+)";
+
+  auto result = SinglePassRunAndDisassemble<FunctionSpecializationPass>(
+      text, /* skip_nop = */ true, /* do_validation = */ true, 0u);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+TEST_F(FunctionSpecializationTest, UnusedParameterAndReturnValue) {
+  const std::string text = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %in %out
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %g "g"
+OpName %x "x"
+OpName %a "a"
+OpName %out "out"
+%void = OpTypeVoid
+%int = OpTypeInt 32 1
+%void_fn = OpTypeFunction %void
+%int_fn = OpTypeFunction %int %int %int
+%_ptr_Input_int = OpTypePointer Input %int
+%_ptr_Output_int = OpTypePointer Output %int
+%in = OpVariable %_ptr_Input_int Input
+%out = OpVariable %_ptr_Output_int Output
+; CHECK: %g = OpFunction %void None [[type:%\w+]]
+; CHECK-NEXT: %x = OpFunctionParameter %int
+; CHECK-NEXT: OpLabel
+; CHECK-NEXT: OpStore %out %x
+; CHECK-NEXT: OpReturn
+; CHECK-NEXT: OpFunctionEnd
+; CHECK: OpFunctionCall %void %g %a
+%g = OpFunction %int None %int_fn
+%x = OpFunctionParameter %int
+%y = OpFunctionParameter %int
+%g_entry = OpLabel
+OpStore %out %x
+OpReturnValue %x
+OpFunctionEnd
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+%a = OpLoad %int %in
+%call = OpFunctionCall %int %g %a %a
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<FunctionSpecializationPass>(text, true, 100u);
+}
+
+TEST_F(FunctionSpecializationTest, ExportedFunction) {
+  // %h can be called from outside the module, so it keeps its parameters.
+  const std::string text = R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+OpDecorate %h LinkageAttributes "h" Export
+OpDecorate %k LinkageAttributes "k" Export
+%int = OpTypeInt 32 1
+%int_fn = OpTypeFunction %int %int %int
+%k_fn = OpTypeFunction %int %int
+%h = OpFunction %int None %int_fn
+%x = OpFunctionParameter %int
+%y = OpFunctionParameter %int
+%h_entry = OpLabel
+OpReturnValue %x
+OpFunctionEnd
+%k = OpFunction %int None %k_fn
+%z = OpFunctionParameter %int
+%k_entry = OpLabel
+%call = OpFunctionCall %int %h %z %z
+OpReturnValue %call
+OpFunctionEnd
+)";
+
+  auto result = SinglePassRunAndDisassemble<FunctionSpecializationPass>(
+      text, /* skip_nop = */ true, /* do_validation = */ true, 100u);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+TEST_F(FunctionSpecializationTest, CalleeStillCalledFromClone) {
+  // Specializing %g first adds a call to %f in the clone of %g, so %f is not
+  // removed when its call in %g is specialized, and there is no budget for
+  // a clone of %f.
+  const std::string text = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %in %out
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %g "g"
+OpName %f "f"
+%void = OpTypeVoid
+%int = OpTypeInt 32 1
+%int_2 = OpConstant %int 2
+%int_3 = OpConstant %int 3
+%void_fn = OpTypeFunction %void
+%int_fn = OpTypeFunction %int %int %int
+%_ptr_Input_int = OpTypePointer Input %int
+%_ptr_Output_int = OpTypePointer Output %int
+%in = OpVariable %_ptr_Input_int Input
+%out = OpVariable %_ptr_Output_int Output
+; CHECK: %f = OpFunction
+; CHECK: OpIAdd
+; CHECK-NOT: OpIAdd
+%f = OpFunction %int None %int_fn
+%x = OpFunctionParameter %int
+%y = OpFunctionParameter %int
+%f_entry = OpLabel
+%sum = OpIAdd %int %x %y
+OpReturnValue %sum
+OpFunctionEnd
+%g = OpFunction %int None %int_fn
+%z = OpFunctionParameter %int
+%w = OpFunctionParameter %int
+%g_entry = OpLabel
+%call_f = OpFunctionCall %int %f %int_3 %w
+OpReturnValue %call_f
+OpFunctionEnd
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+%a = OpLoad %int %in
+%call_g = OpFunctionCall %int %g %int_2 %a
+OpStore %out %call_g
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<FunctionSpecializationPass>(text, true, 0u);
+}
+
+TEST_F(FunctionSpecializationTest, CloneCalledFromRemovedFunction) {
+  // %A is specialized first, and its clone still calls %B.  %B is then
+  // specialized for its call in %A, which is removed, so the clone of %B is
+  // not called anymore and is removed too.
+  const std::string text = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %in %out
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %A "A"
+OpName %B "B"
+OpName %x "x"
+OpName %y "y"
+%void = OpTypeVoid
+%int = OpTypeInt 32 1
+%int_2 = OpConstant %int 2
+%int_3 = OpConstant %int 3
+%void_fn = OpTypeFunction %void
+%int_fn = OpTypeFunction %int %int %int
+%_ptr_Input_int = OpTypePointer Input %int
+%_ptr_Output_int = OpTypePointer Output %int
+%in = OpVariable %_ptr_Input_int Input
+%out = OpVariable %_ptr_Output_int Output
+; CHECK-NOT: %A = OpFunction
+; CHECK: %B = OpFunction
+; CHECK: OpIAdd %int %x %y
+; CHECK: %main = OpFunction
+; CHECK: OpFunctionCall %int %B %int_3
+; CHECK-NOT: OpFunction %int
+%A = OpFunction %int None %int_fn
+%p = OpFunctionParameter %int
+%q = OpFunctionParameter %int
+%A_entry = OpLabel
+%call_B = OpFunctionCall %int %B %int_3 %q
+OpReturnValue %call_B
+OpFunctionEnd
+%B = OpFunction %int None %int_fn
+%x = OpFunctionParameter %int
+%y = OpFunctionParameter %int
+%B_entry = OpLabel
+%sum = OpIAdd %int %x %y
+OpReturnValue %sum
+OpFunctionEnd
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+%a = OpLoad %int %in
+%call_A = OpFunctionCall %int %A %int_2 %a
+OpStore %out %call_A
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<FunctionSpecializationPass>(text, true, 100u);
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
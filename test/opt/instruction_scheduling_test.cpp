@@ -0,0 +1,135 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "test/opt/pass_fixture.h"
+#include "test/opt/pass_utils.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using InstructionSchedulingTest = PassTest<::testing::Test>;
+
+// The start of a fragment shader with four float inputs, up to the first
+// instruction of %main.
+const std::string kHeader = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %in_a %in_b %in_c %in_d %out %out_x
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %a "a"
+OpName %b "b"
+OpName %c "c"
+OpName %d "d"
+OpName %s1 "s1"
+OpName %s2 "s2"
+OpName %r "r"
+OpName %out "out"
+OpName %out_x "out_x"
+%void = OpTypeVoid
+%float = OpTypeFloat 32
+%float_0 = OpConstant %float 0
+%void_fn = OpTypeFunction %void
+%_ptr_Input_float = OpTypePointer Input %float
+%_ptr_Output_float = OpTypePointer Output %float
+%in_a = OpVariable %_ptr_Input_float Input
+%in_b = OpVariable %_ptr_Input_float Input
+%in_c = OpVariable %_ptr_Input_float Input
+%in_d = OpVariable %_ptr_Input_float Input
+%out = OpVariable %_ptr_Output_float Output
+%out_x = OpVariable %_ptr_Output_float Output
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+)";
+
+TEST_F(InstructionSchedulingTest, LoadsMoveToTheirUses) {
+  // All four loads are live at once before the additions.  Computing %s1
+  // right after its loads needs one register less.
+  const std::string text = kHeader + R"(
+; CHECK: %a = OpLoad %float %in_a
+; CHECK-NEXT: %b = OpLoad %float %in_b
+; CHECK-NEXT: %s1 = OpFAdd %float %a %b
+; CHECK-NEXT: %c = OpLoad %float %in_c
+; CHECK-NEXT: %d = OpLoad %float %in_d
+; CHECK-NEXT: %s2 = OpFAdd %float %c %d
+; CHECK-NEXT: %r = OpFAdd %float %s1 %s2
+; CHECK-NEXT: OpStore %out %r
+%a = OpLoad %float %in_a
+%b = OpLoad %float %in_b
+%c = OpLoad %float %in_c
+%d = OpLoad %float %in_d
+%s1 = OpFAdd %float %a %b
+%s2 = OpFAdd %float %c %d
+%r = OpFAdd %float %s1 %s2
+OpStore %out %r
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<InstructionSchedulingPass>(text, true);
+}
+
+TEST_F(InstructionSchedulingTest, LoadsDoNotCrossStores) {
+  // %c and %d cannot move above the store to %out_x, but %s1 can move below
+  // it.
+  const std::string text = kHeader + R"(
+; CHECK: %a = OpLoad %float %in_a
+; CHECK-NEXT: %b = OpLoad %float %in_b
+; CHECK-NEXT: %s1 = OpFAdd %float %a %b
+; CHECK-NEXT: OpStore %out_x %float_0
+; CHECK-NEXT: %c = OpLoad %float %in_c
+; CHECK-NEXT: %d = OpLoad %float %in_d
+; CHECK-NEXT: %s2 = OpFAdd %float %c %d
+%a = OpLoad %float %in_a
+%b = OpLoad %float %in_b
+OpStore %out_x %float_0
+%c = OpLoad %float %in_c
+%d = OpLoad %float %in_d
+%s1 = OpFAdd %float %a %b
+%s2 = OpFAdd %float %c %d
+%r = OpFAdd %float %s1 %s2
+OpStore %out %r
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<InstructionSchedulingPass>(text, true);
+}
+
+TEST_F(InstructionSchedulingTest, AlreadyScheduled) {
+  const std::string text = kHeader + R"(
+%a = OpLoad %float %in_a
+%b = OpLoad %float %in_b
+%s1 = OpFAdd %float %a %b
+%c = OpLoad %float %in_c
+%d = OpLoad %float %in_d
+%s2 = OpFAdd %float %c %d
+%r = OpFAdd %float %s1 %s2
+OpStore %out %r
+OpReturn
+OpFunctionEnd
+)";
+
+  auto result = SinglePassRunAndDisassemble<InstructionSchedulingPass>(
+      text, /* skip_nop = */ true, /* do_validation = */ true);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
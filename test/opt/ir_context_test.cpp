@@ -749,6 +749,135 @@ TEST_F(IRContextTest, AsanErrorTest) {
       << bb->id();  // Make sure asan does not complain about use after free.
 }
 
+TEST_F(IRContextTest, CloneIsIndependentOfOriginal) {
+  const std::string text = R"(
+               OpCapability Shader
+          %1 = OpExtInstImport "GLSL.std.450"
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %4 "main"
+               OpExecutionMode %4 OriginUpperLeft
+               OpSource ESSL 310
+               OpName %4 "main"
+               OpDecorate %8 RelaxedPrecision
+          %2 = OpTypeVoid
+          %3 = OpTypeFunction %2
+          %6 = OpTypeInt 32 1
+          %7 = OpTypePointer Function %6
+          %9 = OpConstant %6 1
+          %4 = OpFunction %2 None %3
+          %5 = OpLabel
+          %8 = OpVariable %7 Function
+               OpStore %8 %9
+               OpReturn
+               OpFunctionEnd
+  )";
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, text,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  context->set_max_id_bound(0x400000);
+  std::vector<uint32_t> original_binary;
+  context->module()->ToBinary(&original_binary, false);
+
+  std::unique_ptr<IRContext> clone = context->Clone();
+  std::vector<uint32_t> clone_binary;
+  clone->module()->ToBinary(&clone_binary, false);
+  EXPECT_EQ(original_binary, clone_binary);
+  EXPECT_EQ(clone->max_id_bound(), 0x400000u);
+
+  clone->module()->ForEachInst([&clone](Instruction* inst) {
+    EXPECT_EQ(inst->context(), clone.get());
+  });
+
+  // Changing the clone must not change the original.
+  Instruction* store = nullptr;
+  clone->get_def_use_mgr()->ForEachUser(
+      8, [&store](Instruction* user) {
+        if (user->opcode() == SpvOpStore) store = user;
+      });
+  ASSERT_NE(store, nullptr);
+  clone->KillInst(store);
+
+  std::vector<uint32_t> new_original_binary;
+  context->module()->ToBinary(&new_original_binary, false);
+  EXPECT_EQ(original_binary, new_original_binary);
+  EXPECT_EQ(context->get_def_use_mgr()->NumUses(8), 2u);
+  EXPECT_EQ(clone->get_def_use_mgr()->NumUses(8), 1u);
+}
+
+TEST_F(IRContextTest, ResetLoadsNewModule) {
+  const std::string first = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %1 "main"
+               OpExecutionMode %1 OriginUpperLeft
+          %2 = OpTypeVoid
+          %3 = OpTypeFunction %2
+          %1 = OpFunction %2 None %3
+          %4 = OpLabel
+               OpReturn
+               OpFunctionEnd
+  )";
+
+  const std::string second = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %1 "main"
+               OpExecutionMode %1 OriginUpperLeft
+          %2 = OpTypeVoid
+          %3 = OpTypeFunction %2
+          %4 = OpTypeInt 32 1
+          %5 = OpTypePointer Function %4
+          %6 = OpConstant %4 1
+          %1 = OpFunction %2 None %3
+          %7 = OpLabel
+          %8 = OpVariable %5 Function
+               OpStore %8 %6
+               OpReturn
+               OpFunctionEnd
+  )";
+
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, first,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  context->set_max_id_bound(0x400000);
+  EXPECT_EQ(context->get_def_use_mgr()->GetDef(4)->opcode(), SpvOpLabel);
+  analysis::TypeManager* type_mgr = context->get_type_mgr();
+  analysis::ConstantManager* const_mgr = context->get_constant_mgr();
+  EXPECT_EQ(type_mgr->GetType(4), nullptr);
+
+  std::unique_ptr<IRContext> expected =
+      BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, second,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  std::vector<uint32_t> binary;
+  expected->module()->ToBinary(&binary, false);
+
+  ASSERT_TRUE(context->Reset(binary.data(), binary.size()));
+  EXPECT_EQ(context->max_id_bound(), 0x400000u);
+  EXPECT_FALSE(context->AreAnalysesValid(IRContext::kAnalysisDefUse));
+  EXPECT_EQ(context->get_def_use_mgr()->GetDef(4)->opcode(), SpvOpTypeInt);
+  EXPECT_EQ(context->get_def_use_mgr()->NumUses(8), 1u);
+
+  // The type and constant managers are kept, but describe the new module.
+  EXPECT_FALSE(context->AreAnalysesValid(IRContext::kAnalysisTypes));
+  EXPECT_FALSE(context->AreAnalysesValid(IRContext::kAnalysisConstants));
+  EXPECT_EQ(context->get_type_mgr(), type_mgr);
+  EXPECT_EQ(context->get_constant_mgr(), const_mgr);
+  ASSERT_NE(type_mgr->GetType(4), nullptr);
+  EXPECT_NE(type_mgr->GetType(4)->AsInteger(), nullptr);
+  EXPECT_EQ(type_mgr->GetId(type_mgr->GetType(5)), 5u);
+  const analysis::Constant* one = const_mgr->FindDeclaredConstant(6);
+  ASSERT_NE(one, nullptr);
+  EXPECT_EQ(one->GetS32(), 1);
+
+  std::vector<uint32_t> new_binary;
+  context->module()->ToBinary(&new_binary, false);
+  EXPECT_EQ(binary, new_binary);
+
+  std::vector<uint32_t> garbage = {0, 1, 2, 3};
+  EXPECT_FALSE(context->Reset(garbage.data(), garbage.size()));
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
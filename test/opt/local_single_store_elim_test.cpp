@@ -25,8 +25,8 @@ namespace {
 using LocalSingleStoreElimTest = PassTest<::testing::Test>;
 
 TEST_F(LocalSingleStoreElimTest, PositiveAndNegative) {
-  // Single store to v is optimized. Multiple store to
-  // f is not optimized.
+  // Single store to v is optimized. Of the loads of f, which is stored to
+  // twice, only the one that always reads the first store is optimized.
   //
   // #version 140
   //
@@ -106,8 +106,7 @@ OpFunctionEnd
 OpStore %v %20
 %21 = OpLoad %float %fi
 OpStore %f %21
-%22 = OpLoad %float %f
-%23 = OpFOrdLessThan %bool %22 %float_0
+%23 = OpFOrdLessThan %bool %21 %float_0
 OpSelectionMerge %24 None
 OpBranchConditional %23 %25 %24
 %25 = OpLabel
@@ -127,7 +126,9 @@ OpFunctionEnd
 }
 
 TEST_F(LocalSingleStoreElimTest, ThreeStores) {
-  // Three stores to multiple loads of v is not optimized.
+  // The loads of v, which is stored to three times, always read the first
+  // store, so they are optimized.  The load of r is not, since two stores
+  // reach it.
 
   const std::string predefs =
       R"(OpCapability Shader
@@ -186,10 +187,38 @@ OpBranch %23
 OpStore %gl_FragColor %30
 OpReturn
 OpFunctionEnd
+)";
+
+  const std::string after =
+      R"(%main = OpFunction %void None %9
+%19 = OpLabel
+%v = OpVariable %_ptr_Function_v4float Function
+%r = OpVariable %_ptr_Function_v4float Function
+%20 = OpLoad %v4float %BaseColor
+OpStore %v %20
+%21 = OpLoad %float %fi
+%22 = OpFOrdLessThan %bool %21 %float_0
+OpSelectionMerge %23 None
+OpBranchConditional %22 %24 %25
+%24 = OpLabel
+OpStore %v %20
+OpStore %r %20
+OpBranch %23
+%25 = OpLabel
+%28 = OpCompositeConstruct %v4float %float_1 %float_1 %float_1 %float_1
+OpStore %v %28
+%29 = OpFSub %v4float %28 %20
+OpStore %r %29
+OpBranch %23
+%23 = OpLabel
+%30 = OpLoad %v4float %r
+OpStore %gl_FragColor %30
+OpReturn
+OpFunctionEnd
 )";
 
   SinglePassRunAndCheck<LocalSingleStoreElimPass>(predefs + before,
-                                                  predefs + before, true, true);
+                                                  predefs + after, true, true);
 }
 
 TEST_F(LocalSingleStoreElimTest, MultipleLoads) {
@@ -1998,6 +1998,50 @@ OpFunctionEnd
   EXPECT_EQ(Pass::Status::Failure, std::get<1>(result));
 }
 
+TEST_F(LocalSSAElimTest, OverflowCreatingPhi) {
+  // The load in %merge needs a Phi, but there is no id left for it.
+  const std::string text = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %4 "main" %17
+OpExecutionMode %4 OriginUpperLeft
+%2 = OpTypeVoid
+%3 = OpTypeFunction %2
+%6 = OpTypeFloat 32
+%7 = OpConstant %6 0
+%8 = OpConstant %6 1
+%9 = OpTypeBool
+%10 = OpConstantTrue %9
+%16 = OpTypePointer Output %6
+%23 = OpTypePointer Function %6
+%17 = OpVariable %16 Output
+%4 = OpFunction %2 None %3
+%20 = OpLabel
+%4194302 = OpVariable %23 Function
+OpSelectionMerge %24 None
+OpBranchConditional %10 %21 %22
+%21 = OpLabel
+OpStore %4194302 %7
+OpBranch %24
+%22 = OpLabel
+OpStore %4194302 %8
+OpBranch %24
+%24 = OpLabel
+%25 = OpLoad %6 %4194302
+OpStore %17 %25
+OpReturn
+OpFunctionEnd
+  )";
+
+  SetAssembleOptions(SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+
+  std::vector<Message> messages = {
+      {SPV_MSG_ERROR, "", 0, 0, "ID overflow. Try running compact-ids."}};
+  SetMessageConsumer(GetTestMessageConsumer(messages));
+  auto result = SinglePassRunToBinary<SSARewritePass>(text, true);
+  EXPECT_EQ(Pass::Status::Failure, std::get<1>(result));
+}
+
 // TODO(greg-lunarg): Add tests to verify handling of these cases:
 //
 //    No optimization in the presence of
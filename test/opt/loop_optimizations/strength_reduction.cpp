@@ -0,0 +1,144 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "test/opt/pass_fixture.h"
+#include "test/opt/pass_utils.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using StrengthReductionTest = PassTest<::testing::Test>;
+
+const std::string kPrologue = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %main "main" %out
+               OpExecutionMode %main OriginUpperLeft
+               OpName %main "main"
+               OpName %out "out"
+               OpName %x "x"
+               OpName %entry "entry"
+               OpName %header "header"
+               OpName %body "body"
+               OpName %merge "merge"
+               OpName %i "i"
+       %void = OpTypeVoid
+         %fn = OpTypeFunction %void
+       %bool = OpTypeBool
+        %int = OpTypeInt 32 1
+      %float = OpTypeFloat 32
+      %int_0 = OpConstant %int 0
+      %int_1 = OpConstant %int 1
+      %int_3 = OpConstant %int 3
+      %int_4 = OpConstant %int 4
+     %int_10 = OpConstant %int 10
+     %int_64 = OpConstant %int 64
+    %float_1 = OpConstant %float 1
+        %arr = OpTypeArray %float %int_64
+%_ptr_Function_arr = OpTypePointer Function %arr
+%_ptr_Function_float = OpTypePointer Function %float
+%_ptr_Output_int = OpTypePointer Output %int
+        %out = OpVariable %_ptr_Output_int Output
+       %main = OpFunction %void None %fn
+      %entry = OpLabel
+          %x = OpVariable %_ptr_Function_arr Function
+               OpBranch %header
+     %header = OpLabel
+)";
+
+TEST_F(StrengthReductionTest, MultiplicationBecomesInductionVariable) {
+  // for (int i = 0; i < 10; ++i) x[i * 4 + 3] = 1.0f;
+  const std::string text = kPrologue + R"(
+; CHECK: %header = OpLabel
+; CHECK-NEXT: [[iv:%\w+]] = OpPhi %int %int_3 %entry [[next:%\w+]] %body
+; CHECK-NOT: OpIMul
+; CHECK: OpAccessChain %_ptr_Function_float %x [[iv]]
+; CHECK: [[next]] = OpIAdd %int [[iv]] %int_4
+; CHECK-NEXT: OpBranch %header
+          %i = OpPhi %int %int_0 %entry %next %body
+        %cmp = OpSLessThan %bool %i %int_10
+               OpLoopMerge %merge %body None
+               OpBranchConditional %cmp %body %merge
+       %body = OpLabel
+          %m = OpIMul %int %i %int_4
+          %a = OpIAdd %int %m %int_3
+         %ac = OpAccessChain %_ptr_Function_float %x %a
+               OpStore %ac %float_1
+       %next = OpIAdd %int %i %int_1
+               OpBranch %header
+      %merge = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<LoopStrengthReductionPass>(text, true);
+}
+
+TEST_F(StrengthReductionTest, RedundantInductionVariablesAreMerged) {
+  // Two induction variables with the same start and step.
+  const std::string text = kPrologue + R"(
+; CHECK: %i = OpPhi %int %int_0 %entry [[next:%\w+]] %body
+; CHECK-NOT: OpPhi
+; CHECK: OpAccessChain %_ptr_Function_float %x %i
+; CHECK: [[next]] = OpIAdd %int %i %int_1
+; CHECK-NEXT: OpBranch %header
+          %i = OpPhi %int %int_0 %entry %next %body
+          %j = OpPhi %int %int_0 %entry %next_j %body
+        %cmp = OpSLessThan %bool %i %int_10
+               OpLoopMerge %merge %body None
+               OpBranchConditional %cmp %body %merge
+       %body = OpLabel
+         %ac = OpAccessChain %_ptr_Function_float %x %j
+               OpStore %ac %float_1
+       %next = OpIAdd %int %i %int_1
+     %next_j = OpIAdd %int %j %int_1
+               OpBranch %header
+      %merge = OpLabel
+               OpReturn
+               OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<LoopStrengthReductionPass>(text, true);
+}
+
+TEST_F(StrengthReductionTest, ExitValueIsReplaced) {
+  // The value of |i| after the loop is its trip count.
+  const std::string text = kPrologue + R"(
+; CHECK: %merge = OpLabel
+; CHECK-NEXT: OpStore %out %int_10
+          %i = OpPhi %int %int_0 %entry %next %body
+        %cmp = OpSLessThan %bool %i %int_10
+               OpLoopMerge %merge %body None
+               OpBranchConditional %cmp %body %merge
+       %body = OpLabel
+         %ac = OpAccessChain %_ptr_Function_float %x %i
+               OpStore %ac %float_1
+       %next = OpIAdd %int %i %int_1
+               OpBranch %header
+      %merge = OpLabel
+               OpStore %out %i
+               OpReturn
+               OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<LoopStrengthReductionPass>(text, true);
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
@@ -2998,6 +2998,180 @@ TEST_F(PassClassTest, OpPhiSelfReference) {
                                            kUnrollFactor);
 }
 
+// Returns a shader with a loop storing 1.0 to the first |trip_count| elements
+// of a local array, without any loop control.
+std::string GetAutoUnrollShader(const std::string& trip_count) {
+  return R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+%void = OpTypeVoid
+%void_fn = OpTypeFunction %void
+%int = OpTypeInt 32 1
+%int_0 = OpConstant %int 0
+%int_1 = OpConstant %int 1
+%int_n = OpConstant %int )" +
+         trip_count + R"(
+%bool = OpTypeBool
+%float = OpTypeFloat 32
+%float_1 = OpConstant %float 1
+%uint = OpTypeInt 32 0
+%uint_n = OpConstant %uint )" +
+         trip_count + R"(
+%array = OpTypeArray %float %uint_n
+%_ptr_Function_array = OpTypePointer Function %array
+%_ptr_Function_float = OpTypePointer Function %float
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+%x = OpVariable %_ptr_Function_array Function
+OpBranch %header
+%header = OpLabel
+%i = OpPhi %int %int_0 %entry %next %continue
+OpLoopMerge %merge %continue None
+OpBranch %condition
+%condition = OpLabel
+%cmp = OpSLessThan %bool %i %int_n
+OpBranchConditional %cmp %body %merge
+%body = OpLabel
+%ptr = OpAccessChain %_ptr_Function_float %x %i
+OpStore %ptr %float_1
+OpBranch %continue
+%continue = OpLabel
+%next = OpIAdd %int %i %int_1
+OpBranch %header
+%merge = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+}
+
+TEST_F(PassClassTest, AutomaticUnrollFull) {
+  // The four copies of the body fit in the budget.
+  const std::string text = R"(
+; CHECK-NOT: OpLoopMerge
+; CHECK: OpStore
+; CHECK: OpStore
+; CHECK: OpStore
+; CHECK: OpStore
+; CHECK-NOT: OpStore
+; CHECK: OpReturn
+)" + GetAutoUnrollShader("4");
+
+  SinglePassRunAndMatch<LoopUnroller>(text, true, 256u, 64u);
+}
+
+TEST_F(PassClassTest, AutomaticUnrollPartial) {
+  // Only four copies of the body fit in 40 instructions, and 4 divides the
+  // trip count.
+  const std::string text = R"(
+; CHECK: OpLoopMerge
+; CHECK: OpStore
+; CHECK: OpStore
+; CHECK: OpStore
+; CHECK: OpStore
+; CHECK-NOT: OpStore
+; CHECK: OpReturn
+)" + GetAutoUnrollShader("64");
+
+  SinglePassRunAndMatch<LoopUnroller>(text, true, 40u, 64u);
+}
+
+TEST_F(PassClassTest, AutomaticUnrollRegisterLimit) {
+  // The array is live through the loop, and each copy of the body needs at
+  // least one more register, so no copy fits in two registers.
+  const std::string text = GetAutoUnrollShader("4");
+
+  auto result = SinglePassRunAndDisassemble<LoopUnroller>(
+      text, /* skip_nop = */ true, /* do_validation = */ true, 256u, 2u);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+TEST_F(PassClassTest, AutomaticUnrollSingleIteration) {
+  // A loop that runs once is fully unrolled.
+  const std::string text = R"(
+; CHECK-NOT: OpLoopMerge
+; CHECK: OpStore
+; CHECK-NOT: OpStore
+; CHECK: OpReturn
+)" + GetAutoUnrollShader("1");
+
+  SinglePassRunAndMatch<LoopUnroller>(text, true, 256u, 64u);
+}
+
+TEST_F(PassClassTest, AutomaticUnrollNestedLoops) {
+  // The inner loop has 9 instructions, so it is fully unrolled into 36.  The
+  // outer loop then has 44 instructions, and even two copies of it do not fit
+  // in 64.  Before the inner loop is unrolled, four copies would fit.
+  const std::string text = R"(
+; CHECK: OpLoopMerge
+; CHECK-NOT: OpLoopMerge
+; CHECK: OpStore
+; CHECK: OpStore
+; CHECK: OpStore
+; CHECK: OpStore
+; CHECK-NOT: OpStore
+; CHECK: OpReturn
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+%void = OpTypeVoid
+%void_fn = OpTypeFunction %void
+%int = OpTypeInt 32 1
+%int_0 = OpConstant %int 0
+%int_1 = OpConstant %int 1
+%int_4 = OpConstant %int 4
+%bool = OpTypeBool
+%float = OpTypeFloat 32
+%float_1 = OpConstant %float 1
+%uint = OpTypeInt 32 0
+%uint_4 = OpConstant %uint 4
+%array = OpTypeArray %float %uint_4
+%_ptr_Function_array = OpTypePointer Function %array
+%_ptr_Function_float = OpTypePointer Function %float
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+%x = OpVariable %_ptr_Function_array Function
+OpBranch %outer_header
+%outer_header = OpLabel
+%i = OpPhi %int %int_0 %entry %i_next %outer_continue
+OpLoopMerge %outer_merge %outer_continue None
+OpBranch %outer_condition
+%outer_condition = OpLabel
+%outer_cmp = OpSLessThan %bool %i %int_4
+OpBranchConditional %outer_cmp %outer_body %outer_merge
+%outer_body = OpLabel
+OpBranch %inner_header
+%inner_header = OpLabel
+%j = OpPhi %int %int_0 %outer_body %j_next %inner_continue
+OpLoopMerge %inner_merge %inner_continue None
+OpBranch %inner_condition
+%inner_condition = OpLabel
+%inner_cmp = OpSLessThan %bool %j %int_4
+OpBranchConditional %inner_cmp %inner_body %inner_merge
+%inner_body = OpLabel
+%ptr = OpAccessChain %_ptr_Function_float %x %j
+OpStore %ptr %float_1
+OpBranch %inner_continue
+%inner_continue = OpLabel
+%j_next = OpIAdd %int %j %int_1
+OpBranch %inner_header
+%inner_merge = OpLabel
+OpBranch %outer_continue
+%outer_continue = OpLabel
+%i_next = OpIAdd %int %i %int_1
+OpBranch %outer_header
+%outer_merge = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<LoopUnroller>(text, true, 64u, 64u);
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
@@ -0,0 +1,197 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "source/opt/memory_ssa.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "source/opt/build_module.h"
+#include "source/opt/ir_context.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using ::testing::UnorderedElementsAre;
+
+const std::string kShader = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %1 "main"
+               OpExecutionMode %1 OriginUpperLeft
+          %2 = OpTypeVoid
+          %3 = OpTypeFunction %2
+          %4 = OpTypeBool
+          %5 = OpTypeInt 32 1
+          %6 = OpTypePointer Function %5
+          %7 = OpConstant %5 0
+          %8 = OpConstant %5 1
+          %9 = OpConstantTrue %4
+         %10 = OpTypeArray %5 %8
+         %11 = OpTypePointer Function %10
+          %1 = OpFunction %2 None %3
+         %20 = OpLabel
+         %21 = OpVariable %6 Function
+         %22 = OpVariable %11 Function
+         %23 = OpLoad %5 %21
+         %24 = OpAccessChain %6 %22 %7
+               OpStore %24 %7
+               OpStore %21 %7
+               OpSelectionMerge %32 None
+               OpBranchConditional %9 %30 %31
+         %30 = OpLabel
+               OpStore %21 %8
+         %33 = OpLoad %5 %21
+               OpBranch %32
+         %31 = OpLabel
+         %34 = OpLoad %5 %21
+               OpBranch %32
+         %32 = OpLabel
+         %35 = OpLoad %5 %21
+               OpBranch %40
+         %40 = OpLabel
+         %41 = OpLoad %5 %21
+               OpLoopMerge %43 %42 None
+               OpBranchConditional %9 %42 %43
+         %42 = OpLabel
+               OpStore %21 %41
+               OpBranch %40
+         %43 = OpLabel
+         %44 = OpLoad %5 %21
+         %45 = OpLoad %5 %24
+               OpReturn
+               OpFunctionEnd
+)";
+
+class MemorySSATest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    context_ = BuildModule(SPV_ENV_UNIVERSAL_1_2, nullptr, kShader,
+                           SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+    ASSERT_NE(context_, nullptr);
+  }
+
+  Instruction* Def(uint32_t id) {
+    return context_->get_def_use_mgr()->GetDef(id);
+  }
+
+  // Returns the store in block |block_id|.
+  Instruction* StoreIn(uint32_t block_id) {
+    for (Instruction& inst : *context_->get_instr_block(block_id)) {
+      if (inst.opcode() == SpvOpStore &&
+          inst.GetSingleWordInOperand(0) == 21) {
+        return &inst;
+      }
+    }
+    return nullptr;
+  }
+
+  std::unique_ptr<IRContext> context_;
+};
+
+TEST_F(MemorySSATest, ModeledVariables) {
+  MemorySSA* memory_ssa = context_->GetMemorySSA();
+  EXPECT_TRUE(memory_ssa->IsModeledVariable(21));
+  // %22 is used by an access chain.
+  EXPECT_FALSE(memory_ssa->IsModeledVariable(22));
+  EXPECT_EQ(memory_ssa->GetReachingDef(Def(45)), nullptr);
+}
+
+TEST_F(MemorySSATest, LoadBeforeAnyStore) {
+  MemorySSA* memory_ssa = context_->GetMemorySSA();
+  MemoryAccess* def = memory_ssa->GetReachingDef(Def(23));
+  ASSERT_NE(def, nullptr);
+  EXPECT_EQ(def->kind(), MemoryAccess::kLiveOnEntry);
+  EXPECT_EQ(def->instruction(), Def(21));
+
+  std::vector<Instruction*> stores;
+  EXPECT_TRUE(memory_ssa->GetReachingStores(Def(23), &stores));
+  EXPECT_TRUE(stores.empty());
+}
+
+TEST_F(MemorySSATest, StoresInTheSameAndDominatingBlocks) {
+  MemorySSA* memory_ssa = context_->GetMemorySSA();
+  EXPECT_EQ(memory_ssa->GetUniqueReachingStore(Def(33)), StoreIn(30));
+  EXPECT_EQ(memory_ssa->GetUniqueReachingStore(Def(34)), StoreIn(20));
+}
+
+TEST_F(MemorySSATest, StoresMergedAtSelection) {
+  MemorySSA* memory_ssa = context_->GetMemorySSA();
+  MemoryAccess* def = memory_ssa->GetReachingDef(Def(35));
+  ASSERT_NE(def, nullptr);
+  EXPECT_EQ(def->kind(), MemoryAccess::kPhi);
+  EXPECT_EQ(def->block(), context_->get_instr_block(32));
+
+  std::vector<Instruction*> stores;
+  EXPECT_FALSE(memory_ssa->GetReachingStores(Def(35), &stores));
+  EXPECT_THAT(stores, UnorderedElementsAre(StoreIn(20), StoreIn(30)));
+  EXPECT_EQ(memory_ssa->GetUniqueReachingStore(Def(35)), nullptr);
+}
+
+TEST_F(MemorySSATest, StoresMergedAtLoopHeader) {
+  MemorySSA* memory_ssa = context_->GetMemorySSA();
+
+  // Query the load after the loop first, so the loop header is reached
+  // through the merge block.
+  std::vector<Instruction*> after_loop;
+  EXPECT_FALSE(memory_ssa->GetReachingStores(Def(44), &after_loop));
+  EXPECT_THAT(after_loop,
+              UnorderedElementsAre(StoreIn(20), StoreIn(30), StoreIn(42)));
+
+  MemoryAccess* def = memory_ssa->GetReachingDef(Def(41));
+  ASSERT_NE(def, nullptr);
+  EXPECT_EQ(def->kind(), MemoryAccess::kPhi);
+  EXPECT_EQ(def->block(), context_->get_instr_block(40));
+  EXPECT_EQ(memory_ssa->GetReachingDef(Def(44)), def);
+}
+
+TEST_F(MemorySSATest, KillingInstructions) {
+  MemorySSA* memory_ssa = context_->GetMemorySSA();
+  EXPECT_EQ(memory_ssa->GetUniqueReachingStore(Def(34)), StoreIn(20));
+
+  // Removing a load keeps the analysis.
+  context_->KillInst(Def(33));
+  EXPECT_TRUE(context_->AreAnalysesValid(IRContext::kAnalysisMemorySSA));
+
+  // Removing a store does not.
+  context_->KillInst(StoreIn(30));
+  EXPECT_FALSE(context_->AreAnalysesValid(IRContext::kAnalysisMemorySSA));
+  EXPECT_EQ(context_->GetMemorySSA()->GetUniqueReachingStore(Def(35)),
+            StoreIn(20));
+}
+
+TEST_F(MemorySSATest, ReplacingLoadedValues) {
+  MemorySSA* memory_ssa = context_->GetMemorySSA();
+
+  // Replacing a load by a value, as local single store elimination does,
+  // keeps the analysis, even if the value is stored to a modeled variable.
+  Instruction* load = Def(41);
+  context_->ReplaceAllUsesWith(41, 7);
+  context_->KillInst(load);
+  EXPECT_TRUE(context_->AreAnalysesValid(IRContext::kAnalysisMemorySSA));
+
+  std::vector<Instruction*> stores;
+  EXPECT_FALSE(memory_ssa->GetReachingStores(Def(44), &stores));
+  EXPECT_THAT(stores,
+              UnorderedElementsAre(StoreIn(20), StoreIn(30), StoreIn(42)));
+  EXPECT_EQ(StoreIn(42)->GetSingleWordInOperand(1), 7u);
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
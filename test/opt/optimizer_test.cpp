@@ -193,8 +193,20 @@ TEST(Optimizer, CanRegisterPassesFromFlags) {
       "--loop-unroll-partial=3",
       "--loop-peeling",
       "--ccp",
+      "--partial-redundancy-elimination",
+      "--eliminate-dead-stores",
+      "--value-range-propagation",
+      "--interprocedural-ccp",
+      "--specialize-functions",
+      "--slp-vectorize",
+      "--loop-unroll-auto",
+      "--schedule-instructions",
+      "--rematerialize",
+      "--loop-strength-reduction",
       "-O",
       "-Os",
+      "--fixed-point-O",
+      "--fixed-point-Os",
       "--legalize-hlsl"};
   EXPECT_TRUE(opt.RegisterPassesFromFlags(pass_flags));
 
@@ -0,0 +1,255 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "test/opt/pass_fixture.h"
+#include "test/opt/pass_utils.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using PartialRedundancyEliminationTest = PassTest<::testing::Test>;
+
+// The start of a fragment shader, up to where the names of the ids used by
+// each test are added.
+const std::string kPreamble = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %in_a %in_b %in_c %out
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %in_a "in_a"
+OpName %in_b "in_b"
+OpName %in_c "in_c"
+OpName %out "out"
+OpName %entry "entry"
+OpName %a "a"
+OpName %b "b"
+OpName %c "c"
+OpName %cond "cond"
+)";
+
+// The rest of the shader, up to the end of the entry block.
+const std::string kHeader = R"(
+%void = OpTypeVoid
+%bool = OpTypeBool
+%int = OpTypeInt 32 1
+%int_0 = OpConstant %int 0
+%void_fn = OpTypeFunction %void
+%_ptr_Input_int = OpTypePointer Input %int
+%_ptr_Output_int = OpTypePointer Output %int
+%in_a = OpVariable %_ptr_Input_int Input
+%in_b = OpVariable %_ptr_Input_int Input
+%in_c = OpVariable %_ptr_Input_int Input
+%out = OpVariable %_ptr_Output_int Output
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+%a = OpLoad %int %in_a
+%b = OpLoad %int %in_b
+%c = OpLoad %int %in_c
+%cond = OpSLessThan %bool %a %int_0
+)";
+
+TEST_F(PartialRedundancyEliminationTest, ComputeOnMissingPath) {
+  const std::string text = kPreamble + R"(
+OpName %then "then"
+OpName %else "else"
+OpName %merge "merge"
+OpName %add1 "add1"
+)" + kHeader + R"(
+; CHECK: %else = OpLabel
+; CHECK-NEXT: [[copy:%\w+]] = OpIAdd %int %a %b
+; CHECK-NEXT: OpBranch %merge
+; CHECK: %merge = OpLabel
+; CHECK-NEXT: [[phi:%\w+]] = OpPhi %int %add1 %then [[copy]] %else
+; CHECK-NOT: OpIAdd
+; CHECK: OpStore %out [[phi]]
+OpSelectionMerge %merge None
+OpBranchConditional %cond %then %else
+%then = OpLabel
+%add1 = OpIAdd %int %a %b
+OpStore %out %add1
+OpBranch %merge
+%else = OpLabel
+OpBranch %merge
+%merge = OpLabel
+%add2 = OpIAdd %int %a %b
+OpStore %out %add2
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<PartialRedundancyEliminationPass>(text, true);
+}
+
+TEST_F(PartialRedundancyEliminationTest, AvailableOnAllPaths) {
+  const std::string text = kPreamble + R"(
+OpName %then "then"
+OpName %else "else"
+OpName %merge "merge"
+OpName %add1 "add1"
+OpName %add2 "add2"
+)" + kHeader + R"(
+; CHECK: %merge = OpLabel
+; CHECK-NEXT: [[phi:%\w+]] = OpPhi %int %add1 %then %add2 %else
+; CHECK-NOT: OpIAdd
+; CHECK: OpStore %out [[phi]]
+OpSelectionMerge %merge None
+OpBranchConditional %cond %then %else
+%then = OpLabel
+%add1 = OpIAdd %int %a %b
+OpStore %out %add1
+OpBranch %merge
+%else = OpLabel
+%add2 = OpIAdd %int %a %b
+OpStore %out %add2
+OpBranch %merge
+%merge = OpLabel
+%add3 = OpIAdd %int %a %b
+OpStore %out %add3
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<PartialRedundancyEliminationPass>(text, true);
+}
+
+TEST_F(PartialRedundancyEliminationTest, LoopInvariantInHeader) {
+  const std::string text = kPreamble + R"(
+OpName %header "header"
+OpName %cont "cont"
+OpName %add2 "add2"
+)" + kHeader + R"(
+; CHECK: %entry = OpLabel
+; CHECK: [[copy:%\w+]] = OpIAdd %int %a %b
+; CHECK-NEXT: OpBranch %header
+; CHECK: %header = OpLabel
+; CHECK: [[phi:%\w+]] = OpPhi %int [[copy]] %entry %add2 %cont
+; CHECK-NOT: OpIAdd %int %a %b
+; CHECK: OpStore %out [[phi]]
+OpBranch %header
+%header = OpLabel
+%i = OpPhi %int %int_0 %entry %inc %cont
+%add1 = OpIAdd %int %a %b
+OpStore %out %add1
+%loop_cond = OpSLessThan %bool %i %c
+OpLoopMerge %merge %cont None
+OpBranchConditional %loop_cond %body %merge
+%body = OpLabel
+OpBranch %cont
+%cont = OpLabel
+%add2 = OpIAdd %int %a %b
+%inc = OpIAdd %int %i %add2
+OpBranch %header
+%merge = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<PartialRedundancyEliminationPass>(text, true);
+}
+
+TEST_F(PartialRedundancyEliminationTest, OperandDefinedInBlock) {
+  // %sum is defined in the merge block, so %add2 cannot be computed in %else.
+  const std::string text = kPreamble + kHeader + R"(
+OpSelectionMerge %merge None
+OpBranchConditional %cond %then %else
+%then = OpLabel
+%add1 = OpIAdd %int %a %b
+OpStore %out %add1
+OpBranch %merge
+%else = OpLabel
+OpBranch %merge
+%merge = OpLabel
+%sum = OpIAdd %int %a %c
+%add2 = OpIAdd %int %sum %b
+OpStore %out %add2
+OpReturn
+OpFunctionEnd
+)";
+
+  auto result = SinglePassRunAndDisassemble<PartialRedundancyEliminationPass>(
+      text, /* skip_nop = */ true, /* do_validation = */ false);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+TEST_F(PartialRedundancyEliminationTest, MissingPathHasConditionalBranch) {
+  // The value is missing on the edge from %entry, which does not always
+  // branch to %merge, so no copy can be added.
+  const std::string text = kPreamble + kHeader + R"(
+OpSelectionMerge %merge None
+OpBranchConditional %cond %then %merge
+%then = OpLabel
+%add1 = OpIAdd %int %a %b
+OpStore %out %add1
+OpBranch %merge
+%merge = OpLabel
+%add2 = OpIAdd %int %a %b
+OpStore %out %add2
+OpReturn
+OpFunctionEnd
+)";
+
+  auto result = SinglePassRunAndDisassemble<PartialRedundancyEliminationPass>(
+      text, /* skip_nop = */ true, /* do_validation = */ false);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+TEST_F(PartialRedundancyEliminationTest, DerivativeIsNotMoved) {
+  // A derivative depends on the other invocations of the quad, so it cannot
+  // be computed in a block where it was not before.
+  const std::string text = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %in_f %out_f
+OpExecutionMode %main OriginUpperLeft
+%void = OpTypeVoid
+%bool = OpTypeBool
+%float = OpTypeFloat 32
+%float_0 = OpConstant %float 0
+%void_fn = OpTypeFunction %void
+%_ptr_Input_float = OpTypePointer Input %float
+%_ptr_Output_float = OpTypePointer Output %float
+%in_f = OpVariable %_ptr_Input_float Input
+%out_f = OpVariable %_ptr_Output_float Output
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+%f = OpLoad %float %in_f
+%cond = OpFOrdLessThan %bool %f %float_0
+OpSelectionMerge %merge None
+OpBranchConditional %cond %then %else
+%then = OpLabel
+%dx1 = OpDPdx %float %f
+OpStore %out_f %dx1
+OpBranch %merge
+%else = OpLabel
+OpBranch %merge
+%merge = OpLabel
+%dx2 = OpDPdx %float %f
+OpStore %out_f %dx2
+OpReturn
+OpFunctionEnd
+)";
+
+  auto result = SinglePassRunAndDisassemble<PartialRedundancyEliminationPass>(
+      text, /* skip_nop = */ true, /* do_validation = */ false);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
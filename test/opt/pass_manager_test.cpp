@@ -14,6 +14,7 @@
 
 #include <initializer_list>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -29,6 +30,7 @@ namespace {
 
 using spvtest::GetIdBound;
 using ::testing::Eq;
+using ::testing::HasSubstr;
 
 // A null pass whose construtors accept arguments
 class NullPassWithArgs : public NullPass {
@@ -186,6 +188,41 @@ TEST(PassManager, RecomputeIdBoundAutomatically) {
   EXPECT_THAT(GetIdBound(*context.module()), Eq(201u));
 }
 
+TEST(PassManager, ProfileJson) {
+  PassManager manager;
+  std::unique_ptr<Module> module(new Module());
+  IRContext context(SPV_ENV_UNIVERSAL_1_2, std::move(module),
+                    manager.consumer());
+  std::ostringstream profile;
+  manager.SetProfileJson(&profile);
+  manager.AddPass<AppendOpNopPass>();
+  manager.AddPass<NullPass>();
+  manager.AddPass<AppendMultipleOpNopPass>(2);
+  EXPECT_EQ(Pass::Status::SuccessWithChange, manager.Run(&context));
+
+  const std::string json = profile.str();
+  EXPECT_THAT(json, HasSubstr(R"("passes": [)"));
+  EXPECT_THAT(json,
+              HasSubstr(R"({"name": "AppendOpNop", "status": "changed")"));
+  EXPECT_THAT(json, HasSubstr(R"({"name": "null", "status": "unchanged")"));
+  EXPECT_THAT(json, HasSubstr(R"("instructions": {"before": 0, "after": 1})"));
+  EXPECT_THAT(json, HasSubstr(R"("instructions": {"before": 1, "after": 1})"));
+  EXPECT_THAT(json, HasSubstr(R"("instructions": {"before": 1, "after": 3})"));
+  EXPECT_THAT(json, HasSubstr(R"("functions": {"before": 0, "after": 0})"));
+  EXPECT_THAT(json, HasSubstr(R"("analyses_built": [])"));
+}
+
+TEST(PassManager, ProfileJsonIsEmptyWithoutPasses) {
+  PassManager manager;
+  std::unique_ptr<Module> module(new Module());
+  IRContext context(SPV_ENV_UNIVERSAL_1_2, std::move(module),
+                    manager.consumer());
+  std::ostringstream profile;
+  manager.SetProfileJson(&profile);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, manager.Run(&context));
+  EXPECT_EQ("{\n  \"passes\": [\n  ]\n}\n", profile.str());
+}
+
 }  // anonymous namespace
 }  // namespace opt
 }  // namespace spvtools
@@ -172,6 +172,68 @@ OpMemoryModel Logical GLSL450
   EXPECT_EQ(GetErrorMessage(), "");
 }
 
+TEST_F(RemoveDuplicatesTest, InterleavedDuplicateTypes) {
+  const std::string spirv = R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+%1 = OpTypeInt 32 0
+%2 = OpTypeFloat 32
+%3 = OpTypeInt 32 0
+%4 = OpTypeVector %2 4
+%5 = OpTypeFloat 32
+%6 = OpTypeVector %5 4
+%7 = OpTypeStruct %1 %4
+%8 = OpTypeStruct %3 %6
+)";
+  const std::string after = R"(OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+%1 = OpTypeInt 32 0
+%2 = OpTypeFloat 32
+%4 = OpTypeVector %2 4
+%7 = OpTypeStruct %1 %4
+)";
+
+  EXPECT_EQ(RunPass(spirv), after);
+  EXPECT_EQ(GetErrorMessage(), "");
+}
+
+TEST_F(RemoveDuplicatesTest, DuplicateDecorations) {
+  const std::string spirv = R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+OpDecorate %1 Restrict
+OpMemberDecorate %2 0 Offset 0
+OpDecorate %1 Restrict
+OpMemberDecorate %2 0 Offset 4
+OpMemberDecorate %2 0 Offset 0
+OpDecorate %3 Restrict
+%4 = OpTypeInt 32 0
+%2 = OpTypeStruct %4
+%5 = OpTypePointer Function %4
+%1 = OpUndef %5
+%3 = OpUndef %5
+)";
+  const std::string after = R"(OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+OpDecorate %1 Restrict
+OpMemberDecorate %2 0 Offset 0
+OpMemberDecorate %2 0 Offset 4
+OpDecorate %3 Restrict
+%4 = OpTypeInt 32 0
+%2 = OpTypeStruct %4
+%5 = OpTypePointer Function %4
+%1 = OpUndef %5
+%3 = OpUndef %5
+)";
+
+  EXPECT_EQ(RunPass(spirv), after);
+  EXPECT_EQ(GetErrorMessage(), "");
+}
+
 TEST_F(RemoveDuplicatesTest, SameTypeDifferentMemberDecoration) {
   const std::string spirv = R"(
 OpCapability Shader
@@ -218,6 +280,32 @@ OpDecorate %1 GLSLPacked
   EXPECT_EQ(GetErrorMessage(), "");
 }
 
+TEST_F(RemoveDuplicatesTest, SameTypeAndReorderedDecorations) {
+  const std::string spirv = R"(
+OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+OpDecorate %1 GLSLPacked
+OpDecorate %1 Block
+OpDecorate %2 Block
+OpDecorate %2 GLSLPacked
+%3 = OpTypeInt 32 0
+%1 = OpTypeStruct %3 %3
+%2 = OpTypeStruct %3 %3
+)";
+  const std::string after = R"(OpCapability Shader
+OpCapability Linkage
+OpMemoryModel Logical GLSL450
+OpDecorate %1 GLSLPacked
+OpDecorate %1 Block
+%3 = OpTypeInt 32 0
+%1 = OpTypeStruct %3 %3
+)";
+
+  EXPECT_EQ(RunPass(spirv), after);
+  EXPECT_EQ(GetErrorMessage(), "");
+}
+
 TEST_F(RemoveDuplicatesTest, SameTypeAndDifferentName) {
   const std::string spirv = R"(
 OpCapability Shader
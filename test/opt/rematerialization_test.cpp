@@ -0,0 +1,101 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "test/opt/pass_fixture.h"
+#include "test/opt/pass_utils.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using RematerializationTest = PassTest<::testing::Test>;
+
+// A fragment shader that loads %u from a uniform buffer in the entry block,
+// and only uses it after a selection whose then block does not use it.
+const std::string kShader = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %in_x %out_y %out_z
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %ubo "ubo"
+OpName %x "x"
+OpName %merge "merge"
+OpName %out_z "out_z"
+OpMemberDecorate %block 0 Offset 0
+OpDecorate %block Block
+OpDecorate %ubo DescriptorSet 0
+OpDecorate %ubo Binding 0
+%void = OpTypeVoid
+%bool = OpTypeBool
+%int = OpTypeInt 32 1
+%int_0 = OpConstant %int 0
+%float = OpTypeFloat 32
+%float_0 = OpConstant %float 0
+%block = OpTypeStruct %float
+%_ptr_Uniform_block = OpTypePointer Uniform %block
+%_ptr_Uniform_float = OpTypePointer Uniform %float
+%_ptr_Input_float = OpTypePointer Input %float
+%_ptr_Output_float = OpTypePointer Output %float
+%void_fn = OpTypeFunction %void
+%ubo = OpVariable %_ptr_Uniform_block Uniform
+%in_x = OpVariable %_ptr_Input_float Input
+%out_y = OpVariable %_ptr_Output_float Output
+%out_z = OpVariable %_ptr_Output_float Output
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+%ptr = OpAccessChain %_ptr_Uniform_float %ubo %int_0
+%u = OpLoad %float %ptr
+%x = OpLoad %float %in_x
+%cond = OpFOrdLessThan %bool %x %float_0
+OpSelectionMerge %merge None
+OpBranchConditional %cond %then %merge
+%then = OpLabel
+%y = OpFMul %float %x %x
+OpStore %out_y %y
+OpBranch %merge
+%merge = OpLabel
+%z = OpFAdd %float %u %x
+OpStore %out_z %z
+OpReturn
+OpFunctionEnd
+)";
+
+TEST_F(RematerializationTest, LoadFromUniformBuffer) {
+  // With a target of one register, the then block is crowded, so %u is
+  // loaded again in the merge block instead.
+  const std::string text = R"(
+; CHECK-NOT: OpAccessChain
+; CHECK: %merge = OpLabel
+; CHECK-NEXT: [[ptr:%\w+]] = OpAccessChain %_ptr_Uniform_float %ubo %int_0
+; CHECK-NEXT: [[u:%\w+]] = OpLoad %float [[ptr]]
+; CHECK-NEXT: [[z:%\w+]] = OpFAdd %float [[u]] %x
+; CHECK-NEXT: OpStore %out_z [[z]]
+)" + kShader;
+
+  SinglePassRunAndMatch<RematerializationPass>(text, true, 1u);
+}
+
+TEST_F(RematerializationTest, PressureUnderTarget) {
+  auto result = SinglePassRunAndDisassemble<RematerializationPass>(
+      kShader, /* skip_nop = */ true, /* do_validation = */ true, 32u);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
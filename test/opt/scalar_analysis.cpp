@@ -1216,6 +1216,67 @@ TEST_F(ScalarAnalysisTest, InductionWithVariantStep) {
   EXPECT_EQ(simplified_2->GetType(), SENode::CanNotCompute);
 }
 
+// The analysis kept by the context forgets the evolutions of a loop when its
+// instructions change, and is invalidated with the loops.
+TEST_F(ScalarAnalysisTest, InvalidationThroughContext) {
+  const std::string text = R"(
+               OpCapability Shader
+               OpMemoryModel Logical GLSL450
+               OpEntryPoint Fragment %4 "main"
+               OpExecutionMode %4 OriginUpperLeft
+          %2 = OpTypeVoid
+          %3 = OpTypeFunction %2
+          %6 = OpTypeInt 32 1
+          %9 = OpConstant %6 0
+         %16 = OpConstant %6 10
+         %17 = OpTypeBool
+         %27 = OpConstant %6 1
+          %4 = OpFunction %2 None %3
+          %5 = OpLabel
+               OpBranch %10
+         %10 = OpLabel
+         %35 = OpPhi %6 %9 %5 %34 %13
+         %18 = OpSLessThan %17 %35 %16
+               OpLoopMerge %12 %13 None
+               OpBranchConditional %18 %13 %12
+         %13 = OpLabel
+         %34 = OpIAdd %6 %35 %27
+               OpBranch %10
+         %12 = OpLabel
+               OpReturn
+               OpFunctionEnd
+  )";
+  std::unique_ptr<IRContext> context =
+      BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, text,
+                  SPV_TEXT_TO_BINARY_OPTION_PRESERVE_NUMERIC_IDS);
+  Module* module = context->module();
+  EXPECT_NE(nullptr, module) << "Assembling failed for shader:\n"
+                             << text << std::endl;
+  analysis::DefUseManager* def_use_mgr = context->get_def_use_mgr();
+  Instruction* phi = def_use_mgr->GetDef(35);
+  Instruction* increment = def_use_mgr->GetDef(34);
+
+  ScalarEvolutionAnalysis* analysis = context->GetScalarEvolutionAnalysis();
+  auto get_step = [analysis, phi]() {
+    SENode* node = analysis->AnalyzeInstruction(phi);
+    SEConstantNode* step =
+        node->AsSERecurrentNode()->GetCoefficient()->AsSEConstantNode();
+    return step->FoldToSingleValue();
+  };
+  EXPECT_EQ(get_step(), 1);
+
+  // Change the step of the loop to 10.
+  context->ReplaceAllUsesWithPredicate(
+      27, 16,
+      [increment](Instruction* user, uint32_t) { return user == increment; });
+  EXPECT_TRUE(context->AreAnalysesValid(IRContext::kAnalysisScalarEvolution));
+  EXPECT_EQ(analysis, context->GetScalarEvolutionAnalysis());
+  EXPECT_EQ(get_step(), 10);
+
+  context->InvalidateAnalyses(IRContext::kAnalysisLoopAnalysis);
+  EXPECT_FALSE(context->AreAnalysesValid(IRContext::kAnalysisScalarEvolution));
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
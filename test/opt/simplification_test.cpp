@@ -360,6 +360,50 @@ OpFunctionEnd
   SinglePassRunAndMatch<SimplificationPass>(spirv, true);
 }
 
+TEST_F(SimplificationTest, RerunRevisitsChangedInstructions) {
+  // A second run of the pass must pick up an instruction that was changed
+  // after the first run, even though the rest of the function is unchanged.
+  const std::string text = R"(OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %2 "main" %3
+OpExecutionMode %2 OriginUpperLeft
+%1 = OpTypeVoid
+%4 = OpTypeFunction %1
+%5 = OpTypeInt 32 1
+%6 = OpTypePointer Output %5
+%7 = OpTypePointer Private %5
+%8 = OpConstant %5 0
+%9 = OpConstant %5 1
+%3 = OpVariable %6 Output
+%10 = OpVariable %7 Private
+%2 = OpFunction %1 None %4
+%11 = OpLabel
+%12 = OpLoad %5 %10
+%13 = OpIAdd %5 %12 %9
+OpStore %3 %13
+OpReturn
+OpFunctionEnd
+)";
+
+  auto context = BuildModule(SPV_ENV_UNIVERSAL_1_1, nullptr, text);
+  ASSERT_NE(context, nullptr);
+
+  SimplificationPass pass;
+  EXPECT_EQ(pass.Run(context.get()), Pass::Status::SuccessWithoutChange);
+
+  Instruction* add = context->get_def_use_mgr()->GetDef(13);
+  add->SetInOperand(1, {8});
+  context->AnalyzeUses(add);
+
+  EXPECT_EQ(pass.Run(context.get()), Pass::Status::SuccessWithChange);
+  Instruction* store = nullptr;
+  for (auto& inst : *context->module()->begin()->begin()) {
+    if (inst.opcode() == SpvOpStore) store = &inst;
+  }
+  ASSERT_NE(store, nullptr);
+  EXPECT_EQ(store->GetSingleWordInOperand(1), 12u);
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
@@ -0,0 +1,136 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "test/opt/pass_fixture.h"
+#include "test/opt/pass_utils.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using SLPVectorizerTest = PassTest<::testing::Test>;
+
+// The start of a fragment shader with two vector inputs, loaded into %a and
+// %b, and a vector output.
+const std::string kHeader = R"(
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %in_a %in_b %out %out_x
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %a "a"
+OpName %b "b"
+OpName %out "out"
+OpName %out_x "out_x"
+%void = OpTypeVoid
+%float = OpTypeFloat 32
+%v2float = OpTypeVector %float 2
+%float_2 = OpConstant %float 2
+%float_3 = OpConstant %float 3
+%void_fn = OpTypeFunction %void
+%_ptr_Input_v2float = OpTypePointer Input %v2float
+%_ptr_Output_v2float = OpTypePointer Output %v2float
+%_ptr_Output_float = OpTypePointer Output %float
+%in_a = OpVariable %_ptr_Input_v2float Input
+%in_b = OpVariable %_ptr_Input_v2float Input
+%out = OpVariable %_ptr_Output_v2float Output
+%out_x = OpVariable %_ptr_Output_float Output
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+%a = OpLoad %v2float %in_a
+%b = OpLoad %v2float %in_b
+%a0 = OpCompositeExtract %float %a 0
+%a1 = OpCompositeExtract %float %a 1
+%b0 = OpCompositeExtract %float %b 0
+%b1 = OpCompositeExtract %float %b 1
+)";
+
+TEST_F(SLPVectorizerTest, AddOfExtracts) {
+  const std::string text = kHeader + R"(
+; CHECK-NOT: OpCompositeExtract
+; CHECK: [[add:%\w+]] = OpFAdd %v2float %a %b
+; CHECK-NOT: OpCompositeConstruct
+; CHECK: OpStore %out [[add]]
+%s0 = OpFAdd %float %a0 %b0
+%s1 = OpFAdd %float %a1 %b1
+%v = OpCompositeConstruct %v2float %s0 %s1
+OpStore %out %v
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<SLPVectorizerPass>(text, true);
+}
+
+TEST_F(SLPVectorizerTest, SwizzleTimesConstant) {
+  // The components of %a are swapped, and each is multiplied by a different
+  // constant.
+  const std::string text = kHeader + R"(
+; CHECK: [[c:%\w+]] = OpConstantComposite %v2float %float_2 %float_3
+; CHECK: [[swizzle:%\w+]] = OpVectorShuffle %v2float %a %a 1 0
+; CHECK: [[mul:%\w+]] = OpFMul %v2float [[swizzle]] [[c]]
+; CHECK: [[add:%\w+]] = OpFAdd %v2float [[mul]] %b
+; CHECK: OpStore %out [[add]]
+%m0 = OpFMul %float %a1 %float_2
+%m1 = OpFMul %float %a0 %float_3
+%s0 = OpFAdd %float %m0 %b0
+%s1 = OpFAdd %float %m1 %b1
+%v = OpCompositeConstruct %v2float %s0 %s1
+OpStore %out %v
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<SLPVectorizerPass>(text, true);
+}
+
+TEST_F(SLPVectorizerTest, DifferentOperations) {
+  const std::string text = kHeader + R"(
+%s0 = OpFAdd %float %a0 %b0
+%s1 = OpFSub %float %a1 %b1
+%v = OpCompositeConstruct %v2float %s0 %s1
+OpStore %out %v
+OpReturn
+OpFunctionEnd
+)";
+
+  auto result = SinglePassRunAndDisassemble<SLPVectorizerPass>(
+      text, /* skip_nop = */ true, /* do_validation = */ true);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+TEST_F(SLPVectorizerTest, ComponentUsedElsewhere) {
+  // %s0 is also stored on its own, so it has to be computed as a scalar
+  // anyway.
+  const std::string text = kHeader + R"(
+%s0 = OpFAdd %float %a0 %b0
+%s1 = OpFAdd %float %a1 %b1
+%v = OpCompositeConstruct %v2float %s0 %s1
+OpStore %out %v
+OpStore %out_x %s0
+OpReturn
+OpFunctionEnd
+)";
+
+  auto result = SinglePassRunAndDisassemble<SLPVectorizerPass>(
+      text, /* skip_nop = */ true, /* do_validation = */ true);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
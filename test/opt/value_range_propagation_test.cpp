@@ -0,0 +1,250 @@
+// Copyright (c) 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "test/opt/pass_fixture.h"
+#include "test/opt/pass_utils.h"
+
+namespace spvtools {
+namespace opt {
+namespace {
+
+using ValueRangePropagationTest = PassTest<::testing::Test>;
+
+// The start of a fragment shader, up to where the names of the ids used by
+// each test are added.
+const std::string kPreamble = R"(
+OpCapability Shader
+%glsl = OpExtInstImport "GLSL.std.450"
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %in %out
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %in "in"
+OpName %out "out"
+OpName %glsl "glsl"
+OpName %a "a"
+)";
+
+// The types and variables, and the start of the entry block of %main.
+const std::string kHeader = R"(
+%void = OpTypeVoid
+%bool = OpTypeBool
+%int = OpTypeInt 32 1
+%int_0 = OpConstant %int 0
+%int_1 = OpConstant %int 1
+%int_5 = OpConstant %int 5
+%int_7 = OpConstant %int 7
+%int_8 = OpConstant %int 8
+%int_15 = OpConstant %int 15
+%int_16 = OpConstant %int 16
+%int_20 = OpConstant %int 20
+%void_fn = OpTypeFunction %void
+%_ptr_Input_int = OpTypePointer Input %int
+%_ptr_Output_int = OpTypePointer Output %int
+%in = OpVariable %_ptr_Input_int Input
+%out = OpVariable %_ptr_Output_int Output
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+%a = OpLoad %int %in
+)";
+
+TEST_F(ValueRangePropagationTest, ClampOfLoopIndex) {
+  // The loop condition keeps %i in [0, 15] in the body, so the clamp and the
+  // comparison with 20 are redundant.
+  const std::string text = kPreamble + R"(
+OpName %i "i"
+OpName %body "body"
+OpName %then "then"
+OpName %then_merge "then_merge"
+)" + kHeader + R"(
+; CHECK: OpExtInst %int %glsl SClamp %i %int_0 %int_15
+; CHECK: OpBranchConditional %true %then %then_merge
+; CHECK: %then = OpLabel
+; CHECK-NEXT: OpStore %out %i
+OpBranch %header
+%header = OpLabel
+%i = OpPhi %int %int_0 %entry %inc %continue
+%cmp = OpSLessThan %bool %i %int_16
+OpLoopMerge %merge %continue None
+OpBranchConditional %cmp %body %merge
+%body = OpLabel
+%clamp = OpExtInst %int %glsl SClamp %i %int_0 %int_15
+%lt = OpSLessThan %bool %i %int_20
+OpSelectionMerge %then_merge None
+OpBranchConditional %lt %then %then_merge
+%then = OpLabel
+OpStore %out %clamp
+OpBranch %then_merge
+%then_merge = OpLabel
+OpBranch %continue
+%continue = OpLabel
+%inc = OpIAdd %int %i %int_1
+OpBranch %header
+%merge = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<ValueRangePropagationPass>(text, true);
+}
+
+TEST_F(ValueRangePropagationTest, ConditionImpliedByDominatingBranch) {
+  const std::string text = kPreamble + R"(
+OpName %neg "neg"
+OpName %big "big"
+OpName %inner "inner"
+OpName %inner_merge "inner_merge"
+)" + kHeader + R"(
+; CHECK: OpBranchConditional %neg
+; CHECK: OpBranchConditional %false %inner %inner_merge
+%neg = OpSLessThan %bool %a %int_0
+OpSelectionMerge %merge None
+OpBranchConditional %neg %then %merge
+%then = OpLabel
+%big = OpSGreaterThan %bool %a %int_5
+OpSelectionMerge %inner_merge None
+OpBranchConditional %big %inner %inner_merge
+%inner = OpLabel
+OpStore %out %int_1
+OpBranch %inner_merge
+%inner_merge = OpLabel
+OpBranch %merge
+%merge = OpLabel
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<ValueRangePropagationPass>(text, true);
+}
+
+TEST_F(ValueRangePropagationTest, MaskedValue) {
+  // %and is in [0, 7].
+  const std::string text = kPreamble + R"(
+OpName %and "and"
+)" + kHeader + R"(
+; CHECK: %and = OpBitwiseAnd %int %a %int_7
+; CHECK: OpStore %out %and
+; CHECK: OpSelect %int %true
+%and = OpBitwiseAnd %int %a %int_7
+%min = OpExtInst %int %glsl UMin %and %int_15
+OpStore %out %min
+%lt = OpSLessThan %bool %and %int_8
+%sel = OpSelect %int %lt %a %int_0
+OpStore %out %sel
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<ValueRangePropagationPass>(text, true);
+}
+
+TEST_F(ValueRangePropagationTest, ClampOfUnknownValue) {
+  const std::string text = kPreamble + R"(
+OpName %clamp "clamp"
+OpName %lt "lt"
+)" + kHeader + R"(
+%clamp = OpExtInst %int %glsl SClamp %a %int_0 %int_15
+%lt = OpSLessThan %bool %clamp %int_8
+%sel = OpSelect %int %lt %clamp %int_0
+OpStore %out %sel
+OpReturn
+OpFunctionEnd
+)";
+
+  auto result = SinglePassRunAndDisassemble<ValueRangePropagationPass>(
+      text, /* skip_nop = */ true, /* do_validation = */ true);
+  EXPECT_EQ(Pass::Status::SuccessWithoutChange, std::get<1>(result));
+}
+
+TEST_F(ValueRangePropagationTest, NarrowUnsignedConstant) {
+  // A 16-bit unsigned value that is always 0xffff.  Its constant must not be
+  // sign-extended, and it is zero-extended when converted.
+  const std::string text = R"(
+OpCapability Shader
+OpCapability Int16
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %out
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %out "out"
+%void = OpTypeVoid
+%uint = OpTypeInt 32 0
+%ushort = OpTypeInt 16 0
+%ushort_65534 = OpConstant %ushort 65534
+%ushort_1 = OpConstant %ushort 1
+%void_fn = OpTypeFunction %void
+%_ptr_Output_uint = OpTypePointer Output %uint
+%out = OpVariable %_ptr_Output_uint Output
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+; CHECK: %ushort_65535 = OpConstant %ushort 65535
+; CHECK: %uint_65535 = OpConstant %uint 65535
+; CHECK: OpStore %out %uint_65535
+%add = OpIAdd %ushort %ushort_65534 %ushort_1
+%conv = OpUConvert %uint %add
+OpStore %out %conv
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<ValueRangePropagationPass>(text, true);
+}
+
+TEST_F(ValueRangePropagationTest, NarrowUnsignedSwitchSelector) {
+  // The literals of a 16-bit unsigned selector are zero-extended, so the
+  // selector 0xffff takes the case 65535.
+  const std::string text = R"(
+OpCapability Shader
+OpCapability Int16
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main" %out
+OpExecutionMode %main OriginUpperLeft
+OpName %main "main"
+OpName %out "out"
+%void = OpTypeVoid
+%uint = OpTypeInt 32 0
+%uint_0 = OpConstant %uint 0
+%uint_1 = OpConstant %uint 1
+%ushort = OpTypeInt 16 0
+%ushort_65534 = OpConstant %ushort 65534
+%ushort_1 = OpConstant %ushort 1
+%void_fn = OpTypeFunction %void
+%_ptr_Output_uint = OpTypePointer Output %uint
+%out = OpVariable %_ptr_Output_uint Output
+%main = OpFunction %void None %void_fn
+%entry = OpLabel
+; CHECK: OpStore %out %uint_1
+%add = OpIAdd %ushort %ushort_65534 %ushort_1
+OpSelectionMerge %merge None
+OpSwitch %add %default 65535 %case
+%case = OpLabel
+OpBranch %merge
+%default = OpLabel
+OpBranch %merge
+%merge = OpLabel
+%phi = OpPhi %uint %uint_1 %case %uint_0 %default
+OpStore %out %phi
+OpReturn
+OpFunctionEnd
+)";
+
+  SinglePassRunAndMatch<ValueRangePropagationPass>(text, true);
+}
+
+}  // namespace
+}  // namespace opt
+}  // namespace spvtools
@@ -1158,6 +1158,65 @@ OpFunctionEnd
   SinglePassRunAndCheck<VectorDCE>(text, text, true, true);
 }
 
+TEST_F(VectorDCETest, ParallelAnalysisMatchesSequential) {
+  // Each function has an insert into a component that is never read.  The
+  // liveness of each function is computed on a different thread, but the
+  // rewrites must be the same as in the sequential case.
+  const std::string text = R"(
+; CHECK: [[f1:%\w+]] = OpFunction
+; CHECK: [[p1:%\w+]] = OpFunctionParameter
+; CHECK: OpCompositeExtract %float [[p1]] 1
+; CHECK: [[f2:%\w+]] = OpFunction
+; CHECK: [[p2:%\w+]] = OpFunctionParameter
+; CHECK: OpCompositeExtract %float [[p2]] 2
+; CHECK: [[f3:%\w+]] = OpFunction
+; CHECK: [[p3:%\w+]] = OpFunctionParameter
+; CHECK: OpCompositeExtract %float [[p3]] 3
+OpCapability Shader
+OpMemoryModel Logical GLSL450
+OpEntryPoint Fragment %main "main"
+OpExecutionMode %main OriginUpperLeft
+%void = OpTypeVoid
+%float = OpTypeFloat 32
+%v4float = OpTypeVector %float 4
+%float_1 = OpConstant %float 1
+%v4_1 = OpConstantComposite %v4float %float_1 %float_1 %float_1 %float_1
+%main_ty = OpTypeFunction %void
+%fn_ty = OpTypeFunction %float %v4float
+%main = OpFunction %void None %main_ty
+%main_lab = OpLabel
+%c1 = OpFunctionCall %float %f1 %v4_1
+%c2 = OpFunctionCall %float %f2 %v4_1
+%c3 = OpFunctionCall %float %f3 %v4_1
+OpReturn
+OpFunctionEnd
+%f1 = OpFunction %float None %fn_ty
+%p1 = OpFunctionParameter %v4float
+%f1_lab = OpLabel
+%i1 = OpCompositeInsert %v4float %float_1 %p1 0
+%e1 = OpCompositeExtract %float %i1 1
+OpReturnValue %e1
+OpFunctionEnd
+%f2 = OpFunction %float None %fn_ty
+%p2 = OpFunctionParameter %v4float
+%f2_lab = OpLabel
+%i2 = OpCompositeInsert %v4float %float_1 %p2 0
+%e2 = OpCompositeExtract %float %i2 2
+OpReturnValue %e2
+OpFunctionEnd
+%f3 = OpFunction %float None %fn_ty
+%p3 = OpFunctionParameter %v4float
+%f3_lab = OpLabel
+%i3 = OpCompositeInsert %v4float %float_1 %p3 0
+%e3 = OpCompositeExtract %float %i3 3
+OpReturnValue %e3
+OpFunctionEnd
+)";
+
+  OptimizerOptions()->num_threads_ = 4;
+  SinglePassRunAndMatch<VectorDCE>(text, true);
+}
+
 }  // namespace
 }  // namespace opt
 }  // namespace spvtools
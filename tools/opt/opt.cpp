@@ -195,6 +195,10 @@ Options (in lexicographical order):)",
   --eliminate-dead-variables
                Deletes module scope variables that are not referenced.)");
   printf(R"(
+  --eliminate-dead-stores
+               Removes stores to function scope and private variables
+               whose values are never read on any path that follows them.)");
+  printf(R"(
   --eliminate-insert-extract
                DEPRECATED.  This pass has been replaced by the simplification
                pass, and that pass will be run instead.
@@ -217,6 +221,16 @@ Options (in lexicographical order):)",
                loads and stores. Performed only on entry point call tree
                functions.)");
   printf(R"(
+  --fixed-point-O
+               Apply the same transformations as -O, but group the cleanup
+               transformations and repeat each group until the module stops
+               changing. A transformation is skipped when it made no change
+               the last time it ran and nothing changed since.)");
+  printf(R"(
+  --fixed-point-Os
+               Apply the same transformations as -Os, grouped and repeated
+               until the module stops changing as for --fixed-point-O.)");
+  printf(R"(
   --flatten-decorations
                Replace decoration groups with repeated OpDecorate and
                OpMemberDecorate instructions.)");
@@ -247,6 +261,12 @@ Options (in lexicographical order):)",
                functions. Currently does not inline calls to functions with
                early return in a loop.)");
   printf(R"(
+  --interprocedural-ccp
+               Apply the conditional constant propagation transform across
+               function calls.  Parameters that are given the same constant
+               by every call, and calls to functions that always return the
+               same constant, are replaced by that constant.)");
+  printf(R"(
   --legalize-hlsl
                Runs a series of optimizations that attempts to take SPIR-V
                generated by an HLSL front-end and generates legal Vulkan SPIR-V.
@@ -283,9 +303,22 @@ Options (in lexicographical order):)",
                Identifies code in loops that has the same value for every
                iteration of the loop, and move it to the loop pre-header.)");
   printf(R"(
+  --loop-strength-reduction
+               Replaces the multiplications by loop induction variables
+               with additions, merges redundant induction variables and
+               replaces the values used after loops by their value on
+               exit when it is known.)");
+  printf(R"(
   --loop-unroll
                Fully unrolls loops marked with the Unroll flag)");
   printf(R"(
+  --loop-unroll-auto[=<n>]
+               Unrolls each loop that is not marked with the DontUnroll flag
+               fully, partially or not at all, depending on its trip count,
+               its size and the registers it needs.  <n> is the maximum
+               number of instructions in an unrolled loop.  The default
+               value is 256.)");
+  printf(R"(
   --loop-unroll-partial
                Partially unrolls loops marked with the Unroll flag. Takes an
                additional non-0 integer argument to set the unroll factor, or
@@ -379,6 +412,17 @@ Options (in lexicographical order):)",
                --merge-blocks followed by all the transformations implied by
                -O.)");
   printf(R"(
+  --num-threads=<n>
+               Sets the number of threads that passes may use to analyze
+               functions in parallel.  The default is 1.  The output is the
+               same for every thread count.)");
+  printf(R"(
+  --partial-redundancy-elimination
+               Replaces instructions whose value is already computed on some
+               of the paths leading to them with an OpPhi, after computing the
+               value on the other paths.  This is done only when no path
+               computes more instructions than before.)");
+  printf(R"(
   --preserve-bindings
                Ensure that the optimizer preserves all bindings declared within
                the module, even when those bindings are unused.)");
@@ -395,6 +439,15 @@ Options (in lexicographical order):)",
                Change the scope of private variables that are used in a single
                function to that function.)");
   printf(R"(
+  --profile-json
+               Print a JSON object describing each pass to standard error
+               output after the last pass. For every pass it records the
+               wall and CPU time, the RSS delta in kilobytes and the page
+               faults (null when not measurable on this system), the number
+               of instructions, basic blocks and functions and the id bound
+               before and after the pass, the analyses the pass built and
+               invalidated, and whether the pass changed the module.)");
+  printf(R"(
   --reduce-load-size
                Replaces loads of composite objects where not every component is
                used by loads of just the elements that are used.)");
@@ -412,6 +465,12 @@ Options (in lexicographical order):)",
                compatible layout and members. This option is forwarded to the
                validator.)");
   printf(R"(
+  --rematerialize[=<n>]
+               Recomputes cheap values, such as access chains and loads
+               from read-only memory, next to their uses instead of keeping
+               them live through blocks that need more than <n> registers.
+               The default value is 32.)");
+  printf(R"(
   --remove-duplicates
                Removes duplicate types, decorations, capabilities and extension
                instructions.)");
@@ -432,6 +491,11 @@ Options (in lexicographical order):)",
                be replaced.  0 means there is no limit.  The default value is
                100.)");
   printf(R"(
+  --schedule-instructions
+               Reorders the instructions in each basic block to lower the
+               number of values live at the same time, without changing
+               the order of memory accesses and side effects.)");
+  printf(R"(
   --set-spec-const-default-value "<spec id>:<default value> ..."
                Set the default values of the specialization constants with
                <spec id>:<default value> pairs specified in a double-quoted
@@ -444,6 +508,18 @@ Options (in lexicographical order):)",
                Will simplify all instructions in the function as much as
                possible.)");
   printf(R"(
+  --slp-vectorize
+               Replaces scalar operations on the components of vectors that
+               are put together in a vector by the same operations on
+               vectors, when this reduces the number of instructions.)");
+  printf(R"(
+  --specialize-functions[=<n>]
+               Clones functions for the constant arguments they are called
+               with, and removes the parameters and return values that are
+               not used.  <n> is a limit on the number of instructions the
+               clones that do not replace their function can add.  The
+               default value is 100.)");
+  printf(R"(
   --split-invalid-unreachable
                Attempts to legalize for WebGPU cases where an unreachable
                merge-block is also a continue-target by splitting it into two
@@ -489,6 +565,12 @@ Options (in lexicographical order):)",
                Transforms memory, image, atomic and barrier operations to conform
                to that model's requirements.)");
   printf(R"(
+  --value-range-propagation
+               Computes the range of integer values, and replaces results
+               with a single possible value by a constant and min, max and
+               clamp instructions that cannot change their operand by that
+               operand.)");
+  printf(R"(
   --vector-dce
                This pass looks for components of vectors that are unused, and
                removes them from the vector.  Note this would still leave around
@@ -741,8 +823,20 @@ OptStatus ParseFlags(int argc, const char** argv,
         optimizer_options->set_preserve_spec_constants(true);
       } else if (0 == strcmp(cur_arg, "--time-report")) {
         optimizer->SetTimeReport(&std::cerr);
+      } else if (0 == strcmp(cur_arg, "--profile-json")) {
+        optimizer->SetProfileJson(&std::cerr);
       } else if (0 == strcmp(cur_arg, "--relax-struct-store")) {
         validator_options->SetRelaxStructStore(true);
+      } else if (0 == strncmp(cur_arg, "--num-threads=",
+                              sizeof("--num-threads=") - 1)) {
+        auto split_flag = spvtools::utils::SplitFlagArgs(cur_arg);
+        int num_threads = atoi(split_flag.second.c_str());
+        if (num_threads <= 0) {
+          spvtools::Error(opt_diagnostic, nullptr, {},
+                          "The number of threads must be at least 1");
+          return {OPT_STOP, 1};
+        }
+        optimizer_options->set_num_threads(static_cast<uint32_t>(num_threads));
       } else if (0 == strncmp(cur_arg, "--max-id-bound=",
                               sizeof("--max-id-bound=") - 1)) {
         auto split_flag = spvtools::utils::SplitFlagArgs(cur_arg);